@@ -14,6 +14,9 @@
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#include <algorithm>
 
 #if TD_MSVC
 #pragma comment(linker, "/STACK:16777216")
@@ -324,6 +327,127 @@ class QueryBench final : public td::Benchmark {
   td::ActorOwn<ServerActor> server_;
 };
 
+template <bool enable_work_stealing>
+class SkewedLoadBench final : public td::Benchmark {
+ public:
+  class ProducerActor;
+
+  class WorkerActor final : public td::Actor {
+   public:
+    explicit WorkerActor(td::ActorId<ProducerActor> producer) : producer_(producer) {
+    }
+
+    void task(double sent_at, td::uint32 work) {
+      td::uint32 res = 1;
+      for (td::uint32 i = 0; i < work; i++) {
+        res = res * 3 + i;
+      }
+      send_closure(producer_, &ProducerActor::on_task_done, td::Time::now() - sent_at, res);
+    }
+
+   private:
+    td::ActorId<ProducerActor> producer_;
+
+    void start_up() final {
+      set_stealable(true);
+    }
+  };
+
+  class ProducerActor final : public td::Actor {
+   public:
+    ProducerActor(int worker_n, td::vector<double> *latencies) : worker_n_(worker_n), latencies_(latencies) {
+    }
+
+    void run(int n) {
+      left_task_n_ = n;
+      // keep several tasks in flight for every worker; all of them are on the same overloaded scheduler
+      for (int i = 0; i < worker_n_ * 4 && left_task_n_ > 0; i++) {
+        send_task();
+      }
+    }
+
+    void on_task_done(double latency, td::uint32 result) {
+      latencies_->push_back(latency);
+      pending_task_n_--;
+      if (left_task_n_ > 0) {
+        send_task();
+      } else if (pending_task_n_ == 0) {
+        td::Scheduler::instance()->finish();
+      }
+    }
+
+   private:
+    int worker_n_;
+    td::vector<double> *latencies_;
+    td::vector<td::ActorOwn<WorkerActor>> workers_;
+    int left_task_n_ = 0;
+    int pending_task_n_ = 0;
+    int next_worker_ = 0;
+
+    void start_up() final {
+      for (int i = 0; i < worker_n_; i++) {
+        workers_.push_back(td::create_actor_on_scheduler<WorkerActor>("Worker", 1, actor_id(this)));
+      }
+    }
+
+    void send_task() {
+      send_closure(workers_[next_worker_], &WorkerActor::task, td::Time::now(), 20000);
+      next_worker_ = (next_worker_ + 1) % worker_n_;
+      left_task_n_--;
+      pending_task_n_++;
+    }
+  };
+
+  td::string get_description() const final {
+    return PSTRING() << "SkewedLoad (work_stealing = " << enable_work_stealing << ")";
+  }
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(3, 0);
+    if (enable_work_stealing) {
+      scheduler_->enable_work_stealing();
+    }
+    producer_ = scheduler_->create_actor_unsafe<ProducerActor>(0, "Producer", 32, &latencies_);
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(producer_, &ProducerActor::run, td::max(n, 100));
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    producer_.release();
+    scheduler_->finish();
+    scheduler_.reset();
+
+    std::sort(latencies_.begin(), latencies_.end());
+    auto get_percentile = [&](size_t percent) {
+      return latencies_[(latencies_.size() - 1) * percent / 100] * 1e6;
+    };
+    latency_stats_ = PSTRING() << "p50 = " << get_percentile(50) << "us, p99 = " << get_percentile(99)
+                               << "us, max = " << get_percentile(100) << "us";
+    latencies_.clear();
+  }
+
+  SkewedLoadBench() = default;
+  ~SkewedLoadBench() final {
+    // latency of the last pass
+    LOG(ERROR) << "Latency [" << get_description() << "]: " << latency_stats_;
+  }
+
+ private:
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::ActorOwn<ProducerActor> producer_;
+  td::vector<double> latencies_;
+  td::string latency_stats_;
+};
+
 int main() {
   td::init_openssl_threads();
 
@@ -346,4 +470,6 @@ int main() {
   bench(RingBench<0>(504, 2));
   bench(RingBench<1>(504, 2));
   bench(RingBench<2>(504, 2));
+  bench(SkewedLoadBench<false>());
+  bench(SkewedLoadBench<true>());
 }
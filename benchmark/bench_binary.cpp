@@ -0,0 +1,248 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_binary.h"
+#include "td/telegram/td_api_json.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/JsonBuilder.h"
+#include "td/utils/logging.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
+
+static td::td_api::object_ptr<td::td_api::formattedText> get_formatted_text_object() {
+  auto text = td::td_api::make_object<td::td_api::formattedText>();
+  for (int i = 0; i < 100; i++) {
+    text->text_ += "Some \"quoted\" text with a\ttab, a new line\n and a non-ASCII character \xE2\x9C\x93. ";
+    text->entities_.push_back(td::td_api::make_object<td::td_api::textEntity>(
+        i * 80, 10, td::td_api::make_object<td::td_api::textEntityTypeTextUrl>("https://telegram.org/")));
+  }
+  return text;
+}
+
+static td::td_api::object_ptr<td::td_api::Object> get_update_new_message_object() {
+  auto message = td::td_api::make_object<td::td_api::message>();
+  message->id_ = 123456000111;
+  message->sender_id_ = td::td_api::make_object<td::td_api::messageSenderUser>(123456000112);
+  message->chat_id_ = 123456000112;
+  message->date_ = 1699999999;
+  message->content_ = td::td_api::make_object<td::td_api::messageText>(get_formatted_text_object(), nullptr, nullptr);
+  return td::td_api::make_object<td::td_api::updateNewMessage>(std::move(message));
+}
+
+static td::td_api::object_ptr<td::td_api::Object> get_chats_object() {
+  td::vector<td::int64> chat_ids;
+  for (int i = 0; i < 10000; i++) {
+    chat_ids.push_back(-1000000000000 - i * 1234567);
+  }
+  return td::td_api::make_object<td::td_api::chats>(100000, std::move(chat_ids));
+}
+
+static td::td_api::object_ptr<td::td_api::Function> get_send_message_function() {
+  return td::td_api::make_object<td::td_api::sendMessage>(
+      123456000112, 0, nullptr, nullptr, nullptr,
+      td::td_api::make_object<td::td_api::inputMessageText>(get_formatted_text_object(), nullptr, true));
+}
+
+static td::string to_json(const td::td_api::Object &object) {
+  td::StringBuilder sb;
+  td::td_api::store_json(sb, object);
+  return sb.as_cslice().str();
+}
+
+static td::string get_send_message_json() {
+  return PSTRING() << "{\"@type\":\"sendMessage\",\"chat_id\":123456000112,\"input_message_content\":{\"@type\":"
+                   << "\"inputMessageText\",\"text\":" << to_json(*get_formatted_text_object())
+                   << ",\"clear_draft\":true}}";
+}
+
+static td::string to_binary(const td::td_api::Object &object) {
+  td::TlStorerCalcLength calc_length;
+  calc_length.store_int(object.get_id());
+  td::td_api::store_binary(calc_length, object);
+  td::string result(calc_length.get_length(), '\0');
+  td::TlStorerUnsafe storer(td::MutableSlice(result).ubegin());
+  storer.store_int(object.get_id());
+  td::td_api::store_binary(storer, object);
+  return result;
+}
+
+// there are no storers for td_api functions, so the request is serialized field by field as a binding would do
+template <class StorerT>
+static void store_send_message(StorerT &storer, const td::td_api::formattedText &text) {
+  static constexpr td::int32 ID_NULL = 0x56730bcc;
+  static constexpr td::int32 ID_BOOL_TRUE = 0x997275b5;
+  storer.store_int(td::td_api::sendMessage::ID);
+  storer.store_long(123456000112);  // chat_id
+  storer.store_long(0);             // message_thread_id
+  storer.store_int(ID_NULL);        // reply_to
+  storer.store_int(ID_NULL);        // options
+  storer.store_int(ID_NULL);        // reply_markup
+  storer.store_int(td::td_api::inputMessageText::ID);
+  storer.store_int(td::td_api::formattedText::ID);
+  td::td_api::store_binary(storer, text);
+  storer.store_int(ID_NULL);       // link_preview_options
+  storer.store_int(ID_BOOL_TRUE);  // clear_draft
+}
+
+static td::string get_send_message_binary() {
+  auto text = get_formatted_text_object();
+  td::TlStorerCalcLength calc_length;
+  store_send_message(calc_length, *text);
+  td::string result(calc_length.get_length(), '\0');
+  td::TlStorerUnsafe storer(td::MutableSlice(result).ubegin());
+  store_send_message(storer, *text);
+  return result;
+}
+
+static td::td_api::object_ptr<td::td_api::Function> from_json(td::MutableSlice request) {
+  auto json_value = td::json_decode(request).move_as_ok();
+  td::td_api::object_ptr<td::td_api::Function> function;
+  td::td_api::from_json(function, std::move(json_value)).ensure();
+  return function;
+}
+
+static td::td_api::object_ptr<td::td_api::Function> from_binary(td::Slice request) {
+  td::TlParser p(request);
+  td::td_api::object_ptr<td::td_api::Function> function;
+  td::td_api::fetch_binary(p, function);
+  p.fetch_end();
+  LOG_CHECK(p.get_error() == nullptr) << p.get_error() << " at " << p.get_error_pos();
+  return function;
+}
+
+class StoreJsonBench final : public td::Benchmark {
+  td::string name_;
+  td::td_api::object_ptr<td::td_api::Object> object_;
+  td::string buffer_;
+
+ public:
+  StoreJsonBench(td::string name, td::td_api::object_ptr<td::td_api::Object> object)
+      : name_(std::move(name)), object_(std::move(object)) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "store_json " << name_;
+  }
+
+  void start_up() final {
+    buffer_ = td::string(to_json(*object_).size() + 100, '\0');
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      td::StringBuilder sb(td::MutableSlice(buffer_), true);
+      td::td_api::store_json(sb, *object_);
+      res += sb.as_cslice().size();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+class StoreBinaryBench final : public td::Benchmark {
+  td::string name_;
+  td::td_api::object_ptr<td::td_api::Object> object_;
+  td::string buffer_;
+
+ public:
+  StoreBinaryBench(td::string name, td::td_api::object_ptr<td::td_api::Object> object)
+      : name_(std::move(name)), object_(std::move(object)) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "TL store " << name_;
+  }
+
+  void start_up() final {
+    buffer_ = to_binary(*object_);
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      td::TlStorerCalcLength calc_length;
+      calc_length.store_int(object_->get_id());
+      td::td_api::store_binary(calc_length, *object_);
+      CHECK(calc_length.get_length() == buffer_.size());
+      td::TlStorerUnsafe storer(td::MutableSlice(buffer_).ubegin());
+      storer.store_int(object_->get_id());
+      td::td_api::store_binary(storer, *object_);
+      res += calc_length.get_length();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+class ParseJsonBench final : public td::Benchmark {
+  td::string request_;
+  td::string buffer_;
+
+ public:
+  explicit ParseJsonBench(td::string request) : request_(std::move(request)) {
+  }
+
+  td::string get_description() const final {
+    return "from_json sendMessage";
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      buffer_ = request_;
+      res += from_json(buffer_)->get_id();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+class ParseBinaryBench final : public td::Benchmark {
+  td::string request_;
+
+ public:
+  explicit ParseBinaryBench(td::string request) : request_(std::move(request)) {
+  }
+
+  td::string get_description() const final {
+    return "TL fetch sendMessage";
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      res += from_binary(request_)->get_id();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+static void bench_store(td::string name, td::td_api::object_ptr<td::td_api::Object> (*get_object)()) {
+  td::bench(StoreJsonBench(name, get_object()));
+  td::bench(StoreBinaryBench(name, get_object()));
+}
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
+
+  auto function = td::td_api::to_string(get_send_message_function());
+  auto json_request = get_send_message_json();
+  auto binary_request = get_send_message_binary();
+  auto json_copy = json_request;
+  LOG_CHECK(td::td_api::to_string(from_json(json_copy)) == function) << json_request;
+  LOG_CHECK(td::td_api::to_string(from_binary(binary_request)) == function) << function;
+  LOG(INFO) << "Request size: JSON " << json_request.size() << ", TL " << binary_request.size();
+
+  bench_store("updateNewMessage", get_update_new_message_object);
+  bench_store("chats", get_chats_object);
+  td::bench(ParseJsonBench(json_request));
+  td::bench(ParseBinaryBench(binary_request));
+}
@@ -376,6 +376,48 @@ class AesIgeShortBench final : public td::Benchmark {
   }
 };
 
+template <bool use_batch>
+class AesIgeBatchDecryptBench final : public td::Benchmark {
+ public:
+  static constexpr std::size_t PACKET_COUNT = 8;
+  std::vector<std::vector<unsigned char>> data;
+  std::vector<td::UInt256> keys;
+  std::vector<td::UInt256> ivs;
+
+  std::string get_description() const final {
+    return PSTRING() << "AES IGE " << (use_batch ? "batch" : "sequential") << " decrypt [" << PACKET_COUNT << "x"
+                     << (DATA_SIZE >> 10) << "KB]";
+  }
+
+  void start_up() final {
+    data.assign(PACKET_COUNT, std::vector<unsigned char>(DATA_SIZE, static_cast<unsigned char>(123)));
+    keys.resize(PACKET_COUNT);
+    ivs.resize(PACKET_COUNT);
+    for (std::size_t i = 0; i < PACKET_COUNT; i++) {
+      td::Random::secure_bytes(as_mutable_slice(keys[i]));
+      td::Random::secure_bytes(as_mutable_slice(ivs[i]));
+    }
+  }
+
+  void run(int n) final {
+    std::vector<td::AesIgeBatchItem> items;
+    for (int i = 0; i < n; i++) {
+      items.clear();
+      for (std::size_t j = 0; j < PACKET_COUNT; j++) {
+        td::MutableSlice data_slice(data[j].data(), DATA_SIZE);
+        if (use_batch) {
+          items.push_back({as_slice(keys[j]), as_mutable_slice(ivs[j]), data_slice, data_slice});
+        } else {
+          td::aes_ige_decrypt(as_slice(keys[j]), as_mutable_slice(ivs[j]), data_slice, data_slice);
+        }
+      }
+      if (use_batch) {
+        td::aes_ige_decrypt_batch(items);
+      }
+    }
+  }
+};
+
 BENCH(Rand, "std_rand") {
   int res = 0;
   for (int i = 0; i < n; i++) {
@@ -504,6 +546,8 @@ int main() {
   td::bench(AesIgeShortBench<false>());
   td::bench(AesIgeEncryptBench());
   td::bench(AesIgeDecryptBench());
+  td::bench(AesIgeBatchDecryptBench<false>());
+  td::bench(AesIgeBatchDecryptBench<true>());
   td::bench(AesEcbBench());
 
   td::bench(Pbkdf2Bench());
@@ -17,13 +17,18 @@
 #include "td/utils/logging.h"
 #include "td/utils/port/SocketFd.h"
 #include "td/utils/Slice.h"
+#include "td/utils/Time.h"
+
+#include <atomic>
 
 static int cnt = 0;
+static std::atomic<td::uint64> query_count{0};
 
 class HelloWorld final : public td::HttpInboundConnection::Callback {
  public:
   void handle(td::unique_ptr<td::HttpQuery> query, td::ActorOwn<td::HttpInboundConnection> connection) final {
     // LOG(ERROR) << *query;
+    query_count.fetch_add(1, std::memory_order_relaxed);
     td::HttpHeaderCreator hc;
     td::Slice content = "hello world";
     //auto content = td::BufferSlice("hello world");
@@ -77,8 +82,17 @@ int main() {
   auto scheduler = td::make_unique<td::ConcurrentScheduler>(N, 0);
   scheduler->create_actor_unsafe<Server>(0, "Server").release();
   scheduler->start();
+  auto next_report_time = td::Timestamp::in(1.0);
+  td::uint64 last_query_count = 0;
   while (scheduler->run_main(10)) {
-    // empty
+    if (next_report_time.is_in_past()) {
+      auto new_query_count = query_count.load(std::memory_order_relaxed);
+      if (new_query_count != last_query_count) {
+        LOG(ERROR) << "Handled " << new_query_count - last_query_count << " queries per second";
+        last_query_count = new_query_count;
+      }
+      next_report_time = td::Timestamp::in(1.0);
+    }
   }
   scheduler->finish();
 }
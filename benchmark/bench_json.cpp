@@ -0,0 +1,137 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_json.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/JsonBuilder.h"
+#include "td/utils/logging.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/StackAllocator.h"
+#include "td/utils/StringBuilder.h"
+
+static td::td_api::object_ptr<td::td_api::file> get_file_object() {
+  return td::td_api::make_object<td::td_api::file>(
+      12345, 123456, 123456,
+      td::td_api::make_object<td::td_api::localFile>(
+          "/android/data/0/data/org.telegram.data/files/photos/12345678901234567890_123.jpg", true, true, false, true,
+          0, 123456, 123456),
+      td::td_api::make_object<td::td_api::remoteFile>("abacabadabacabaeabacabadabacabafabacabadabacabaeabacabadabacaba",
+                                                      "abacabadabacabaeabacabadabacaba", false, true, 123456));
+}
+
+static td::td_api::object_ptr<td::td_api::Object> get_update_new_message_object() {
+  auto message = td::td_api::make_object<td::td_api::message>();
+  message->id_ = 123456000111;
+  message->sender_id_ = td::td_api::make_object<td::td_api::messageSenderUser>(123456000112);
+  message->chat_id_ = 123456000112;
+  message->date_ = 1699999999;
+  message->media_album_id_ = 1234567890123456789;
+  message->author_signature_ = "Author \"Signature\"\n\xD0\x90\xD0\xB2\xD1\x82\xD0\xBE\xD1\x80";
+
+  auto caption = td::td_api::make_object<td::td_api::formattedText>();
+  for (int i = 0; i < 100; i++) {
+    caption->text_ += "Some \"quoted\" text with a\ttab, a new line\n and a non-ASCII character \xE2\x9C\x93. ";
+    caption->entities_.push_back(td::td_api::make_object<td::td_api::textEntity>(
+        i * 80, 10, td::td_api::make_object<td::td_api::textEntityTypeTextUrl>("https://telegram.org/")));
+  }
+  auto photo = td::td_api::make_object<td::td_api::photo>();
+  for (int i = 0; i < 4; i++) {
+    photo->sizes_.push_back(td::td_api::make_object<td::td_api::photoSize>(
+        "a", get_file_object(), 160, 160,
+        td::vector<td::int32>{10000, 20000, 30000, 50000, 70000, 90000, 120000, 150000, 180000, 220000}));
+  }
+  message->content_ =
+      td::td_api::make_object<td::td_api::messagePhoto>(std::move(photo), std::move(caption), false, false, false);
+  return td::td_api::make_object<td::td_api::updateNewMessage>(std::move(message));
+}
+
+static td::td_api::object_ptr<td::td_api::Object> get_chats_object() {
+  td::vector<td::int64> chat_ids;
+  for (int i = 0; i < 10000; i++) {
+    chat_ids.push_back(-1000000000000 - i * 1234567);
+  }
+  return td::td_api::make_object<td::td_api::chats>(100000, std::move(chat_ids));
+}
+
+static td::string to_json_builder(const td::td_api::Object &object) {
+  auto buf = td::StackAllocator::alloc(1 << 18);
+  td::JsonBuilder jb(td::StringBuilder(buf.as_slice(), true), -1);
+  jb.enter_value() << td::ToJson(object);
+  return jb.string_builder().as_cslice().str();
+}
+
+static td::string to_json_direct(const td::td_api::Object &object) {
+  td::StringBuilder sb;
+  td::td_api::store_json(sb, object);
+  return sb.as_cslice().str();
+}
+
+class ToJsonBench final : public td::Benchmark {
+  td::string name_;
+  td::td_api::object_ptr<td::td_api::Object> object_;
+
+ public:
+  ToJsonBench(td::string name, td::td_api::object_ptr<td::td_api::Object> object)
+      : name_(std::move(name)), object_(std::move(object)) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "ToJson " << name_;
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      res += to_json_builder(*object_).size();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+class StoreJsonBench final : public td::Benchmark {
+  td::string name_;
+  td::td_api::object_ptr<td::td_api::Object> object_;
+  td::string buffer_;
+
+ public:
+  StoreJsonBench(td::string name, td::td_api::object_ptr<td::td_api::Object> object)
+      : name_(std::move(name)), object_(std::move(object)) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "store_json " << name_;
+  }
+
+  void start_up() final {
+    buffer_ = td::string(to_json_direct(*object_).size() + 100, '\0');
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      td::StringBuilder sb(td::MutableSlice(buffer_), true);
+      td::td_api::store_json(sb, *object_);
+      res += sb.as_cslice().size();
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
+static void bench_json(td::string name, td::td_api::object_ptr<td::td_api::Object> (*get_object)()) {
+  td::bench(ToJsonBench(name, get_object()));
+  td::bench(StoreJsonBench(name, get_object()));
+}
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
+
+  bench_json("updateNewMessage", get_update_new_message_object);
+  bench_json("chats", get_chats_object);
+}
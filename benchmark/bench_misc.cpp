@@ -9,7 +9,9 @@
 #include "td/telegram/telegram_api.hpp"
 
 #include "td/utils/algorithm.h"
+#include "td/utils/ArenaAllocator.h"
 #include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
@@ -26,6 +28,8 @@
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/ThreadSafeCounter.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
 
 #if !TD_WINDOWS
 #include <unistd.h>
@@ -65,6 +69,101 @@ BENCH(TlCall, "TL Call") {
   td::do_not_optimize_away(res);
 }
 
+class TlParseDifferenceBench final : public td::Benchmark {
+ public:
+  TlParseDifferenceBench(bool use_arena, bool parse_users) : use_arena_(use_arena), parse_users_(parse_users) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "TL parse updates.difference of size " << difference_.size()
+                     << (use_arena_ ? " with" : " without") << " arena"
+                     << (parse_users_ ? " and all users" : " and no users");
+  }
+
+  void start_up() final {
+    td::TlStorerCalcLength calc_length;
+    store_difference(calc_length);
+    difference_ = td::BufferSlice(calc_length.get_length());
+    td::TlStorerUnsafe storer(difference_.as_mutable_slice().ubegin());
+    store_difference(storer);
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      td::ArenaAllocator arena;
+      td::ArenaAllocator::Guard guard(use_arena_ ? &arena : nullptr);
+      td::TlBufferParser parser(&difference_);
+      auto result = td::telegram_api::updates_getDifference::fetch_result(parser);
+      parser.fetch_end();
+      CHECK(parser.get_error() == nullptr);
+      auto difference = static_cast<const td::telegram_api::updates_difference *>(result.get());
+      res += difference->new_messages_.size();
+      if (parse_users_) {
+        res += difference->users_.get_all().size();
+      }
+    }
+    td::do_not_optimize_away(res);
+  }
+
+ private:
+  bool use_arena_;
+  bool parse_users_;
+  td::BufferSlice difference_;
+
+  // approximately 1 MB of messages with entities and their senders
+  template <class StorerT>
+  static void store_difference(StorerT &storer) {
+    const td::int32 VECTOR_ID = 0x1cb5c415;
+    const td::int32 MESSAGE_COUNT = 2500;
+    const td::int32 USER_COUNT = 500;
+    const td::string text(300, 'a');
+
+    storer.store_int(td::telegram_api::updates_difference::ID);
+    storer.store_int(VECTOR_ID);
+    storer.store_int(MESSAGE_COUNT);
+    for (td::int32 i = 0; i < MESSAGE_COUNT; i++) {
+      storer.store_int(td::telegram_api::message::ID);
+      storer.store_int((1 << 7) | (1 << 8));  // entities and from_id
+      storer.store_int(0);
+      storer.store_int(i + 1);
+      storer.store_int(td::telegram_api::peerUser::ID);
+      storer.store_long(1000 + i % USER_COUNT);
+      storer.store_int(td::telegram_api::peerUser::ID);
+      storer.store_long(1000 + i % 10);
+      storer.store_int(1700000000 + i);
+      storer.store_string(text);
+      storer.store_int(VECTOR_ID);
+      storer.store_int(2);
+      for (td::int32 j = 0; j < 2; j++) {
+        storer.store_int(td::telegram_api::messageEntityBold::ID);
+        storer.store_int(j * 10);
+        storer.store_int(5);
+      }
+    }
+    for (int i = 0; i < 3; i++) {  // new_encrypted_messages, other_updates and chats
+      storer.store_int(VECTOR_ID);
+      storer.store_int(0);
+    }
+    storer.store_int(VECTOR_ID);
+    storer.store_int(USER_COUNT);
+    for (td::int32 i = 0; i < USER_COUNT; i++) {
+      storer.store_int(td::telegram_api::user::ID);
+      storer.store_int(1 | 2 | 4 | 8);  // access_hash, first_name, last_name and username
+      storer.store_int(0);
+      storer.store_long(1000 + i);
+      storer.store_long(1234567890123 + i);
+      storer.store_string(td::string("First name"));
+      storer.store_string(td::string("Last name"));
+      storer.store_string(PSTRING() << "username" << i);
+    }
+    storer.store_int(td::telegram_api::updates_state::ID);
+    for (int i = 0; i < 5; i++) {
+      storer.store_int(i);
+    }
+  }
+};
+
 static td::td_api::object_ptr<td::td_api::file> get_file_object() {
   return td::td_api::make_object<td::td_api::file>(
       12345, 123456, 123456,
@@ -767,6 +866,11 @@ int main() {
   td::bench(TlToStringUpdateFileBench());
   td::bench(TlToStringMessageBench());
 
+  td::bench(TlParseDifferenceBench(false, true));
+  td::bench(TlParseDifferenceBench(true, true));
+  td::bench(TlParseDifferenceBench(false, false));
+  td::bench(TlParseDifferenceBench(true, false));
+
   td::bench(DuplicateCheckerBenchEvenOdd<IdDuplicateCheckerNew<1000>>());
   td::bench(DuplicateCheckerBenchEvenOdd<IdDuplicateCheckerNew<300>>());
   td::bench(DuplicateCheckerBenchEvenOdd<IdDuplicateCheckerArray<1000>>());
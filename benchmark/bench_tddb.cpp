@@ -11,10 +11,13 @@
 #include "td/telegram/ServerMessageId.h"
 #include "td/telegram/UserId.h"
 
+#include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/ConcurrentBinlog.h"
 #include "td/db/DbKey.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 
+#include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/benchmark.h"
@@ -23,8 +26,12 @@
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Random.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
+#include "td/utils/Time.h"
 
+#include <atomic>
 #include <memory>
 
 static td::Status init_db(td::SqliteDb &db) {
@@ -107,7 +114,426 @@ class MessageDbBench final : public td::Benchmark {
   }
 };
 
+// concurrent history loads for different chats
+class MessageDbReadBench final : public td::Benchmark {
+ public:
+  explicit MessageDbReadBench(bool use_readers) : use_readers_(use_readers) {
+  }
+
+  td::string get_description() const final {
+    return use_readers_ ? "MessageDb get_messages with readers" : "MessageDb get_messages";
+  }
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(READER_COUNT, 0);
+    {
+      auto guard = scheduler_->get_main_guard();
+      td::string sql_db_name = "testdb_read.sqlite";
+      td::SqliteDb::destroy(sql_db_name).ignore();
+      sql_connection_ = std::make_shared<td::SqliteConnectionSafe>(sql_db_name, td::DbKey::empty());
+      auto &db = sql_connection_->get();
+      init_db(db).ensure();
+      db.exec("BEGIN TRANSACTION").ensure();
+      init_message_db(db, 0).ensure();
+      db.exec("COMMIT TRANSACTION").ensure();
+
+      message_db_sync_safe_ = td::create_message_db_sync(sql_connection_);
+      auto &message_db = message_db_sync_safe_->get();
+      message_db.begin_write_transaction().ensure();
+      for (int i = 1; i <= DIALOG_COUNT; i++) {
+        auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(i)));
+        for (int j = 1; j <= MESSAGE_COUNT; j++) {
+          auto message_id = td::MessageId{td::ServerMessageId{j}};
+          message_db.add_message({dialog_id, message_id}, td::ServerMessageId(), dialog_id, 0, 0, 0, 0, "",
+                                 td::NotificationId(), td::MessageId(), td::BufferSlice(td::Random::fast(100, 299)));
+        }
+      }
+      message_db.commit_transaction().ensure();
+
+      td::vector<td::int32> reader_scheduler_ids;
+      if (use_readers_) {
+        for (int i = 1; i <= READER_COUNT; i++) {
+          reader_scheduler_ids.push_back(i);
+        }
+      }
+      message_db_async_ = td::create_message_db_async(message_db_sync_safe_, 0, reader_scheduler_ids);
+    }
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    std::atomic<int> left_query_count{n};
+    {
+      auto guard = scheduler_->get_main_guard();
+      for (int i = 0; i < n; i++) {
+        td::MessageDbMessagesQuery query;
+        query.dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, DIALOG_COUNT))));
+        query.from_message_id = td::MessageId::max();
+        query.limit = 100;
+        message_db_async_->get_messages(
+            std::move(query),
+            td::PromiseCreator::lambda([&left_query_count](td::vector<td::MessageDbDialogMessage> messages) {
+              CHECK(messages.size() == 100u);
+              left_query_count--;
+            }));
+      }
+    }
+    while (left_query_count.load() != 0) {
+      scheduler_->run_main(0.001);
+    }
+  }
+
+  void tear_down() final {
+    std::atomic<bool> is_closed{false};
+    {
+      auto guard = scheduler_->get_main_guard();
+      message_db_async_->close(td::PromiseCreator::lambda([&is_closed](td::Unit) { is_closed = true; }));
+    }
+    while (!is_closed.load()) {
+      scheduler_->run_main(0.01);
+    }
+    {
+      auto guard = scheduler_->get_main_guard();
+      message_db_async_.reset();
+      message_db_sync_safe_.reset();
+      sql_connection_->close_and_destroy();
+      sql_connection_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  static constexpr int READER_COUNT = 3;
+  static constexpr int DIALOG_COUNT = 100;
+  static constexpr int MESSAGE_COUNT = 1000;
+
+  bool use_readers_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  std::shared_ptr<td::SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe_;
+  std::shared_ptr<td::MessageDbAsyncInterface> message_db_async_;
+};
+
+// local message search with the full-text search index and with the dedicated search index
+class MessageSearchBench final : public td::Benchmark {
+ public:
+  MessageSearchBench(bool is_search, bool use_search_index)
+      : is_search_(is_search), use_search_index_(use_search_index) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "MessageDb " << (is_search_ ? "search" : "add_message with text") << " using "
+                     << (use_search_index_ ? "search index" : "FTS5");
+  }
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    auto guard = scheduler_->get_main_guard();
+    td::string sql_db_name = "testdb_search.sqlite";
+    td::SqliteDb::destroy(sql_db_name).ignore();
+    sql_connection_ = std::make_shared<td::SqliteConnectionSafe>(sql_db_name, td::DbKey::empty());
+    auto &db = sql_connection_->get();
+    init_db(db).ensure();
+    db.exec("BEGIN TRANSACTION").ensure();
+    init_message_db(db, 0).ensure();
+    init_message_search_index(db, use_search_index_).ensure();
+    db.exec("COMMIT TRANSACTION").ensure();
+    message_db_sync_safe_ = td::create_message_db_sync(sql_connection_);
+
+    for (int i = 0; i < WORD_COUNT; i++) {
+      td::string word;
+      auto length = td::Random::fast(4, 10);
+      for (int j = 0; j < length; j++) {
+        word += static_cast<char>(td::Random::fast('a', 'z'));
+      }
+      words_.push_back(std::move(word));
+    }
+    if (is_search_) {
+      add_messages(MESSAGE_COUNT);
+    }
+  }
+
+  void run(int n) final {
+    auto guard = scheduler_->get_main_guard();
+    if (!is_search_) {
+      add_messages(n);
+      return;
+    }
+
+    auto &message_db = message_db_sync_safe_->get();
+    std::size_t found_count = 0;
+    for (int i = 0; i < n; i++) {
+      td::MessageDbFtsQuery query;
+      query.query = words_[td::Random::fast(0, WORD_COUNT - 1)];
+      query.limit = 100;
+      found_count += message_db.get_messages_fts(std::move(query)).messages.size();
+    }
+    td::do_not_optimize_away(found_count);
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      message_db_sync_safe_.reset();
+      sql_connection_->close_and_destroy();
+      sql_connection_.reset();
+    }
+    scheduler_.reset();
+  }
+
+ private:
+  static constexpr int WORD_COUNT = 5000;
+  static constexpr int MESSAGE_COUNT = 50000;
+  static constexpr int MESSAGE_WORD_COUNT = 10;
+
+  bool is_search_;
+  bool use_search_index_;
+  td::vector<td::string> words_;
+  td::int64 last_search_id_ = 0;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  std::shared_ptr<td::SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe_;
+
+  void add_messages(int count) {
+    auto &message_db = message_db_sync_safe_->get();
+    message_db.begin_write_transaction().ensure();
+    for (int i = 0; i < count; i++) {
+      td::string text;
+      for (int j = 0; j < MESSAGE_WORD_COUNT; j++) {
+        text += words_[td::Random::fast(0, WORD_COUNT - 1)];
+        text += ' ';
+      }
+      auto search_id = ++last_search_id_;
+      auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(search_id % 100 + 1)));
+      auto message_id = td::MessageId{td::ServerMessageId{static_cast<td::int32>(search_id)}};
+      message_db.add_message({dialog_id, message_id}, td::ServerMessageId(), dialog_id, 0, 0, 0, search_id,
+                             std::move(text), td::NotificationId(), td::MessageId(), td::BufferSlice(100));
+      if (i % 1000 == 999) {
+        message_db.commit_transaction().ensure();
+        message_db.begin_write_transaction().ensure();
+      }
+    }
+    message_db.commit_transaction().ensure();
+  }
+};
+
+// each producer adds durable_event_period - 1 events without waiting and then waits until the next event is durable
+class BinlogSyncBench final : public td::Benchmark {
+ public:
+  BinlogSyncBench(double group_commit_window, int durable_event_period)
+      : group_commit_window_(group_commit_window), durable_event_period_(durable_event_period) {
+  }
+
+  td::string get_description() const final {
+    td::string description = "ConcurrentBinlog ";
+    if (group_commit_window_ == 0) {
+      description += "force_sync";
+    } else {
+      description += PSTRING() << "group commit " << group_commit_window_ * 1000 << "ms";
+    }
+    if (durable_event_period_ != 1) {
+      description += PSTRING() << ", 1/" << durable_event_period_ << " events durable";
+    }
+    return description;
+  }
+
+  void start_up_n(int n) final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(THREAD_COUNT, 0);
+    scheduler_->create_actor_unsafe<Main>(0, "Main", n, group_commit_window_, durable_event_period_).release();
+  }
+
+  void run(int n) final {
+    scheduler_->start();
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+    scheduler_->finish();
+  }
+
+  void tear_down() final {
+    scheduler_.reset();
+  }
+
+ private:
+  static constexpr int THREAD_COUNT = 4;
+  static constexpr int PRODUCER_COUNT = 64;
+
+  double group_commit_window_;
+  int durable_event_period_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+
+  class Producer final : public td::Actor {
+   public:
+    Producer(td::ActorShared<> parent, std::shared_ptr<td::ConcurrentBinlog> binlog, int event_count,
+             int durable_event_period, bool use_force_sync)
+        : parent_(std::move(parent))
+        , binlog_(std::move(binlog))
+        , event_count_(event_count)
+        , durable_event_period_(durable_event_period)
+        , use_force_sync_(use_force_sync) {
+    }
+
+   private:
+    td::ActorShared<> parent_;
+    std::shared_ptr<td::ConcurrentBinlog> binlog_;
+    int event_count_;
+    int durable_event_period_;
+    bool use_force_sync_;
+    td::string data_ = td::string(100, 'a');
+
+    void start_up() final {
+      add_event();
+    }
+
+    void add_event() {
+      for (int i = 1; i < durable_event_period_ && event_count_ > 1; i++) {
+        binlog_->add(1, td::create_storer(data_));
+        event_count_--;
+      }
+      if (event_count_ == 0) {
+        return stop();
+      }
+      event_count_--;
+
+      auto promise = td::PromiseCreator::lambda([actor_id = actor_id(this)](td::Unit) {
+        send_closure(actor_id, &Producer::add_event);
+      });
+      if (use_force_sync_) {
+        binlog_->add(1, td::create_storer(data_));
+        binlog_->force_sync(std::move(promise), "bench");
+      } else {
+        binlog_->add(1, td::create_storer(data_), std::move(promise));
+      }
+    }
+  };
+
+  class Main final : public td::Actor {
+   public:
+    Main(int event_count, double group_commit_window, int durable_event_period)
+        : event_count_(event_count)
+        , group_commit_window_(group_commit_window)
+        , durable_event_period_(durable_event_period) {
+    }
+
+   private:
+    int event_count_;
+    double group_commit_window_;
+    int durable_event_period_;
+    std::shared_ptr<td::ConcurrentBinlog> binlog_;
+    int producer_count_ = 0;
+    double start_time_ = 0;
+
+    void start_up() final {
+      td::Binlog::destroy("test_binlog_sync").ignore();
+      binlog_ = std::make_shared<td::ConcurrentBinlog>();
+      binlog_->init("test_binlog_sync", [](const td::BinlogEvent &) {}).ensure();
+      if (group_commit_window_ > 0) {
+        binlog_->set_group_commit_window(group_commit_window_);
+      }
+      start_time_ = td::Time::now();
+      for (int i = 0; i < PRODUCER_COUNT; i++) {
+        auto event_count = event_count_ / PRODUCER_COUNT + (i < event_count_ % PRODUCER_COUNT ? 1 : 0);
+        td::create_actor_on_scheduler<Producer>("Producer", i % THREAD_COUNT + 1, actor_shared(this), binlog_,
+                                                event_count, durable_event_period_, group_commit_window_ == 0)
+            .release();
+        producer_count_++;
+      }
+    }
+
+    void hangup_shared() final {
+      producer_count_--;
+      if (producer_count_ != 0) {
+        return;
+      }
+      binlog_->get_statistics(td::PromiseCreator::lambda([actor_id = actor_id(this)](td::BinlogStatistics statistics) {
+        send_closure(actor_id, &Main::on_statistics, statistics);
+      }));
+    }
+
+    void on_statistics(td::BinlogStatistics statistics) {
+      auto passed_time = td::Time::now() - start_time_;
+      LOG(ERROR) << "Added " << event_count_ << " events with " << statistics.sync_count << " fsyncs: "
+                 << static_cast<td::int64>(event_count_ / passed_time) << " events/sec, "
+                 << static_cast<td::int64>(static_cast<double>(statistics.sync_count) / passed_time)
+                 << " fsyncs/sec, fsync time " << statistics.sync_time << "s";
+      binlog_->close_and_destroy(td::PromiseCreator::lambda([](td::Unit) { td::Scheduler::instance()->finish(); }));
+      stop();
+    }
+  };
+};
+
+// measures the time needed to open a binlog and to collect its events by type, as TdDb does on startup
+class BinlogReplayBench final : public td::Benchmark {
+ public:
+  explicit BinlogReplayBench(int thread_count) : thread_count_(thread_count) {
+  }
+
+  td::string get_description() const final {
+    if (thread_count_ == 0) {
+      return "Binlog replay";
+    }
+    return PSTRING() << "Binlog parallel replay with " << thread_count_ << " threads";
+  }
+
+  void start_up() final {
+    td::Binlog::destroy("test_binlog_replay").ignore();
+    td::Binlog binlog;
+    binlog.init("test_binlog_replay", [](const td::BinlogEvent &) {}).ensure();
+    for (int i = 0; i < EVENT_COUNT; i++) {
+      td::string data(4 * td::Random::fast(10, 100), 'a');
+      binlog.add(td::Random::fast(1, TYPE_COUNT), td::create_storer(data));
+    }
+    binlog.close().ensure();
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      td::vector<td::vector<td::BinlogEvent>> events(TYPE_COUNT);
+      td::Binlog binlog;
+      if (thread_count_ != 0) {
+        td::vector<td::Binlog::Callback> group_callbacks;
+        for (auto &group_events : events) {
+          group_callbacks.push_back(
+              [&group_events](const td::BinlogEvent &event) { group_events.push_back(event.clone()); });
+        }
+        binlog.set_parallel_replay([](const td::BinlogEvent &event) { return static_cast<size_t>(event.type_ - 1); },
+                                   std::move(group_callbacks), thread_count_);
+      }
+      binlog
+          .init("test_binlog_replay",
+                [&](const td::BinlogEvent &event) { events[event.type_ - 1].push_back(event.clone()); })
+          .ensure();
+      binlog.close(false).ensure();
+    }
+  }
+
+  void tear_down() final {
+    td::Binlog::destroy("test_binlog_replay").ignore();
+  }
+
+ private:
+  static constexpr int EVENT_COUNT = 200000;
+  static constexpr int TYPE_COUNT = 8;
+
+  int thread_count_;
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
   td::bench(MessageDbBench());
+  td::bench(MessageDbReadBench(false));
+  td::bench(MessageDbReadBench(true));
+  td::bench(MessageSearchBench(false, false));
+  td::bench(MessageSearchBench(false, true));
+  td::bench(MessageSearchBench(true, false));
+  td::bench(MessageSearchBench(true, true));
+  for (auto durable_event_period : {1, 10}) {
+    td::bench(BinlogSyncBench(0, durable_event_period));
+    td::bench(BinlogSyncBench(0.001, durable_event_period));
+    td::bench(BinlogSyncBench(0.005, durable_event_period));
+  }
+  td::bench(BinlogReplayBench(0));
+  td::bench(BinlogReplayBench(2));
+  td::bench(BinlogReplayBench(4));
 }
@@ -40,7 +40,8 @@ static void generate_cpp(const std::string &directory, const std::string &tl_nam
 int main() {
   generate_cpp<10>("td/telegram", "telegram_api", "std::string", "BufferSlice",
                    {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""},
-                   {"\"td/utils/buffer.h\"", "\"td/utils/UInt.h\""});
+                   {"\"td/tl/TlLazyVector.h\"", "\"td/utils/ArenaAllocator.h\"", "\"td/utils/buffer.h\"",
+                    "\"td/utils/UInt.h\""});
 
   generate_cpp<>("td/telegram", "secret_api", "std::string", "BufferSlice",
                  {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""}, {"\"td/utils/buffer.h\""});
@@ -0,0 +1,214 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "tl_binary_converter.h"
+
+#include "td/tl/tl_simple.h"
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/FlatHashSet.h"
+#include "td/utils/Slice.h"
+#include "td/utils/StringBuilder.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace td {
+
+static const char *STORER_NAMES[] = {"TlStorerCalcLength", "TlStorerUnsafe"};
+
+static bool is_suitable(int file_number, int file_count, int &counter) {
+  if (file_count <= 1) {
+    return true;
+  }
+  counter++;
+  return counter % (file_count - 1) == file_number - 1;
+}
+
+static void gen_store_binary_constructor(StringBuilder &sb, const tl::simple::Constructor *constructor, bool is_header,
+                                         td::FlatHashSet<std::string> &store_binary_types) {
+  if (is_header) {
+    store_binary_types.insert(constructor->name);
+  }
+  for (auto storer_name : STORER_NAMES) {
+    sb << "void store_binary(" << storer_name << " &s, const td_api::" << tl::simple::gen_cpp_name(constructor->name)
+       << " &object)";
+    if (is_header) {
+      sb << ";\n\n";
+      continue;
+    }
+    sb << " {\n";
+    for (auto &arg : constructor->args) {
+      sb << "  store_binary(s, object." << tl::simple::gen_cpp_field_name(arg.name) << ");\n";
+    }
+    sb << "}\n\n";
+  }
+}
+
+template <class T>
+void gen_fetch_binary_constructor(StringBuilder &sb, const T *constructor, bool is_header) {
+  sb << "void fetch_binary(TlParser &p, td_api::" << tl::simple::gen_cpp_name(constructor->name)
+     << " &to, int32 max_depth)";
+  if (is_header) {
+    sb << ";\n\n";
+    return;
+  }
+  sb << " {\n";
+  for (auto &arg : constructor->args) {
+    sb << "  fetch_binary(p, to." << tl::simple::gen_cpp_field_name(arg.name) << ", max_depth);\n";
+  }
+  sb << "}\n\n";
+}
+
+// objects are only stored and functions are only fetched, because the converter is used only by the TDLib side
+static void gen_binary_converter_body(StringBuilder &sb, const tl::simple::Schema &schema, bool is_header,
+                                      int file_number, int file_count,
+                                      td::FlatHashSet<std::string> &store_binary_types) {
+  int counter = 0;
+  for (auto *custom_type : schema.custom_types) {
+    if (custom_type->is_result_) {
+      if (custom_type->constructors.size() > 1 && is_suitable(file_number, file_count, counter)) {
+        auto type_name = tl::simple::gen_cpp_name(custom_type->name);
+        for (auto storer_name : STORER_NAMES) {
+          sb << "void store_binary(" << storer_name << " &s, const td_api::" << type_name << " &object)";
+          if (is_header) {
+            sb << ";\n\n";
+          } else {
+            sb << " {\n"
+               << "  td_api::downcast_call(const_cast<td_api::" << type_name
+               << " &>(object), [&s](const auto &object) { store_binary(s, object); });\n"
+               << "}\n\n";
+          }
+        }
+      }
+      for (auto *constructor : custom_type->constructors) {
+        if (is_suitable(file_number, file_count, counter)) {
+          gen_store_binary_constructor(sb, constructor, is_header, store_binary_types);
+        }
+      }
+    }
+    if (custom_type->is_query_) {
+      for (auto *constructor : custom_type->constructors) {
+        if (is_suitable(file_number, file_count, counter)) {
+          gen_fetch_binary_constructor(sb, constructor, is_header);
+        }
+      }
+    }
+  }
+  for (auto *function : schema.functions) {
+    if (is_suitable(file_number, file_count, counter)) {
+      gen_fetch_binary_constructor(sb, function, is_header);
+    }
+  }
+}
+
+static void gen_binary_converter_file(const tl::simple::Schema &schema, const std::string &file_name_base,
+                                      bool is_header, int file_number, int file_count,
+                                      td::FlatHashSet<std::string> &store_binary_types) {
+  string file_name_suffix;
+  if (file_count > 1) {
+    file_name_suffix = "_" + td::to_string(file_number);
+  }
+  auto file_name = is_header ? file_name_base + ".h" : file_name_base + file_name_suffix + ".cpp";
+  auto old_file_content = [&] {
+    auto r_content = read_file(file_name);
+    if (r_content.is_error()) {
+      return BufferSlice();
+    }
+    return r_content.move_as_ok();
+  }();
+
+  std::string buf(2000000, ' ');
+  StringBuilder sb(buf);
+
+  if (is_header) {
+    sb << "#pragma once\n\n";
+
+    sb << "#include \"td/telegram/td_api.h\"\n\n";
+
+    sb << "#include \"td/utils/tl_parsers.h\"\n";
+    sb << "#include \"td/utils/tl_storers.h\"\n\n";
+  } else {
+    sb << "#include \"" << file_name_base << ".h\"\n\n";
+
+    sb << "#include \"td/telegram/td_api.h\"\n";
+    sb << "#include \"td/telegram/td_api.hpp\"\n\n";
+
+    sb << "#include \"td/tl/tl_binary.h\"\n\n";
+
+    sb << "#include \"td/utils/common.h\"\n";
+    sb << "#include \"td/utils/tl_parsers.h\"\n";
+    sb << "#include \"td/utils/tl_storers.h\"\n\n";
+  }
+  sb << "namespace td {\n";
+  sb << "namespace td_api {\n";
+  if (is_header) {
+    sb << "\nvoid store_binary(TlStorerCalcLength &s, const Object &object);\n";
+    sb << "\nvoid store_binary(TlStorerUnsafe &s, const Object &object);\n";
+    sb << "\nvoid fetch_binary(TlParser &p, object_ptr<Function> &to);\n\n";
+  } else {
+    sb << "\nusing td::fetch_binary;\n";
+    sb << "using td::store_binary;\n\n";
+    if (file_number == 0) {
+      sb << "void fetch_binary(TlParser &p, object_ptr<Function> &to) {\n";
+      sb << "  td::fetch_binary(p, to, TL_BINARY_MAX_DEPTH);\n";
+      sb << "}\n\n";
+
+      std::vector<std::string> type_names;
+      for (const auto &type : store_binary_types) {
+        type_names.push_back(tl::simple::gen_cpp_name(type));
+      }
+      std::sort(type_names.begin(), type_names.end());
+      for (auto storer_name : STORER_NAMES) {
+        sb << "void store_binary(" << storer_name << " &s, const Object &object) {\n";
+        sb << "  switch (object.get_id()) {\n";
+        for (const auto &type_name : type_names) {
+          sb << "    case td_api::" << type_name << "::ID:\n";
+          sb << "      return store_binary(s, static_cast<const td_api::" << type_name << " &>(object));\n";
+        }
+        sb << "    default:\n";
+        sb << "      UNREACHABLE();\n";
+        sb << "  }\n";
+        sb << "}\n\n";
+      }
+    }
+  }
+  gen_binary_converter_body(sb, schema, is_header, file_number, file_count, store_binary_types);
+  sb << "}  // namespace td_api\n";
+  sb << "}  // namespace td\n";
+
+  CHECK(!sb.is_error());
+  buf.resize(sb.as_cslice().size());
+#if TD_WINDOWS
+  string new_file_content;
+  for (auto c : buf) {
+    if (c == '\n') {
+      new_file_content += '\r';
+    }
+    new_file_content += c;
+  }
+#else
+  auto new_file_content = std::move(buf);
+#endif
+  if (new_file_content != old_file_content.as_slice()) {
+    write_file(file_name, new_file_content).ensure();
+  }
+}
+
+void gen_binary_converter(const tl::tl_config &config, const std::string &file_name, int source_file_count) {
+  tl::simple::Schema schema(config);
+  td::FlatHashSet<std::string> store_binary_types;
+  gen_binary_converter_file(schema, file_name, true, 0, 1, store_binary_types);
+  for (int i = 0; i < source_file_count; i++) {
+    gen_binary_converter_file(schema, file_name, false, i, source_file_count, store_binary_types);
+  }
+}
+
+}  // namespace td
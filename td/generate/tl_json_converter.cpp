@@ -85,8 +85,98 @@ void gen_to_json_constructor(StringBuilder &sb, const T *constructor, bool is_he
   sb << "}\n\n";
 }
 
+static void gen_store_json_literal(StringBuilder &sb, std::string &literal, Slice offset = "  ") {
+  if (literal.empty()) {
+    return;
+  }
+  sb << offset << "sb << \"";
+  for (auto c : literal) {
+    if (c == '"' || c == '\\') {
+      sb << '\\';
+    }
+    sb << c;
+  }
+  sb << "\";\n";
+  literal.clear();
+}
+
+static void gen_store_json_constructor(StringBuilder &sb, const tl::simple::Constructor *constructor, bool is_header,
+                                       td::FlatHashSet<std::string> &store_json_types) {
+  auto constructor_name = tl::simple::gen_cpp_name(constructor->name);
+  sb << "void store_json(StringBuilder &sb, const td_api::" << constructor_name << " &object)";
+  if (is_header) {
+    store_json_types.insert(constructor->name);
+    sb << ";\n\n";
+    return;
+  }
+  sb << " {\n";
+  // field names are merged with constant parts of the object into precomputed literals;
+  // the output must be byte-identical to the output of to_json
+  std::string literal = "{\"@type\":\"" + constructor_name + "\"";
+  for (auto &arg : constructor->args) {
+    auto field_name = tl::simple::gen_cpp_field_name(arg.name);
+    auto object = PSTRING() << "object." << field_name;
+    if (arg.type->type == tl::simple::Type::Custom) {
+      gen_store_json_literal(sb, literal);
+      sb << "  if (" << object << ") {\n";
+      literal = ",\"" + arg.name + "\":";
+      gen_store_json_literal(sb, literal, "    ");
+      sb << "    store_json(sb, *" << object << ");\n";
+      sb << "  }\n";
+      continue;
+    }
+
+    literal += ",\"" + arg.name + "\":";
+    switch (arg.type->type) {
+      case tl::simple::Type::Int32:
+      case tl::simple::Type::Int53:
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << " << object << ";\n";
+        break;
+      case tl::simple::Type::Int64:
+        literal += '"';
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << " << object << ";\n";
+        literal = "\"";
+        break;
+      case tl::simple::Type::Double:
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << JsonFloat(" << object << ");\n";
+        break;
+      case tl::simple::Type::String:
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << JsonString(" << object << ");\n";
+        break;
+      case tl::simple::Type::Bytes:
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << JsonString(base64_encode(" << object << "));\n";
+        break;
+      case tl::simple::Type::Bool:
+        gen_store_json_literal(sb, literal);
+        sb << "  sb << JsonBool(" << object << ");\n";
+        break;
+      case tl::simple::Type::Vector:
+        gen_store_json_literal(sb, literal);
+        if (need_bytes(arg.type)) {
+          sb << "  UNSUPPORTED STORED VECTOR OF BYTES\n";
+        } else if (arg.type->vector_value_type->type == tl::simple::Type::Int64) {
+          sb << "  store_json(sb, JsonVectorInt64{" << object << "});\n";
+        } else {
+          sb << "  store_json(sb, " << object << ");\n";
+        }
+        break;
+      default:
+        UNREACHABLE();
+    }
+  }
+  literal += '}';
+  gen_store_json_literal(sb, literal);
+  sb << "}\n\n";
+}
+
 void gen_to_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_header, Mode mode, int file_number,
-                 int file_count, int &counter, td::FlatHashSet<std::string> &to_json_types) {
+                 int file_count, int &counter, td::FlatHashSet<std::string> &to_json_types,
+                 td::FlatHashSet<std::string> &store_json_types) {
   for (auto *custom_type : schema.custom_types) {
     if (!((custom_type->is_query_ && mode != Mode::Server) || (custom_type->is_result_ && mode != Mode::Client))) {
       continue;
@@ -106,9 +196,20 @@ void gen_to_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_he
               "to_json(jv, object); });\n"
            << "}\n\n";
       }
+      sb << "void store_json(StringBuilder &sb, const td_api::" << type_name << " &object)";
+      if (is_header) {
+        sb << ";\n\n";
+      } else {
+        sb << " {\n"
+           << "  td_api::downcast_call(const_cast<td_api::" << type_name
+           << " &>(object), [&sb](const auto &object) { "
+              "store_json(sb, object); });\n"
+           << "}\n\n";
+      }
     }
     for (auto *constructor : custom_type->constructors) {
       gen_to_json_constructor(sb, constructor, is_header, to_json_types);
+      gen_store_json_constructor(sb, constructor, is_header, store_json_types);
     }
   }
   if (mode == Mode::Server) {
@@ -223,7 +324,8 @@ void gen_tl_constructor_from_string(StringBuilder &sb, const tl::simple::Schema
 }
 
 void gen_json_converter_file(const tl::simple::Schema &schema, const std::string &file_name_base, bool is_header,
-                             Mode mode, int file_number, int file_count, td::FlatHashSet<std::string> &to_json_types) {
+                             Mode mode, int file_number, int file_count, td::FlatHashSet<std::string> &to_json_types,
+                             td::FlatHashSet<std::string> &store_json_types) {
   string file_name_suffix;
   if (file_count > 1) {
     file_name_suffix = "_" + td::to_string(file_number);
@@ -246,7 +348,8 @@ void gen_json_converter_file(const tl::simple::Schema &schema, const std::string
     sb << "#include \"td/telegram/td_api.h\"\n\n";
 
     sb << "#include \"td/utils/JsonBuilder.h\"\n";
-    sb << "#include \"td/utils/Status.h\"\n\n";
+    sb << "#include \"td/utils/Status.h\"\n";
+    sb << "#include \"td/utils/StringBuilder.h\"\n\n";
   } else {
     sb << "#include \"" << file_name_base << ".h\"\n\n";
 
@@ -258,14 +361,16 @@ void gen_json_converter_file(const tl::simple::Schema &schema, const std::string
     sb << "#include \"td/utils/base64.h\"\n";
     sb << "#include \"td/utils/common.h\"\n";
     sb << "#include \"td/utils/FlatHashMap.h\"\n";
-    sb << "#include \"td/utils/Slice.h\"\n\n";
+    sb << "#include \"td/utils/Slice.h\"\n";
+    sb << "#include \"td/utils/StringBuilder.h\"\n\n";
   }
   sb << "namespace td {\n";
   sb << "namespace td_api {\n";
   if (is_header) {
     sb << "\nvoid to_json(JsonValueScope &jv, const td_api::object_ptr<Object> &value);\n";
     sb << "\nStatus from_json(td_api::object_ptr<Function> &to, td::JsonValue from);\n";
-    sb << "\nvoid to_json(JsonValueScope &jv, const Object &object);\n\n";
+    sb << "\nvoid to_json(JsonValueScope &jv, const Object &object);\n";
+    sb << "\nvoid store_json(StringBuilder &sb, const Object &object);\n\n";
   } else if (file_number == 0) {
     sb << R"ABCD(
 void to_json(JsonValueScope &jv, const td_api::object_ptr<Object> &value) {
@@ -293,11 +398,27 @@ void to_json(JsonValueScope &jv, const Object &object) {
     sb << "      UNREACHABLE();\n";
     sb << "  }\n";
     sb << "}\n\n";
+
+    sb << "void store_json(StringBuilder &sb, const Object &object) {\n";
+    sb << "  switch (object.get_id()) {\n";
+    type_names.clear();
+    for (const auto &type : store_json_types) {
+      type_names.push_back(tl::simple::gen_cpp_name(type));
+    }
+    std::sort(type_names.begin(), type_names.end());
+    for (const auto &type_name : type_names) {
+      sb << "    case td_api::" << type_name << "::ID:\n";
+      sb << "      return store_json(sb, static_cast<const td_api::" << type_name << " &>(object));\n";
+    }
+    sb << "    default:\n";
+    sb << "      UNREACHABLE();\n";
+    sb << "  }\n";
+    sb << "}\n\n";
   }
   int counter = 0;
   gen_tl_constructor_from_string(sb, schema, is_header, mode, file_number, file_count, counter);
   gen_from_json(sb, schema, is_header, mode, file_number, file_count, counter);
-  gen_to_json(sb, schema, is_header, mode, file_number, file_count, counter, to_json_types);
+  gen_to_json(sb, schema, is_header, mode, file_number, file_count, counter, to_json_types, store_json_types);
   sb << "}  // namespace td_api\n";
   sb << "}  // namespace td\n";
 
@@ -322,9 +443,10 @@ void to_json(JsonValueScope &jv, const Object &object) {
 void gen_json_converter(const tl::tl_config &config, const std::string &file_name, Mode mode, int source_file_count) {
   tl::simple::Schema schema(config);
   td::FlatHashSet<std::string> to_json_types;
-  gen_json_converter_file(schema, file_name, true, mode, 0, 1, to_json_types);
+  td::FlatHashSet<std::string> store_json_types;
+  gen_json_converter_file(schema, file_name, true, mode, 0, 1, to_json_types, store_json_types);
   for (int i = 0; i < source_file_count; i++) {
-    gen_json_converter_file(schema, file_name, false, mode, i, source_file_count, to_json_types);
+    gen_json_converter_file(schema, file_name, false, mode, i, source_file_count, to_json_types, store_json_types);
   }
 }
 
@@ -90,6 +90,12 @@ std::string TD_TL_writer_cpp::gen_vars(const tl::tl_combinator *t, const tl::tl_
       res += "  " + gen_class_name("#") + " " + gen_var_name(vars[i]) + ";\n";
     }
   }
+  if (!skip_function_code.empty()) {
+    skip_function_code += res;
+  }
+  if (!id_fetch_function_code.empty()) {
+    id_fetch_function_code += res;
+  }
   return res;
 }
 
@@ -208,6 +214,22 @@ std::string TD_TL_writer_cpp::gen_full_fetch_class_name(const tl::tl_tree_type *
   return "TlFetchBoxed<" + gen_fetch_class_name(tree_type) + ", " + int_to_string(expected_constructor_id) + ">";
 }
 
+std::string TD_TL_writer_cpp::gen_lazy_vector_fetch_class_name(const tl::tl_tree_type *tree_type) const {
+  std::string res = gen_full_fetch_class_name(tree_type);
+  assert(tree_type->children.size() == 1);
+  assert(tree_type->children[0]->get_type() == tl::NODE_TYPE_TYPE);
+  std::string element_fetch_class_name =
+      gen_full_fetch_class_name(static_cast<const tl::tl_tree_type *>(tree_type->children[0]));
+  const std::string object_prefix = "TlFetchObject<";
+  assert(element_fetch_class_name.compare(0, object_prefix.size(), object_prefix) == 0);
+
+  std::string vector_fetch_class_name = "TlFetchVector<" + element_fetch_class_name + ">";
+  auto pos = res.find(vector_fetch_class_name);
+  assert(pos != std::string::npos);
+  return res.replace(pos, vector_fetch_class_name.size(),
+                     "TlFetchLazyVector<" + element_fetch_class_name.substr(object_prefix.size()));
+}
+
 std::string TD_TL_writer_cpp::gen_type_fetch(const std::string &field_name, const tl::tl_tree_type *tree_type,
                                              const std::vector<tl::var_description> &vars, int parser_type) const {
   return gen_full_fetch_class_name(tree_type) + "::parse(p)";
@@ -231,6 +253,7 @@ std::string TD_TL_writer_cpp::gen_field_fetch(int field_num, const tl::arg &a, s
     assert(vars[t->var_num].is_type);
     assert(!vars[t->var_num].is_stored);
     vars[t->var_num].is_stored = true;
+    assert(skip_function_code.empty());
 
     return "  " + field_name + " = " + gen_base_function_class_name() + "::fetch(p);\n";
   }
@@ -257,6 +280,7 @@ std::string TD_TL_writer_cpp::gen_field_fetch(int field_num, const tl::arg &a, s
   if (a.exist_var_num != -1) {
     res += "if (" + gen_var_name(vars[a.exist_var_num]) + " & " + int_to_string(1 << a.exist_var_bit) + ") { ";
   }
+  std::string skip = res;
 
   if (flat) {
     //    TODO
@@ -270,6 +294,7 @@ std::string TD_TL_writer_cpp::gen_field_fetch(int field_num, const tl::arg &a, s
     assert(0 <= a.var_num && a.var_num < static_cast<int>(vars.size()));
     if (!vars[a.var_num].is_stored) {
       res += "if ((" + gen_var_name(vars[a.var_num]) + " = ";
+      skip += "if ((" + gen_var_name(vars[a.var_num]) + " = ";
       store_to_var_num = true;
     } else {
       assert(false);
@@ -281,20 +306,43 @@ std::string TD_TL_writer_cpp::gen_field_fetch(int field_num, const tl::arg &a, s
 
   assert(a.type->get_type() == tl::NODE_TYPE_TYPE);
   const tl::tl_tree_type *tree_type = static_cast<tl::tl_tree_type *>(a.type);
-  res += gen_type_fetch(field_name, tree_type, vars, parser_type);
+  if (is_lazy_vector_field(fetched_class_name, gen_field_name(a.name))) {
+    res += gen_lazy_vector_fetch_class_name(tree_type) + "::parse(p)";
+    skip += gen_lazy_vector_fetch_class_name(tree_type);
+  } else {
+    res += gen_type_fetch(field_name, tree_type, vars, parser_type);
+    skip += gen_full_fetch_class_name(tree_type);
+  }
   if (store_to_var_num) {
     res += ") < 0) { FAIL(\"Variable of type # can't be negative\"); }";
+    skip += "::parse(p)) < 0) { FAIL(\"Variable of type # can't be negative\"); }";
   } else {
     res += (parser_type == 0 ? ")" : ";");
+    skip += "::skip(p);";
   }
 
   if (a.exist_var_num >= 0) {
     res += " }";
+    skip += " }";
     if (store_to_var_num) {
       res += " else { " + gen_var_name(vars[a.var_num]) + " = 0; }";
+      skip += " else { " + gen_var_name(vars[a.var_num]) + " = 0; }";
     }
   }
   res += "\n";
+  if (!skip_function_code.empty()) {
+    skip_function_code += skip + "\n";
+  }
+  if (!id_fetch_function_code.empty()) {
+    if (a.name == "id") {
+      assert(a.exist_var_num == -1);
+      assert(gen_full_fetch_class_name(tree_type) == "TlFetchLong");
+      id_fetch_function = id_fetch_function_code + "  return TlFetchLong::parse(p);\n#undef FAIL\n}\n";
+      id_fetch_function_code.clear();
+    } else {
+      id_fetch_function_code += skip + "\n";
+    }
+  }
   return res;
 }
 
@@ -564,6 +612,23 @@ std::string TD_TL_writer_cpp::gen_fetch_function_begin(const std::string &parser
     assert(!vars[i].is_stored);
   }
 
+  fetched_class_name = class_name;
+  skip_function_code.clear();
+  if (is_skip_function_generated(class_name)) {
+    skip_function_code = "\nvoid " + class_name + "::skip(" + parser_name + " &p) {\n";
+    if (parser_type != 0) {
+      skip_function_code += "#define FAIL(error) p.set_error(error); return;\n";
+    }
+  }
+  id_fetch_function_code.clear();
+  id_fetch_function.clear();
+  if (is_id_fetch_function_generated(class_name)) {
+    assert(parser_type != 0);
+    id_fetch_function_code = "\nint64 " + class_name + "::fetch_id(" + parser_name +
+                             " &p) {\n"
+                             "#define FAIL(error) p.set_error(error); return 0;\n";
+  }
+
   std::string fetched_type = "object_ptr<" + class_name + "> ";
   std::string returned_type = "object_ptr<" + parent_class_name + "> ";
   assert(arity == 0);
@@ -597,16 +662,26 @@ std::string TD_TL_writer_cpp::gen_fetch_function_end(bool has_parent, int field_
     assert(vars[i].is_stored);
   }
 
+  std::string skip_function;
+  if (!skip_function_code.empty()) {
+    skip_function = skip_function_code + (parser_type == 0 ? "" : "#undef FAIL\n") + "}\n";
+    skip_function_code.clear();
+  }
+  assert(id_fetch_function_code.empty());
+  skip_function += id_fetch_function;
+  id_fetch_function.clear();
+
   if (parser_type == 0) {
     if (field_count == 0) {
-      return "}\n";
+      return "}\n" + skip_function;
     }
-    return "{}\n";
+    return "{}\n" + skip_function;
   }
 
   if (parser_type == -1) {
     return "#undef FAIL\n"
-           "}\n";
+           "}\n" +
+           skip_function;
   }
 
   return "  if (p.get_error()) { FAIL(\"\"); }\n"
@@ -614,7 +689,8 @@ std::string TD_TL_writer_cpp::gen_fetch_function_end(bool has_parent, int field_
          std::string(has_parent ? "std::move(res)" : "res") +
          ";\n"
          "#undef FAIL\n"
-         "}\n";
+         "}\n" +
+         skip_function;
 }
 
 std::string TD_TL_writer_cpp::gen_fetch_function_result_begin(const std::string &parser_name,
@@ -680,12 +756,25 @@ std::string TD_TL_writer_cpp::gen_store_function_end(const std::vector<tl::var_d
 }
 
 std::string TD_TL_writer_cpp::gen_fetch_switch_begin() const {
-  return "  int constructor = p.fetch_int();\n"
-         "  switch (constructor) {\n";
+  std::string res =
+      "  int constructor = p.fetch_int();\n"
+      "  switch (constructor) {\n";
+  if (!skip_function_code.empty()) {
+    skip_function_code += res;
+  }
+  return res;
 }
 
 std::string TD_TL_writer_cpp::gen_fetch_switch_case(const tl::tl_combinator *t, int arity) const {
   assert(arity == 0);
+  if (!skip_function_code.empty()) {
+    skip_function_code += "    case " + gen_class_name(t->name) +
+                          "::ID:\n"
+                          "      " +
+                          gen_class_name(t->name) +
+                          "::skip(p);\n"
+                          "      return;\n";
+  }
   return "    case " + gen_class_name(t->name) +
          "::ID:\n"
          "      return " +
@@ -693,9 +782,14 @@ std::string TD_TL_writer_cpp::gen_fetch_switch_case(const tl::tl_combinator *t,
 }
 
 std::string TD_TL_writer_cpp::gen_fetch_switch_end() const {
-  return "    default:\n"
-         "      FAIL(PSTRING() << \"Unknown constructor found \" << format::as_hex(constructor));\n"
-         "  }\n";
+  std::string res =
+      "    default:\n"
+      "      FAIL(PSTRING() << \"Unknown constructor found \" << format::as_hex(constructor));\n"
+      "  }\n";
+  if (!skip_function_code.empty()) {
+    skip_function_code += res;
+  }
+  return res;
 }
 
 std::string TD_TL_writer_cpp::gen_constructor_begin(int field_count, const std::string &class_name,
@@ -709,10 +803,13 @@ std::string TD_TL_writer_cpp::gen_constructor_field_init(int field_num, const st
   if (field_type.empty()) {
     return "";
   }
+  if (is_lazy_vector_field(class_name, gen_field_name(a.name))) {
+    field_type = gen_lazy_vector_type_name(field_type);
+  }
   std::string move_begin;
   std::string move_end;
   if ((field_type == "bytes" || field_type == "secure_bytes" || field_type.compare(0, 5, "array") == 0 ||
-       field_type.compare(0, 10, "object_ptr") == 0) &&
+       field_type.compare(0, 10, "object_ptr") == 0 || field_type.compare(0, 12, "TlLazyVector") == 0) &&
       !is_default) {
     move_begin = "std::move(";
     move_end = ")";
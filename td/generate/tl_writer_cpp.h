@@ -21,12 +21,21 @@ class TD_TL_writer_cpp : public TD_TL_writer {
 
   std::string gen_full_fetch_class_name(const tl::tl_tree_type *tree_type) const;
 
+  std::string gen_lazy_vector_fetch_class_name(const tl::tl_tree_type *tree_type) const;
+
   std::string gen_store_class_name(const tl::tl_tree_type *tree_type) const;
 
   std::string gen_full_store_class_name(const tl::tl_tree_type *tree_type) const;
 
   std::vector<std::string> ext_include;
 
+  // the skip function is generated simultaneously with the corresponding fetch function
+  mutable std::string fetched_class_name;
+  mutable std::string skip_function_code;
+  // the id fetch function is generated simultaneously with the skip function and is complete after the field id
+  mutable std::string id_fetch_function_code;
+  mutable std::string id_fetch_function;
+
  protected:
   std::string gen_vector_store(const std::string &field_name, const tl::tl_tree_type *t,
                                const std::vector<tl::var_description> &vars, int storer_type) const;
@@ -133,6 +133,9 @@ std::string TD_TL_writer_h::gen_output_end() const {
 
 std::string TD_TL_writer_h::gen_field_definition(const std::string &class_name, const std::string &type_name,
                                                  const std::string &field_name) const {
+  if (is_lazy_vector_field(class_name, field_name)) {
+    return "  " + gen_lazy_vector_type_name(type_name) + " " + field_name + ";\n";
+  }
   return "  " + type_name + (type_name.empty() || type_name[type_name.size() - 1] == ' ' ? "" : " ") + field_name +
          ";\n";
 }
@@ -277,9 +280,21 @@ std::string TD_TL_writer_h::gen_forward_class_declaration(const std::string &cla
 std::string TD_TL_writer_h::gen_class_begin(const std::string &class_name, const std::string &base_class_name,
                                             bool is_proxy, const tl::tl_tree *result) const {
   if (is_proxy) {
+    std::string allocator;
+    if (tl_name == "telegram_api" && class_name == gen_base_type_class_name(0)) {
+      // objects of big server responses are allocated from an arena
+      allocator =
+          "  static void *operator new(std::size_t size) {\n"
+          "    return ::td::ArenaAllocator::allocate(size);\n"
+          "  }\n\n"
+          "  static void operator delete(void *ptr) {\n"
+          "    ::td::ArenaAllocator::deallocate(ptr);\n"
+          "  }\n";
+    }
     return "class " + class_name + ": public " + base_class_name +
            " {\n"
-           " public:\n";
+           " public:\n" +
+           allocator;
   }
   return "class " + class_name + " final : public " + base_class_name +
          " {\n"
@@ -330,12 +345,19 @@ std::string TD_TL_writer_h::gen_fetch_function_begin(const std::string &parser_n
                                                      const std::string &parent_class_name, int arity, int field_count,
                                                      std::vector<tl::var_description> &vars, int parser_type) const {
   std::string returned_type = "object_ptr<" + parent_class_name + "> ";
+  std::string skip_function;
+  if (is_skip_function_generated(class_name)) {
+    skip_function = "\n  static void skip(" + parser_name + " &p);\n";
+  }
+  if (is_id_fetch_function_generated(class_name)) {
+    skip_function += "\n  static int64 fetch_id(" + parser_name + " &p);\n";
+  }
 
   if (parser_type == 0) {
     std::string result =
         "\n"
         "  static " +
-        returned_type + "fetch(" + parser_name + " &p);\n";
+        returned_type + "fetch(" + parser_name + " &p);\n" + skip_function;
     if (field_count != 0) {
       result +=
           "\n"
@@ -348,7 +370,7 @@ std::string TD_TL_writer_h::gen_fetch_function_begin(const std::string &parser_n
   assert(arity == 0);
   return "\n"
          "  static " +
-         returned_type + "fetch(" + parser_name + " &p);\n";
+         returned_type + "fetch(" + parser_name + " &p);\n" + skip_function;
 }
 
 std::string TD_TL_writer_h::gen_fetch_function_end(bool has_parent, int field_count,
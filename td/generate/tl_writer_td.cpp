@@ -271,6 +271,9 @@ std::string TD_TL_writer::gen_constructor_parameter(int field_num, const std::st
   if (field_type.empty()) {
     return "";
   }
+  if (is_lazy_vector_field(class_name, gen_field_name(a.name))) {
+    field_type = gen_lazy_vector_type_name(field_type);
+  }
 
   if (field_type[field_type.size() - 1] != ' ') {
     field_type += ' ';
@@ -285,7 +288,7 @@ std::string TD_TL_writer::gen_constructor_parameter(int field_num, const std::st
              field_type == "secure_string " || (string_type == bytes_type && field_type == "secure_bytes ")) {
     res += field_type + "const &";
   } else if (field_type.compare(0, 5, "array") == 0 || field_type == "bytes " || field_type == "secure_bytes " ||
-             field_type.compare(0, 10, "object_ptr") == 0) {
+             field_type.compare(0, 10, "object_ptr") == 0 || field_type.compare(0, 12, "TlLazyVector") == 0) {
     res += field_type + "&&";
   } else {
     assert(false && "unreachable");
@@ -294,4 +297,31 @@ std::string TD_TL_writer::gen_constructor_parameter(int field_num, const std::st
   return res + gen_field_name(a.name);
 }
 
+bool TD_TL_writer::is_skip_function_generated(const std::string &class_name) const {
+  return tl_name == "telegram_api" && class_name != gen_base_type_class_name(0) &&
+         class_name != gen_base_function_class_name();
+}
+
+bool TD_TL_writer::is_id_fetch_function_generated(const std::string &class_name) const {
+  // identifiers of objects in lazy vectors are needed without parsing of the whole objects
+  return tl_name == "telegram_api" && (class_name == "user" || class_name == "chat" || class_name == "channel");
+}
+
+bool TD_TL_writer::is_lazy_vector_field(const std::string &class_name, const std::string &field_name) const {
+  // most users and chats in differences are already known and don't need to be parsed
+  return tl_name == "telegram_api" &&
+         (class_name == "updates_difference" || class_name == "updates_differenceSlice") &&
+         (field_name == "users_" || field_name == "chats_");
+}
+
+std::string TD_TL_writer::gen_lazy_vector_type_name(const std::string &array_type_name) {
+  const std::string prefix = "array<object_ptr<";
+  const std::string suffix = ">>";
+  assert(array_type_name.size() > prefix.size() + suffix.size());
+  assert(array_type_name.compare(0, prefix.size(), prefix) == 0);
+  assert(array_type_name.compare(array_type_name.size() - suffix.size(), suffix.size(), suffix) == 0);
+  return "TlLazyVector<" +
+         array_type_name.substr(prefix.size(), array_type_name.size() - prefix.size() - suffix.size()) + ">";
+}
+
 }  // namespace td
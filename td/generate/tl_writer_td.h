@@ -24,6 +24,16 @@ class TD_TL_writer : public tl::TL_writer {
   const std::string string_type;
   const std::string bytes_type;
 
+  bool is_skip_function_generated(const std::string &class_name) const;
+
+  // the function parses only fields before the field id, which must be present in all objects of the class
+  bool is_id_fetch_function_generated(const std::string &class_name) const;
+
+  // elements of such vectors are parsed only on access
+  bool is_lazy_vector_field(const std::string &class_name, const std::string &field_name) const;
+
+  static std::string gen_lazy_vector_type_name(const std::string &array_type_name);
+
  public:
   TD_TL_writer(const std::string &tl_name, const std::string &string_type, const std::string &bytes_type)
       : TL_writer(tl_name), string_type(string_type), bytes_type(bytes_type) {
@@ -0,0 +1,74 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/MtprotoQueryQueue.h"
+
+#include "td/utils/logging.h"
+
+#include <iterator>
+#include <utility>
+
+namespace td {
+namespace mtproto {
+
+void MtprotoQueryQueue::set_packing_delay(double packing_delay) {
+  packing_delay_ = max(packing_delay, 0.0);
+}
+
+double MtprotoQueryQueue::push(MtprotoQuery &&query, bool is_high_priority, double now) {
+  auto query_size = query.packet.size();
+  double send_at = now;
+  if (!query.use_quick_ack && !is_high_priority && query_size <= MAX_PACKED_QUERY_SIZE &&
+      queries_size_ + query_size < MAX_CONTAINER_SIZE && queries_.size() + 1 < MAX_CONTAINER_QUERY_COUNT) {
+    send_at += packing_delay_;
+  }
+  // the window isn't extended by subsequent queries
+  if (send_at_ == 0 || send_at < send_at_) {
+    send_at_ = send_at;
+  }
+  queries_size_ += query_size;
+  queries_.push_back(std::move(query));
+  return send_at_;
+}
+
+vector<MtprotoQuery> MtprotoQueryQueue::pop_container() {
+  vector<MtprotoQuery> result;
+  if (queries_size_ <= MAX_CONTAINER_SIZE && queries_.size() <= MAX_CONTAINER_QUERY_COUNT) {
+    std::swap(result, queries_);
+    queries_size_ = 0;
+    send_at_ = 0;
+    return result;
+  }
+
+  // queries are taken strictly in their order to keep message identifiers increasing across containers
+  size_t container_size = 0;
+  size_t query_count = 0;
+  while (query_count < queries_.size() && query_count < MAX_CONTAINER_QUERY_COUNT) {
+    auto query_size = queries_[query_count].packet.size();
+    if (query_count > 0 && container_size + query_size > MAX_CONTAINER_SIZE) {
+      break;
+    }
+    container_size += query_size;
+    query_count++;
+  }
+  CHECK(query_count < queries_.size());
+  auto end = queries_.begin() + query_count;
+  result.reserve(query_count);
+  std::move(queries_.begin(), end, std::back_inserter(result));
+  queries_.erase(queries_.begin(), end);
+  CHECK(queries_size_ >= container_size);
+  queries_size_ -= container_size;
+  return result;
+}
+
+void MtprotoQueryQueue::clear() {
+  queries_.clear();
+  queries_size_ = 0;
+  send_at_ = 0;
+}
+
+}  // namespace mtproto
+}  // namespace td
@@ -0,0 +1,52 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/mtproto/MtprotoQuery.h"
+
+#include "td/utils/common.h"
+
+namespace td {
+namespace mtproto {
+
+// queries waiting to be sent; small queries are delayed to be packed in the same container
+class MtprotoQueryQueue {
+ public:
+  static constexpr size_t MAX_PACKED_QUERY_SIZE = 1 << 10;
+  static constexpr size_t MAX_CONTAINER_SIZE = 1 << 15;
+  static constexpr size_t MAX_CONTAINER_QUERY_COUNT = 1000;
+
+  // small queries are delayed for at most packing_delay seconds after the first pending query
+  void set_packing_delay(double packing_delay);
+
+  // returns time before which pending queries must be sent
+  double push(MtprotoQuery &&query, bool is_high_priority, double now);
+
+  // returns pending queries for the next container in their order
+  vector<MtprotoQuery> pop_container();
+
+  void clear();
+
+  bool empty() const {
+    return queries_.empty();
+  }
+
+  size_t size() const {
+    return queries_.size();
+  }
+
+ private:
+  static constexpr double DEFAULT_PACKING_DELAY = 0.001;  // 0.001s
+
+  vector<MtprotoQuery> queries_;
+  size_t queries_size_ = 0;
+  double packing_delay_ = DEFAULT_PACKING_DELAY;
+  double send_at_ = 0;
+};
+
+}  // namespace mtproto
+}  // namespace td
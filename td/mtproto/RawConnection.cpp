@@ -160,18 +160,29 @@ class RawConnectionDefault final : public RawConnection {
     if (r.is_ok()) {
       on_read(r.ok(), callback);
     }
+
+    // all received packets are decrypted together, which is much faster than decrypting them one by one
+    static constexpr size_t MAX_READ_BATCH_SIZE = 16;
+    vector<BufferSlice> packets;
     while (transport_->can_read()) {
       BufferSlice packet;
       uint32 quick_ack = 0;
-      TRY_RESULT(wait_size, transport_->read_next(&packet, &quick_ack));
+      auto r_wait_size = transport_->read_next(&packet, &quick_ack);
+      if (r_wait_size.is_error()) {
+        TRY_STATUS(on_read_packets(packets, auth_key, callback));
+        return r_wait_size.move_as_error();
+      }
+      auto wait_size = r_wait_size.move_as_ok();
       if (wait_size != 0) {
         constexpr size_t MAX_PACKET_SIZE = (1 << 22) + 1024;
         if (wait_size > MAX_PACKET_SIZE) {
+          TRY_STATUS(on_read_packets(packets, auth_key, callback));
           return Status::Error(PSLICE() << "Expected packet size is too big: " << wait_size);
         }
         break;
       }
       if (quick_ack != 0) {
+        TRY_STATUS(on_read_packets(packets, auth_key, callback));
         TRY_STATUS(on_quick_ack(quick_ack, callback));
         continue;
       }
@@ -186,10 +197,38 @@ class RawConnectionDefault final : public RawConnection {
           << old_pointer << ' ' << packet.as_slice().ubegin() << ' ' << BufferSlice(0).as_slice().ubegin() << ' '
           << packet.size() << ' ' << wait_size << ' ' << quick_ack;
 
-      PacketInfo packet_info;
+      packets.push_back(std::move(packet));
+      if (packets.size() == MAX_READ_BATCH_SIZE) {
+        TRY_STATUS(on_read_packets(packets, auth_key, callback));
+      }
+    }
+    TRY_STATUS(on_read_packets(packets, auth_key, callback));
+
+    TRY_STATUS(std::move(r));
+    return Status::OK();
+  }
+
+  Status on_read_packets(vector<BufferSlice> &packets, const AuthKey &auth_key, Callback &callback) {
+    if (packets.empty()) {
+      return Status::OK();
+    }
+
+    auto packet_count = packets.size();
+    vector<MutableSlice> messages;
+    messages.reserve(packet_count);
+    for (auto &packet : packets) {
+      messages.push_back(packet.as_mutable_slice());
+    }
+    vector<PacketInfo> packet_infos(packet_count);
+    for (auto &packet_info : packet_infos) {
       packet_info.version = 2;
+    }
+    auto read_results = Transport::read_batch(messages, auth_key, packet_infos);
+    auto received_packets = std::move(packets);
+    packets.clear();
 
-      TRY_RESULT(read_result, Transport::read(packet.as_mutable_slice(), auth_key, &packet_info));
+    for (size_t i = 0; i < packet_count; i++) {
+      TRY_RESULT(read_result, std::move(read_results[i]));
       switch (read_result.type()) {
         case Transport::ReadResult::Quickack:
           TRY_STATUS(on_quick_ack(read_result.quick_ack(), callback));
@@ -205,7 +244,7 @@ class RawConnectionDefault final : public RawConnection {
             }
           }
 
-          TRY_STATUS(callback.on_raw_packet(packet_info, packet.from_slice(read_result.packet())));
+          TRY_STATUS(callback.on_raw_packet(packet_infos[i], received_packets[i].from_slice(read_result.packet())));
           break;
         case Transport::ReadResult::Nop:
           break;
@@ -213,8 +252,6 @@ class RawConnectionDefault final : public RawConnection {
           UNREACHABLE();
       }
     }
-
-    TRY_STATUS(std::move(r));
     return Status::OK();
   }
 
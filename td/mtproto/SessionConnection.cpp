@@ -29,9 +29,8 @@
 #include "td/utils/tl_parsers.h"
 #include "td/utils/TlDowncastHelper.h"
 
-#include <algorithm>
-#include <iterator>
 #include <type_traits>
+#include <utility>
 
 namespace td {
 
@@ -810,23 +809,26 @@ void SessionConnection::send_crypto(const Storer &storer, uint64 quick_ack_token
 }
 
 MessageId SessionConnection::send_query(BufferSlice buffer, bool gzip_flag, MessageId message_id,
-                                        vector<MessageId> invoke_after_message_ids, bool use_quick_ack) {
+                                        vector<MessageId> invoke_after_message_ids, bool use_quick_ack,
+                                        bool is_high_priority) {
   CHECK(mode_ != Mode::HttpLongPoll);  // "LongPoll connection is only for http_wait"
   if (message_id == MessageId()) {
     message_id = auth_data_->next_message_id(Time::now_cached());
   }
   auto seq_no = auth_data_->next_seq_no(true);
-  if (to_send_.empty()) {
-    send_before(Time::now_cached() + QUERY_DELAY);
-  }
-  to_send_.push_back(MtprotoQuery{message_id, seq_no, std::move(buffer), gzip_flag, std::move(invoke_after_message_ids),
-                                  use_quick_ack});
-  VLOG(mtproto) << "Invoke query with " << message_id << " and seq_no " << seq_no << " of size "
-                << to_send_.back().packet.size() << " after " << invoke_after_message_ids
-                << (use_quick_ack ? " with quick ack" : "");
+  VLOG(mtproto) << "Invoke query with " << message_id << " and seq_no " << seq_no << " of size " << buffer.size()
+                << " after " << invoke_after_message_ids << (use_quick_ack ? " with quick ack" : "")
+                << (is_high_priority ? " with high priority" : "");
+  send_before(to_send_.push(MtprotoQuery{message_id, seq_no, std::move(buffer), gzip_flag,
+                                         std::move(invoke_after_message_ids), use_quick_ack},
+                            is_high_priority, Time::now_cached()));
   return message_id;
 }
 
+void SessionConnection::set_query_packing_delay(double query_packing_delay) {
+  to_send_.set_packing_delay(query_packing_delay);
+}
+
 void SessionConnection::get_state_info(MessageId message_id) {
   if (to_get_state_info_message_ids_.empty()) {
     send_before(Time::now_cached());
@@ -944,23 +946,9 @@ void SessionConnection::flush_packet() {
     }
   }
 
-  static constexpr size_t MAX_QUERY_COUNT = 1000;
-  size_t send_till = 0;
-  size_t send_size = 0;
-  if (has_salt) {
-    // send at most MAX_QUERY_COUNT queries, of total size up to 2^15
-    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < (1 << 15)) {
-      send_size += to_send_[send_till].packet.size();
-      send_till++;
-    }
-  }
   vector<MtprotoQuery> queries;
-  if (send_till == to_send_.size()) {
-    queries = std::move(to_send_);
-  } else if (send_till != 0) {
-    queries.reserve(send_till);
-    std::move(to_send_.begin(), to_send_.begin() + send_till, std::back_inserter(queries));
-    to_send_.erase(to_send_.begin(), to_send_.begin() + send_till);
+  if (has_salt) {
+    queries = to_send_.pop_container();
   }
 
   bool destroy_auth_key = need_destroy_auth_key_ && !sent_destroy_auth_key_;
@@ -1004,8 +992,9 @@ void SessionConnection::flush_packet() {
   // no more than 8192 message identifiers per container..
   auto to_resend_answer = cut_tail(to_resend_answer_message_ids_, 8192, "resend_answer");
   MessageId resend_answer_message_id;
-  CHECK(queries.size() <= MAX_QUERY_COUNT);
-  auto to_cancel_answer = cut_tail(to_cancel_answer_message_ids_, MAX_QUERY_COUNT - queries.size(), "cancel_answer");
+  CHECK(queries.size() <= MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT);
+  auto to_cancel_answer = cut_tail(to_cancel_answer_message_ids_,
+                                   MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT - queries.size(), "cancel_answer");
   auto to_get_state_info = cut_tail(to_get_state_info_message_ids_, 8192, "get_state_info");
   MessageId get_state_info_message_id;
   auto to_ack = cut_tail(to_ack_message_ids_, 8192, "ack");
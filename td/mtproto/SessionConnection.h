@@ -8,6 +8,7 @@
 
 #include "td/mtproto/MessageId.h"
 #include "td/mtproto/MtprotoQuery.h"
+#include "td/mtproto/MtprotoQueryQueue.h"
 #include "td/mtproto/PacketInfo.h"
 #include "td/mtproto/RawConnection.h"
 
@@ -69,7 +70,7 @@ class SessionConnection final
 
   // Interface
   MessageId send_query(BufferSlice buffer, bool gzip_flag, MessageId message_id,
-                       vector<MessageId> invoke_after_message_ids, bool use_quick_ack);
+                       vector<MessageId> invoke_after_message_ids, bool use_quick_ack, bool is_high_priority);
 
   std::pair<MessageId, BufferSlice> encrypted_bind(int64 perm_key, int64 nonce, int32 expires_at);
 
@@ -83,6 +84,9 @@ class SessionConnection final
 
   void set_online(bool online_flag, bool is_main);
 
+  // small queries are delayed for at most query_packing_delay seconds to be sent in the same container
+  void set_query_packing_delay(double query_packing_delay);
+
   void force_ack();
 
   Slice get_debug_str() const {
@@ -127,7 +131,6 @@ class SessionConnection final
 
  private:
   static constexpr int ACK_DELAY = 30;                  // 30s
-  static constexpr double QUERY_DELAY = 0.001;          // 0.001s
   static constexpr double RESEND_ANSWER_DELAY = 0.001;  // 0.001s
 
   struct MsgInfo {
@@ -168,7 +171,7 @@ class SessionConnection final
   static constexpr int HTTP_MAX_AFTER = 10;  // 0.01s
   static constexpr int HTTP_MAX_DELAY = 30;  // 0.03s
 
-  vector<MtprotoQuery> to_send_;
+  MtprotoQueryQueue to_send_;
   vector<MessageId> to_ack_message_ids_;
   double force_send_at_ = 0;
 
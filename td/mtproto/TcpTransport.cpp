@@ -170,50 +170,71 @@ void ObfuscatedTransport::do_write_main(BufferWriter &&message) {
   do_write(builder.extract());
 }
 
+static constexpr size_t TLS_RECORD_HEADER_SIZE = 5;
+
+static void store_tls_record_header(MutableSlice dest, size_t record_size) {
+  CHECK(dest.size() == TLS_RECORD_HEADER_SIZE);
+  dest.copy_from(Slice("\x17\x03\x03\x00\x00", TLS_RECORD_HEADER_SIZE));
+  dest[3] = static_cast<char>((record_size >> 8) & 0xff);
+  dest[4] = static_cast<char>(record_size & 0xff);
+}
+
 void ObfuscatedTransport::do_write_tls(BufferWriter &&message) {
   CHECK(header_.size() <= MAX_TLS_PACKET_LENGTH);
-  if (message.size() + header_.size() > MAX_TLS_PACKET_LENGTH) {
-    auto buffer_slice = message.as_buffer_slice();
-    auto slice = buffer_slice.as_slice();
-    while (!slice.empty()) {
-      auto buf = buffer_slice.from_slice(slice.substr(0, MAX_TLS_PACKET_LENGTH - header_.size()));
-      slice.remove_prefix(buf.size());
-      BufferBuilder builder;
-      builder.append(std::move(buf));
-      do_write_tls(std::move(builder));
-    }
-    return;
-  }
+  const size_t max_record_size = MAX_TLS_PACKET_LENGTH;
+  size_t first_record_size = td::min(message.size() + header_.size(), max_record_size);
+  size_t left_size = message.size() + header_.size() - first_record_size;
 
+  // the first record is prepared in place in the prepend space of the message
   BufferBuilder builder(std::move(message));
-  do_write_tls(std::move(builder));
-}
-
-void ObfuscatedTransport::do_write_tls(BufferBuilder &&builder) {
   if (!header_.empty()) {
     builder.prepend(header_);
     header_ = {};
   }
-
-  size_t size = builder.size();
-  CHECK(size <= MAX_TLS_PACKET_LENGTH);
-
-  char buf[] = "\x17\x03\x03\x00\x00";
-  buf[3] = static_cast<char>((size >> 8) & 0xff);
-  buf[4] = static_cast<char>(size & 0xff);
-  builder.prepend(Slice(buf, 5));
-
+  char record_header[TLS_RECORD_HEADER_SIZE];
+  store_tls_record_header(MutableSlice(record_header, TLS_RECORD_HEADER_SIZE), first_record_size);
+  builder.prepend(Slice(record_header, TLS_RECORD_HEADER_SIZE));
   if (is_first_tls_packet_) {
     is_first_tls_packet_ = false;
     Slice first_prefix("\x14\x03\x03\x00\x01\x01");
     builder.prepend(first_prefix);
   }
 
-  do_write(builder.extract());
+  auto buffer_slice = builder.extract();
+  if (left_size == 0) {
+    do_write(std::move(buffer_slice));
+    return;
+  }
+
+  // headers of the other records are stored in a separate buffer, and the records are sent directly
+  // from the message buffer, so big messages aren't copied
+  auto slice = buffer_slice.as_slice();
+  output_->append_without_copy(buffer_slice.from_slice(slice.substr(0, slice.size() - left_size)));
+  slice.remove_prefix(slice.size() - left_size);
+
+  auto record_count = (left_size + max_record_size - 1) / max_record_size;
+  BufferSlice record_headers(record_count * TLS_RECORD_HEADER_SIZE);
+  auto record_headers_slice = record_headers.as_mutable_slice();
+  while (!slice.empty()) {
+    auto record_size = td::min(slice.size(), max_record_size);
+    auto header = record_headers_slice.substr(0, TLS_RECORD_HEADER_SIZE);
+    record_headers_slice.remove_prefix(TLS_RECORD_HEADER_SIZE);
+    store_tls_record_header(header, record_size);
+    output_->append_without_copy(record_headers.from_slice(header));
+    output_->append_without_copy(buffer_slice.from_slice(slice.substr(0, record_size)));
+    slice.remove_prefix(record_size);
+  }
+  CHECK(record_headers_slice.empty());
 }
 
 void ObfuscatedTransport::do_write(BufferSlice &&message) {
-  output_->append(std::move(message));
+  // big messages are sent directly from their own buffer instead of being copied to the output buffer
+  static constexpr size_t MIN_NO_COPY_SIZE = 1 << 12;
+  if (message.size() >= MIN_NO_COPY_SIZE) {
+    output_->append_without_copy(std::move(message));
+  } else {
+    output_->append(std::move(message));
+  }
 }
 
 }  // namespace tcp
@@ -164,12 +164,13 @@ class ObfuscatedTransport final : public IStreamTransport {
   // TODO: use ByteFlow?
   // One problem is that BufferedFd owns output_buffer_
   // The other problem is that first 56 bytes must be sent unencrypted.
+  // Messages are encrypted in place and big messages are linked into output_ without copying,
+  // so they are sent by BufferedFd with writev directly from the buffers they were serialized to.
   UInt256 output_key_;
   AesCtrState output_state_;
   ChainBufferWriter *output_ = nullptr;
 
   void do_write_tls(BufferWriter &&message);
-  void do_write_tls(BufferBuilder &&builder);
   void do_write_main(BufferWriter &&message);
   void do_write(BufferSlice &&message);
 };
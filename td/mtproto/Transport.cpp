@@ -211,9 +211,27 @@ Status Transport::read_no_crypto(MutableSlice message, PacketInfo *packet_info,
   return Status::OK();
 }
 
+template <class HeaderT>
+static void calc_aes_key_and_iv(int X, const HeaderT &header, const AuthKey &auth_key, const PacketInfo &packet_info,
+                                UInt256 *aes_key, UInt256 *aes_iv) {
+  if (packet_info.version == 1) {
+    KDF(auth_key.key(), header.message_key, X, aes_key, aes_iv);
+  } else {
+    KDF2(auth_key.key(), header.message_key, X, aes_key, aes_iv);
+  }
+}
+
+template <class HeaderT>
+static MutableSlice get_encrypted_part(MutableSlice message, HeaderT *header) {
+  auto result = MutableSlice(header->encrypt_begin(), message.uend());
+  result.remove_suffix(result.size() & 15);
+  return result;
+}
+
 template <class HeaderT, class PrefixT>
 Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &auth_key, HeaderT **header_ptr,
-                                   PrefixT **prefix_ptr, MutableSlice *data, PacketInfo *packet_info) {
+                                   PrefixT **prefix_ptr, MutableSlice *data, PacketInfo *packet_info,
+                                   bool is_decrypted) {
   if (message.size() < sizeof(HeaderT)) {
     return Status::Error(PSLICE() << "Invalid MTProto message: too small [message.size() = " << message.size()
                                   << "] < [sizeof(HeaderT) = " << sizeof(HeaderT) << "]");
@@ -221,8 +239,7 @@ Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &a
   //FIXME: rewrite without reinterpret cast
   auto *header = reinterpret_cast<HeaderT *>(message.begin());
   *header_ptr = header;
-  auto to_decrypt = MutableSlice(header->encrypt_begin(), message.uend());
-  to_decrypt.remove_suffix(to_decrypt.size() & 15);
+  auto to_decrypt = get_encrypted_part(message, header);
 
   if (header->auth_key_id != auth_key.id()) {
     return Status::Error(PSLICE() << "Invalid MTProto message: auth_key_id mismatch [found = "
@@ -230,16 +247,13 @@ Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &a
                                   << "] [expected = " << format::as_hex(auth_key.id()) << "]");
   }
 
-  UInt256 aes_key;
-  UInt256 aes_iv;
-  if (packet_info->version == 1) {
-    KDF(auth_key.key(), header->message_key, X, &aes_key, &aes_iv);
-  } else {
-    KDF2(auth_key.key(), header->message_key, X, &aes_key, &aes_iv);
+  if (!is_decrypted) {
+    UInt256 aes_key;
+    UInt256 aes_iv;
+    calc_aes_key_and_iv(X, *header, auth_key, *packet_info, &aes_key, &aes_iv);
+    aes_ige_decrypt(as_slice(aes_key), as_mutable_slice(aes_iv), to_decrypt, to_decrypt);
   }
 
-  aes_ige_decrypt(as_slice(aes_key), as_mutable_slice(aes_iv), to_decrypt, to_decrypt);
-
   size_t tail_size = message.end() - reinterpret_cast<char *>(header->data);
   if (tail_size < sizeof(PrefixT)) {
     return Status::Error("Too small encrypted part");
@@ -300,10 +314,10 @@ Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &a
 }
 
 Status Transport::read_crypto(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info,
-                              MutableSlice *data) {
+                              MutableSlice *data, bool is_decrypted) {
   CryptoHeader *header = nullptr;
   CryptoPrefix *prefix = nullptr;
-  TRY_STATUS(read_crypto_impl(8, message, auth_key, &header, &prefix, data, packet_info));
+  TRY_STATUS(read_crypto_impl(8, message, auth_key, &header, &prefix, data, packet_info, is_decrypted));
   CHECK(header != nullptr);
   CHECK(prefix != nullptr);
   CHECK(packet_info != nullptr);
@@ -319,7 +333,7 @@ Status Transport::read_e2e_crypto(MutableSlice message, const AuthKey &auth_key,
   EndToEndHeader *header = nullptr;
   EndToEndPrefix *prefix = nullptr;
   TRY_STATUS(read_crypto_impl(packet_info->is_creator && packet_info->version != 1 ? 8 : 0, message, auth_key, &header,
-                              &prefix, data, packet_info));
+                              &prefix, data, packet_info, false));
   CHECK(header != nullptr);
   CHECK(prefix != nullptr);
   CHECK(packet_info != nullptr);
@@ -416,6 +430,48 @@ Result<uint64> Transport::read_auth_key_id(Slice message) {
 }
 
 Result<Transport::ReadResult> Transport::read(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info) {
+  return read_impl(message, auth_key, packet_info, false);
+}
+
+vector<Result<Transport::ReadResult>> Transport::read_batch(Span<MutableSlice> messages, const AuthKey &auth_key,
+                                                            MutableSpan<PacketInfo> packet_infos) {
+  CHECK(messages.size() == packet_infos.size());
+  auto message_count = messages.size();
+
+  // find messages, which will be decrypted by read_crypto, and decrypt them together
+  vector<bool> is_decrypted(message_count, false);
+  vector<UInt256> aes_keys(message_count);
+  vector<UInt256> aes_ivs(message_count);
+  vector<AesIgeBatchItem> items;
+  for (size_t i = 0; i < message_count; i++) {
+    auto message = messages[i];
+    const auto &packet_info = packet_infos[i];
+    if (message.size() < sizeof(CryptoHeader) || packet_info.type == PacketInfo::EndToEnd || auth_key.empty()) {
+      continue;
+    }
+    //FIXME: rewrite without reinterpret cast
+    auto *header = reinterpret_cast<CryptoHeader *>(message.begin());
+    if (header->auth_key_id == 0 || header->auth_key_id != auth_key.id()) {
+      continue;
+    }
+
+    calc_aes_key_and_iv(8, *header, auth_key, packet_info, &aes_keys[i], &aes_ivs[i]);
+    auto to_decrypt = get_encrypted_part(message, header);
+    items.push_back({as_slice(aes_keys[i]), as_mutable_slice(aes_ivs[i]), to_decrypt, to_decrypt});
+    is_decrypted[i] = true;
+  }
+  aes_ige_decrypt_batch(items);
+
+  vector<Result<ReadResult>> results;
+  results.reserve(message_count);
+  for (size_t i = 0; i < message_count; i++) {
+    results.push_back(read_impl(messages[i], auth_key, &packet_infos[i], is_decrypted[i]));
+  }
+  return results;
+}
+
+Result<Transport::ReadResult> Transport::read_impl(MutableSlice message, const AuthKey &auth_key,
+                                                   PacketInfo *packet_info, bool is_decrypted) {
   if (message.size() < 16) {
     if (message.size() < 4) {
       return Status::Error(PSLICE() << "Invalid MTProto message: smaller than 4 bytes [size = " << message.size()
@@ -442,7 +498,7 @@ Result<Transport::ReadResult> Transport::read(MutableSlice message, const AuthKe
     if (auth_key.empty()) {
       return Status::Error("Failed to decrypt MTProto message: auth key is empty");
     }
-    TRY_STATUS(read_crypto(message, auth_key, packet_info, &data));
+    TRY_STATUS(read_crypto(message, auth_key, packet_info, &data, is_decrypted));
   }
   return ReadResult::make_packet(data);
 }
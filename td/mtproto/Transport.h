@@ -12,6 +12,7 @@
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
 #include "td/utils/Slice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 #include "td/utils/StorerBase.h"
 #include "td/utils/UInt.h"
@@ -90,6 +91,10 @@ class Transport {
   static Result<ReadResult> read(MutableSlice message, const AuthKey &auth_key,
                                  PacketInfo *packet_info) TD_WARN_UNUSED_RESULT;
 
+  // Same as read for each message, but AES decryption of all messages is done at once, which is faster.
+  static vector<Result<ReadResult>> read_batch(Span<MutableSlice> messages, const AuthKey &auth_key,
+                                               MutableSpan<PacketInfo> packet_infos);
+
   static BufferWriter write(const Storer &storer, const AuthKey &auth_key, PacketInfo *packet_info,
                             size_t prepend_size = 0, size_t append_size = 0);
 
@@ -108,18 +113,21 @@ class Transport {
 
   static size_t calc_no_crypto_size(size_t data_size);
 
+  static Result<ReadResult> read_impl(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info,
+                                      bool is_decrypted) TD_WARN_UNUSED_RESULT;
+
   static Status read_no_crypto(MutableSlice message, PacketInfo *packet_info, MutableSlice *data) TD_WARN_UNUSED_RESULT;
 
-  static Status read_crypto(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info,
-                            MutableSlice *data) TD_WARN_UNUSED_RESULT;
+  static Status read_crypto(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info, MutableSlice *data,
+                            bool is_decrypted) TD_WARN_UNUSED_RESULT;
 
   static Status read_e2e_crypto(MutableSlice message, const AuthKey &auth_key, PacketInfo *packet_info,
                                 MutableSlice *data) TD_WARN_UNUSED_RESULT;
 
   template <class HeaderT, class PrefixT>
   static Status read_crypto_impl(int X, MutableSlice message, const AuthKey &auth_key, HeaderT **header_ptr,
-                                 PrefixT **prefix_ptr, MutableSlice *data,
-                                 PacketInfo *packet_info) TD_WARN_UNUSED_RESULT;
+                                 PrefixT **prefix_ptr, MutableSlice *data, PacketInfo *packet_info,
+                                 bool is_decrypted) TD_WARN_UNUSED_RESULT;
 
   static BufferWriter write_no_crypto(const Storer &storer, PacketInfo *packet_info, size_t prepend_size,
                                       size_t append_size);
@@ -60,7 +60,9 @@
 #include "td/actor/SleepActor.h"
 
 #include "td/utils/algorithm.h"
+#include "td/utils/as.h"
 #include "td/utils/buffer.h"
+#include "td/utils/crypto.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -70,6 +72,7 @@
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
+#include "td/utils/tl_parsers.h"
 #include "td/utils/utf8.h"
 
 #include <limits>
@@ -5176,6 +5179,7 @@ void ChatManager::update_chat(Chat *c, ChatId chat_id, bool from_binlog, bool fr
   SCOPE_EXIT {
     c->is_being_updated = false;
   };
+  c->received_data_hash = 0;
 
   bool need_update_chat_full = false;
   if (c->is_photo_changed) {
@@ -5276,6 +5280,7 @@ void ChatManager::update_channel(Channel *c, ChannelId channel_id, bool from_bin
   SCOPE_EXIT {
     c->is_being_updated = false;
   };
+  c->received_data_hash = 0;
 
   bool need_update_channel_full = false;
   if (c->is_photo_changed) {
@@ -5661,6 +5666,68 @@ void ChatManager::on_get_chats(vector<tl_object_ptr<telegram_api::Chat>> &&chats
   }
 }
 
+void ChatManager::on_get_lazy_chats(TlLazyVector<telegram_api::Chat> &&chats, const char *source) {
+  auto is_channel = [&chats](size_t pos) {
+    int32 constructor_id = as<int32>(chats.get_raw(pos).data());
+    return constructor_id == telegram_api::channel::ID || constructor_id == telegram_api::channelForbidden::ID;
+  };
+  for (size_t i = 0; i < chats.size(); i++) {
+    if (is_channel(i)) {
+      // apply info about megagroups before corresponding chats
+      on_get_lazy_chat(chats, i, source);
+    }
+  }
+  for (size_t i = 0; i < chats.size(); i++) {
+    if (!is_channel(i)) {
+      on_get_lazy_chat(chats, i, source);
+    }
+  }
+}
+
+void ChatManager::on_get_lazy_chat(const TlLazyVector<telegram_api::Chat> &chats, size_t pos, const char *source) {
+  auto data = chats.get_raw_buffer(pos);
+  auto data_hash = crc64(data.as_slice());
+  auto received_data_hash = get_received_chat_data_hash(data);
+  if (received_data_hash != nullptr && *received_data_hash == data_hash) {
+    // the same chat has already been applied and hasn't changed since
+    return;
+  }
+
+  auto chat = chats.get(pos);
+  if (chat == nullptr) {
+    LOG(ERROR) << "Failed to parse a chat from " << source;
+    return;
+  }
+  on_get_chat(std::move(chat), source);
+
+  received_data_hash = get_received_chat_data_hash(data);
+  if (received_data_hash != nullptr) {
+    *received_data_hash = data_hash;
+  }
+}
+
+uint64 *ChatManager::get_received_chat_data_hash(const BufferSlice &data) {
+  TlBufferParser parser(&data);
+  auto constructor_id = parser.fetch_int();
+  if (constructor_id == telegram_api::chat::ID) {
+    ChatId chat_id(telegram_api::chat::fetch_id(parser));
+    if (parser.get_error() != nullptr || !chat_id.is_valid()) {
+      return nullptr;
+    }
+    Chat *c = get_chat(chat_id);
+    return c == nullptr ? nullptr : &c->received_data_hash;
+  }
+  if (constructor_id == telegram_api::channel::ID) {
+    ChannelId channel_id(telegram_api::channel::fetch_id(parser));
+    if (parser.get_error() != nullptr || !channel_id.is_valid()) {
+      return nullptr;
+    }
+    Channel *c = get_channel(channel_id);
+    return c == nullptr ? nullptr : &c->received_data_hash;
+  }
+  return nullptr;
+}
+
 void ChatManager::on_get_chat_full(tl_object_ptr<telegram_api::ChatFull> &&chat_full_ptr, Promise<Unit> &&promise) {
   LOG(INFO) << "Receive " << to_string(chat_full_ptr);
   if (chat_full_ptr->get_id() == telegram_api::chatFull::ID) {
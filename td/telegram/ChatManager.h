@@ -44,6 +44,7 @@
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/Promise.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
@@ -141,6 +142,8 @@ class ChatManager final : public Actor {
   void on_get_chat(tl_object_ptr<telegram_api::Chat> &&chat, const char *source);
   void on_get_chats(vector<tl_object_ptr<telegram_api::Chat>> &&chats, const char *source);
 
+  void on_get_lazy_chats(TlLazyVector<telegram_api::Chat> &&chats, const char *source);
+
   void on_get_chat_full(tl_object_ptr<telegram_api::ChatFull> &&chat_full, Promise<Unit> &&promise);
   void on_get_chat_full_failed(ChatId chat_id);
   void on_get_channel_full_failed(ChannelId channel_id);
@@ -448,6 +451,8 @@ class ChatManager final : public Actor {
 
     bool is_received_from_server = false;  // true, if the chat was received from the server and not the database
 
+    uint64 received_data_hash = 0;  // hash of the last applied telegram_api::chat if it hasn't changed since
+
     uint64 log_event_id = 0;
 
     template <class StorerT>
@@ -567,6 +572,8 @@ class ChatManager final : public Actor {
 
     bool is_received_from_server = false;  // true, if the channel was received from the server and not the database
 
+    uint64 received_data_hash = 0;  // hash of the last applied telegram_api::channel if it hasn't changed since
+
     uint64 log_event_id = 0;
 
     template <class StorerT>
@@ -797,6 +804,10 @@ class ChatManager final : public Actor {
 
   void update_chat_online_member_count(const ChatFull *chat_full, ChatId chat_id, bool is_from_server);
 
+  void on_get_lazy_chat(const TlLazyVector<telegram_api::Chat> &chats, size_t pos, const char *source);
+
+  uint64 *get_received_chat_data_hash(const BufferSlice &data);
+
   void on_get_chat_empty(telegram_api::chatEmpty &chat, const char *source);
   void on_get_chat(telegram_api::chat &chat, const char *source);
   void on_get_chat_forbidden(telegram_api::chatForbidden &chat, const char *source);
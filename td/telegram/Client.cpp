@@ -6,6 +6,7 @@
 //
 #include "td/telegram/Client.h"
 
+#include "td/telegram/Global.h"
 #include "td/telegram/Td.h"
 #include "td/telegram/TdCallback.h"
 
@@ -22,6 +23,7 @@
 #include "td/utils/misc.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/port/RwMutex.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
@@ -37,6 +39,8 @@
 
 namespace td {
 
+static std::atomic<bool> use_message_database_readers;
+
 #if TD_THREAD_UNSUPPORTED || TD_EVENTFD_UNSUPPORTED
 class TdReceiver {
  public:
@@ -107,7 +111,23 @@ class ClientManager::Impl final {
     requests_.push_back({client_id, request_id, std::move(request)});
   }
 
-  Response receive(double timeout) {
+  void set_receiver_count(int32 receiver_count, bool keep_client_order) {
+    // all updates and responses are received in the thread, which runs the clients
+  }
+
+  vector<Response> receive_many(double timeout, size_t max_count, int32 receiver_id) {
+    vector<Response> responses;
+    while (responses.size() < max_count) {
+      auto response = receive(responses.empty() ? timeout : 0.0, receiver_id);
+      if (response.object == nullptr) {
+        break;
+      }
+      responses.push_back(std::move(response));
+    }
+    return responses;
+  }
+
+  Response receive(double timeout, int32 receiver_id) {
     if (!requests_.empty()) {
       for (size_t i = 0; i < requests_.size(); i++) {
         auto &request = requests_[i];
@@ -188,7 +208,7 @@ class ClientManager::Impl final {
       }
     }
     while (!tds_.empty() && !ExitGuard::is_exited()) {
-      receive(0.1);
+      receive(0.1, 0);
     }
     if (concurrent_scheduler_ != nullptr) {
       concurrent_scheduler_->finish();
@@ -220,7 +240,7 @@ class Client::Impl final {
   }
 
   Response receive(double timeout) {
-    auto response = impl_.receive(timeout);
+    auto response = impl_.receive(timeout, 0);
 
     Response old_response;
     old_response.id = response.request_id;
@@ -272,29 +292,58 @@ class MultiTd final : public Actor {
 class TdReceiver {
  public:
   TdReceiver() {
-    output_queue_ = std::make_shared<OutputQueue>();
-    output_queue_->init();
+    init_receivers(1, true);
   }
 
-  ClientManager::Response receive(double timeout, bool from_manager) {
+  // responses for a client are always added to the queue of the receiver client_id % receiver_count
+  // the number of receivers can't be changed after the first receive; returns false in that case
+  bool set_receiver_count(int32 receiver_count, bool keep_client_order) {
+    CHECK(receiver_count > 0);
+    auto state = ReceiversState::Initial;
+    if (!receivers_state_.compare_exchange_strong(state, ReceiversState::Changing)) {
+      return false;
+    }
+    init_receivers(receiver_count, keep_client_order);
+    receivers_state_.store(ReceiversState::Initial);
+    return true;
+  }
+
+  int32 get_receiver_count() const {
+    return static_cast<int32>(receivers_.size());
+  }
+
+  ClientManager::Response receive(double timeout, bool from_manager, int32 receiver_id = 0) {
     VLOG(td_requests) << "Begin to wait for updates with timeout " << timeout;
-    auto is_locked = receive_lock_.exchange(true);
-    if (is_locked) {
-      if (from_manager) {
-        LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
-                      "happened. Call it from a fixed thread, dedicated for updates and response processing.";
-      } else {
-        LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
-      }
+    auto &receiver = lock_receiver(receiver_id, from_manager);
+    auto response = receive_available(receiver, receiver_id);
+    if (is_empty(response)) {
+      response = receive_unlocked(receiver, clamp(timeout, 0.0, 1000000.0));
     }
-    auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
-    is_locked = receive_lock_.exchange(false);
-    CHECK(is_locked);
+    unlock_receiver(receiver);
     VLOG(td_requests) << "End to wait for updates, returning object " << response.request_id << ' '
                       << response.object.get();
     return response;
   }
 
+  vector<ClientManager::Response> receive_many(double timeout, size_t max_count, int32 receiver_id) {
+    VLOG(td_requests) << "Begin to wait for at most " << max_count << " updates with timeout " << timeout;
+    vector<ClientManager::Response> responses;
+    auto &receiver = lock_receiver(receiver_id, true);
+    while (responses.size() < max_count) {
+      auto response = receive_available(receiver, receiver_id);
+      if (is_empty(response) && responses.empty()) {
+        response = receive_unlocked(receiver, clamp(timeout, 0.0, 1000000.0));
+      }
+      if (is_empty(response)) {
+        break;
+      }
+      responses.push_back(std::move(response));
+    }
+    unlock_receiver(receiver);
+    VLOG(td_requests) << "End to wait for updates, returning " << responses.size() << " objects";
+    return responses;
+  }
+
   unique_ptr<TdCallback> create_callback(ClientManager::ClientId client_id) {
     class Callback final : public TdCallback {
      public:
@@ -319,30 +368,127 @@ class TdReceiver {
       ClientManager::ClientId client_id_;
       std::shared_ptr<OutputQueue> output_queue_;
     };
-    return td::make_unique<Callback>(client_id, output_queue_);
+    return td::make_unique<Callback>(client_id, get_output_queue(client_id));
   }
 
   void add_response(ClientManager::ClientId client_id, uint64 id, td_api::object_ptr<td_api::Object> result) {
-    output_queue_->writer_put({client_id, id, std::move(result)});
+    get_output_queue(client_id)->writer_put({client_id, id, std::move(result)});
   }
 
  private:
   using OutputQueue = MpscPollableQueue<ClientManager::Response>;
-  std::shared_ptr<OutputQueue> output_queue_;
-  int output_queue_ready_cnt_{0};
-  std::atomic<bool> receive_lock_{false};
+  enum class LockState : int32 { Free, Owner, Thief };
+  struct Receiver {
+    std::shared_ptr<OutputQueue> output_queue;
+    int output_queue_ready_cnt{0};
+    std::atomic<LockState> receive_lock{LockState::Free};
+  };
+  vector<unique_ptr<Receiver>> receivers_;
+  bool keep_client_order_ = true;
+
+  // receivers are never changed after they were used for the first time
+  enum class ReceiversState : int32 { Initial, Changing, Used };
+  std::atomic<ReceiversState> receivers_state_{ReceiversState::Initial};
+
+  void init_receivers(int32 receiver_count, bool keep_client_order) {
+    receivers_.clear();
+    for (int32 i = 0; i < receiver_count; i++) {
+      auto receiver = make_unique<Receiver>();
+      receiver->output_queue = std::make_shared<OutputQueue>();
+      receiver->output_queue->init();
+      receivers_.push_back(std::move(receiver));
+    }
+    keep_client_order_ = keep_client_order;
+  }
+
+  void freeze_receivers() {
+    auto state = ReceiversState::Initial;
+    while (!receivers_state_.compare_exchange_strong(state, ReceiversState::Used)) {
+      if (state == ReceiversState::Used) {
+        return;
+      }
+      // the number of receivers is being changed right now
+      CHECK(state == ReceiversState::Changing);
+      state = ReceiversState::Initial;
+      usleep_for(1);
+    }
+  }
+
+  const std::shared_ptr<OutputQueue> &get_output_queue(ClientManager::ClientId client_id) const {
+    auto receiver_count = static_cast<uint32>(receivers_.size());
+    return receivers_[static_cast<uint32>(client_id) % receiver_count]->output_queue;
+  }
+
+  static bool is_empty(const ClientManager::Response &response) {
+    return response.client_id == 0 && response.object == nullptr;
+  }
+
+  Receiver &lock_receiver(int32 receiver_id, bool from_manager) {
+    freeze_receivers();
+    if (receiver_id < 0 || receiver_id >= get_receiver_count()) {
+      LOG(FATAL) << "Receive is called with invalid receiver " << receiver_id;
+    }
+    auto &receiver = *receivers_[receiver_id];
+    auto lock_state = LockState::Free;
+    while (!receiver.receive_lock.compare_exchange_strong(lock_state, LockState::Owner)) {
+      if (lock_state == LockState::Owner) {
+        if (from_manager) {
+          LOG(FATAL) << "Receive must not be called simultaneously from two different threads for the same receiver, "
+                        "but this has just happened. Call it from a fixed thread, dedicated for updates and response "
+                        "processing.";
+        } else {
+          LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
+        }
+      }
+      // another receiver is taking a response from the queue; it will release the queue soon
+      CHECK(lock_state == LockState::Thief);
+      lock_state = LockState::Free;
+      usleep_for(1);
+    }
+    return receiver;
+  }
+
+  static void unlock_receiver(Receiver &receiver) {
+    auto lock_state = receiver.receive_lock.exchange(LockState::Free);
+    CHECK(lock_state == LockState::Owner);
+  }
 
-  ClientManager::Response receive_unlocked(double timeout) {
-    if (output_queue_ready_cnt_ == 0) {
-      output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
+  ClientManager::Response receive_available(Receiver &receiver, int32 receiver_id) {
+    auto response = receive_unlocked(receiver, 0.0);
+    if (is_empty(response) && !keep_client_order_) {
+      response = steal_response(receiver_id);
     }
-    if (output_queue_ready_cnt_ > 0) {
-      output_queue_ready_cnt_--;
-      return output_queue_->reader_get_unsafe();
+    return response;
+  }
+
+  ClientManager::Response steal_response(int32 receiver_id) {
+    auto receiver_count = get_receiver_count();
+    for (int32 i = 1; i < receiver_count; i++) {
+      auto &receiver = *receivers_[(receiver_id + i) % receiver_count];
+      auto lock_state = LockState::Free;
+      if (!receiver.receive_lock.compare_exchange_strong(lock_state, LockState::Thief)) {
+        continue;
+      }
+      auto response = receive_unlocked(receiver, 0.0);
+      receiver.receive_lock.store(LockState::Free);
+      if (!is_empty(response)) {
+        return response;
+      }
+    }
+    return {0, 0, nullptr};
+  }
+
+  static ClientManager::Response receive_unlocked(Receiver &receiver, double timeout) {
+    if (receiver.output_queue_ready_cnt == 0) {
+      receiver.output_queue_ready_cnt = receiver.output_queue->reader_wait_nonblock();
+    }
+    if (receiver.output_queue_ready_cnt > 0) {
+      receiver.output_queue_ready_cnt--;
+      return receiver.output_queue->reader_get_unsafe();
     }
     if (timeout != 0) {
-      output_queue_->reader_get_event_fd().wait(static_cast<int>(timeout * 1000));
-      return receive_unlocked(0);
+      receiver.output_queue->reader_get_event_fd().wait(static_cast<int>(timeout * 1000));
+      return receive_unlocked(receiver, 0);
     }
     return {0, 0, nullptr};
   }
@@ -352,8 +498,9 @@ class MultiImpl {
  public:
   static constexpr int32 ADDITIONAL_THREAD_COUNT = 3;
 
-  explicit MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats) {
-    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(ADDITIONAL_THREAD_COUNT, 0);
+  MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats, int32 database_reader_thread_count) {
+    concurrent_scheduler_ =
+        std::make_shared<ConcurrentScheduler>(ADDITIONAL_THREAD_COUNT + database_reader_thread_count, 0);
     concurrent_scheduler_->start();
 
     {
@@ -436,8 +583,15 @@ class MultiImplPool {
 #if TD_OPENBSD
       max_client_threads = td::min(max_client_threads, 4u);
 #endif
+      database_reader_thread_count_ = use_message_database_readers ? Global::DATABASE_READER_SCHEDULER_COUNT : 0;
+      auto thread_count = static_cast<uint32>(1 + MultiImpl::ADDITIONAL_THREAD_COUNT + database_reader_thread_count_ +
+                                              1 /* IOCP */);
+      if (database_reader_thread_count_ > 0) {
+        // identifiers of all threads must be less than 128
+        max_client_threads = td::min(max_client_threads, 127u / thread_count);
+      }
       impls_.resize(max_client_threads);
-      CHECK(impls_.size() * (1 + MultiImpl::ADDITIONAL_THREAD_COUNT + 1 /* IOCP */) < 128);
+      CHECK(impls_.size() * thread_count < 128);
 
       net_query_stats_ = std::make_shared<NetQueryStats>();
     }
@@ -445,7 +599,7 @@ class MultiImplPool {
                                    [](auto &a, auto &b) { return a.lock().use_count() < b.lock().use_count(); });
     auto result = impl.lock();
     if (!result) {
-      result = std::make_shared<MultiImpl>(net_query_stats_);
+      result = std::make_shared<MultiImpl>(net_query_stats_, database_reader_thread_count_);
       impl = result;
     }
     return result;
@@ -473,6 +627,7 @@ class MultiImplPool {
   std::mutex mutex_;
   std::vector<std::weak_ptr<MultiImpl>> impls_;
   std::shared_ptr<NetQueryStats> net_query_stats_;
+  int32 database_reader_thread_count_ = 0;
 };
 
 class ClientManager::Impl final {
@@ -517,8 +672,37 @@ class ClientManager::Impl final {
     it->second.impl->send(client_id, request_id, std::move(request));
   }
 
-  Response receive(double timeout) {
-    auto response = receiver_.receive(timeout, true);
+  void set_receiver_count(int32 receiver_count, bool keep_client_order) {
+    if (receiver_count <= 0 || receiver_count > MAX_RECEIVER_COUNT) {
+      LOG(ERROR) << "Ignore invalid number of receivers specified: " << receiver_count;
+      return;
+    }
+    auto lock = impls_mutex_.lock_write();
+    if (!impls_.empty()) {
+      LOG(ERROR) << "Ignore change of the number of receivers after the first client was created";
+      return;
+    }
+    if (!receiver_.set_receiver_count(receiver_count, keep_client_order)) {
+      LOG(ERROR) << "Ignore change of the number of receivers after the first receive";
+    }
+  }
+
+  Response receive(double timeout, int32 receiver_id) {
+    auto response = receiver_.receive(timeout, true, receiver_id);
+    process_response(response);
+    return response;
+  }
+
+  vector<Response> receive_many(double timeout, size_t max_count, int32 receiver_id) {
+    auto responses = receiver_.receive_many(timeout, max_count, receiver_id);
+    for (auto &response : responses) {
+      process_response(response);
+    }
+    td::remove_if(responses, [](const Response &response) { return response.object == nullptr; });
+    return responses;
+  }
+
+  void process_response(Response &response) {
     if (response.request_id == 0 && response.object != nullptr &&
         response.object->get_id() == td_api::updateAuthorizationState::ID &&
         static_cast<const td_api::updateAuthorizationState *>(response.object.get())->authorization_state_->get_id() ==
@@ -545,7 +729,6 @@ class ClientManager::Impl final {
         pool_.try_clear();
       }
     }
-    return response;
   }
 
   void close_impl(ClientId client_id) {
@@ -574,12 +757,16 @@ class ClientManager::Impl final {
     for (auto &it : impls_) {
       close_impl(it.first);
     }
+    int32 receiver_id = 0;
     while (!impls_.empty() && !ExitGuard::is_exited()) {
-      receive(0.1);
+      receive(0.1, receiver_id);
+      receiver_id = (receiver_id + 1) % receiver_.get_receiver_count();
     }
   }
 
  private:
+  static constexpr int32 MAX_RECEIVER_COUNT = 1024;
+
   MultiImplPool pool_;
   RwMutex impls_mutex_;
   struct MultiImplInfo {
@@ -674,8 +861,25 @@ void ClientManager::send(ClientId client_id, RequestId request_id, td_api::objec
   impl_->send(client_id, request_id, std::move(request));
 }
 
+void ClientManager::set_receiver_count(std::int32_t receiver_count, bool keep_client_order) {
+  impl_->set_receiver_count(receiver_count, keep_client_order);
+}
+
 ClientManager::Response ClientManager::receive(double timeout) {
-  return impl_->receive(timeout);
+  return impl_->receive(timeout, 0);
+}
+
+ClientManager::Response ClientManager::receive(double timeout, std::int32_t receiver_id) {
+  return impl_->receive(timeout, receiver_id);
+}
+
+std::vector<ClientManager::Response> ClientManager::receive_many(double timeout, std::size_t max_count) {
+  return impl_->receive_many(timeout, max_count, 0);
+}
+
+std::vector<ClientManager::Response> ClientManager::receive_many(double timeout, std::size_t max_count,
+                                                                 std::int32_t receiver_id) {
+  return impl_->receive_many(timeout, max_count, receiver_id);
 }
 
 td_api::object_ptr<td_api::Object> ClientManager::execute(td_api::object_ptr<td_api::Function> &&request) {
@@ -712,6 +916,10 @@ void ClientManager::set_log_message_callback(int max_verbosity_level, LogMessage
   }
 }
 
+void ClientManager::set_use_message_database_readers(bool is_enabled) {
+  use_message_database_readers = is_enabled;
+}
+
 ClientManager::ClientManager(ClientManager &&) noexcept = default;
 ClientManager &ClientManager::operator=(ClientManager &&) noexcept = default;
 ClientManager::~ClientManager() = default;
@@ -11,8 +11,10 @@
 #include "td/telegram/td_api.h"
 #include "td/telegram/td_api.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace td {
 
@@ -23,8 +25,9 @@ namespace td {
  * Requests can be sent using the method ClientManager::send from any thread.
  * New updates and responses to requests can be received using the method ClientManager::receive from any thread after
  * the first request has been sent to the client instance. ClientManager::receive must not be called simultaneously from
- * two different threads. Also, note that all updates and responses to requests should be applied in the same order as
- * they were received, to ensure consistency.
+ * two different threads, unless several receivers were enabled using the method ClientManager::set_receiver_count.
+ * Also, note that all updates and responses to requests should be applied in the same order as they were received,
+ * to ensure consistency.
  * Some TDLib requests can be executed synchronously from any thread using the method ClientManager::execute.
  *
  * General pattern of usage:
@@ -115,6 +118,51 @@ class ClientManager final {
    */
   Response receive(double timeout);
 
+  /**
+   * Allows to receive updates and responses to requests simultaneously from several threads. Must be called before
+   * the first TDLib client instance is created and before the first call to receive; otherwise, the call is ignored.
+   * Updates and responses for a client instance are queued for the receiver with identifier client_id % receiver_count.
+   * \param[in] receiver_count The number of receivers; 1-1024.
+   * \param[in] keep_client_order Pass true to receive all updates and responses for a client instance by the same
+   *                              receiver in the order they were sent. Otherwise, a receiver without own updates
+   *                              will receive updates and responses queued for other receivers.
+   */
+  void set_receiver_count(std::int32_t receiver_count, bool keep_client_order);
+
+  /**
+   * Receives incoming updates and responses to requests from TDLib for the specified receiver. May be called from any
+   * thread, but must not be called simultaneously from two different threads for the same receiver.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \param[in] receiver_id Identifier of the receiver; 0 <= receiver_id < receiver_count.
+   *                        The method receive(timeout) is equivalent to receive(timeout, 0).
+   * \return An incoming update or response to a request. The object returned in the response may be a nullptr
+   *         if the timeout expires.
+   */
+  Response receive(double timeout, std::int32_t receiver_id);
+
+  /**
+   * Receives several incoming updates and responses to requests from TDLib at once. Waits for new data only if there
+   * are no updates and responses to return. May be called from any thread, but must not be called simultaneously from
+   * two different threads.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \param[in] max_count The maximum number of updates and responses to return.
+   * \return Incoming updates and responses to requests in the order they were received. The returned vector is empty
+   *         if the timeout expires.
+   */
+  std::vector<Response> receive_many(double timeout, std::size_t max_count);
+
+  /**
+   * Receives several incoming updates and responses to requests from TDLib for the specified receiver at once.
+   * May be called from any thread, but must not be called simultaneously from two different threads for the same
+   * receiver.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \param[in] max_count The maximum number of updates and responses to return.
+   * \param[in] receiver_id Identifier of the receiver; 0 <= receiver_id < receiver_count.
+   * \return Incoming updates and responses to requests in the order they were received. The returned vector is empty
+   *         if the timeout expires.
+   */
+  std::vector<Response> receive_many(double timeout, std::size_t max_count, std::int32_t receiver_id);
+
   /**
    * Synchronously executes a TDLib request.
    * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -144,6 +192,17 @@ class ClientManager final {
    */
   static void set_log_message_callback(int max_verbosity_level, LogMessageCallbackPtr callback);
 
+  /**
+   * Enables or disables dedicated threads for read-only message database queries.
+   * If enabled, each internal TDLib thread pool starts additional threads, which serve read-only queries
+   * to the message database of clients with enabled use_message_database parameter.
+   * Read-only queries may then be answered before previously sent writes are applied.
+   * Takes effect only for clients created while no other client instances exist. By default the threads aren't used.
+   *
+   * \param[in] is_enabled Pass true to use dedicated threads for message database reads.
+   */
+  static void set_use_message_database_readers(bool is_enabled);
+
   /**
    * Destroys the client manager and all TDLib client instances managed by it.
    */
@@ -13,10 +13,11 @@
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/JsonBuilder.h"
 #include "td/utils/port/thread_local.h"
+#include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
-#include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
 
+#include <cstring>
 #include <utility>
 
 namespace td {
@@ -53,11 +54,8 @@ static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice
   return std::make_pair(std::move(func), std::move(extra));
 }
 
-static string from_response(const td_api::Object &object, const string &extra, int client_id) {
-  auto buf = StackAllocator::alloc(1 << 18);
-  JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
-  jb.enter_value() << ToJson(object);
-  auto &sb = jb.string_builder();
+static void store_response(StringBuilder &sb, const td_api::Object &object, const string &extra, int client_id) {
+  td_api::store_json(sb, object);
   auto slice = sb.as_cslice();
   CHECK(!slice.empty() && slice.back() == '}');
   sb.pop_back();
@@ -68,15 +66,36 @@ static string from_response(const td_api::Object &object, const string &extra, i
     sb << ",\"@client_id\":" << client_id;
   }
   sb << '}';
-  return sb.as_cslice().str();
 }
 
 static TD_THREAD_LOCAL string *current_output;
 
-static const char *store_string(string str) {
+// responses are serialized directly to the per-thread output buffer, which is reused between calls
+template <class F>
+static const char *store_output(F &&store) {
+  static constexpr size_t MIN_OUTPUT_BUFFER_SIZE = 1 << 12;
+  static constexpr size_t MAX_OUTPUT_BUFFER_SIZE = 1 << 22;
+
   init_thread_local<string>(current_output);
-  *current_output = std::move(str);
-  return current_output->c_str();
+  auto &output = *current_output;
+  if (output.size() < MIN_OUTPUT_BUFFER_SIZE || output.size() > MAX_OUTPUT_BUFFER_SIZE) {
+    output = string(MIN_OUTPUT_BUFFER_SIZE, '\0');
+  }
+
+  StringBuilder sb(MutableSlice(output), true);
+  store(sb);
+  auto result = sb.as_cslice();
+  if (result.begin() != output.data()) {
+    // the buffer was too small; copy the result and keep the enlarged buffer for subsequent calls
+    auto size = result.size();
+    output.resize(td::max(output.size() * 2, size + 1));
+    std::memcpy(&output[0], result.begin(), size + 1);
+  }
+  return output.c_str();
+}
+
+static const char *store_response(const td_api::Object &object, const string &extra, int client_id) {
+  return store_output([&](StringBuilder &sb) { store_response(sb, object, extra, client_id); });
 }
 
 void ClientJson::send(Slice request) {
@@ -104,13 +123,13 @@ const char *ClientJson::receive(double timeout) {
       extra_.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra, 0));
+  return store_response(*response.object, extra, 0);
 }
 
 const char *ClientJson::execute(Slice request) {
   auto parsed_request = to_request(request);
-  return store_string(from_response(*Client::execute(Client::Request{0, std::move(parsed_request.first)}).object,
-                                    parsed_request.second, 0));
+  return store_response(*Client::execute(Client::Request{0, std::move(parsed_request.first)}).object,
+                        parsed_request.second, 0);
 }
 
 static ClientManager *get_manager() {
@@ -150,13 +169,47 @@ const char *json_receive(double timeout) {
       extra.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra_str, response.client_id));
+  return store_response(*response.object, extra_str, response.client_id);
+}
+
+const char *json_receive_many(double timeout, int max_count) {
+  if (max_count <= 0) {
+    return nullptr;
+  }
+  auto responses = get_manager()->receive_many(timeout, static_cast<size_t>(max_count));
+  if (responses.empty()) {
+    return nullptr;
+  }
+
+  vector<string> extra_strs(responses.size());
+  {
+    std::lock_guard<std::mutex> guard(extra_mutex);
+    for (size_t i = 0; i < responses.size(); i++) {
+      if (responses[i].request_id != 0) {
+        auto it = extra.find(responses[i].request_id);
+        if (it != extra.end()) {
+          extra_strs[i] = std::move(it->second);
+          extra.erase(it);
+        }
+      }
+    }
+  }
+
+  return store_output([&](StringBuilder &sb) {
+    sb << '[';
+    for (size_t i = 0; i < responses.size(); i++) {
+      if (i != 0) {
+        sb << ',';
+      }
+      store_response(sb, *responses[i].object, extra_strs[i], responses[i].client_id);
+    }
+    sb << ']';
+  });
 }
 
 const char *json_execute(Slice request) {
   auto parsed_request = to_request(request);
-  return store_string(
-      from_response(*ClientManager::execute(std::move(parsed_request.first)), parsed_request.second, 0));
+  return store_response(*ClientManager::execute(std::move(parsed_request.first)), parsed_request.second, 0);
 }
 
 }  // namespace td
@@ -40,6 +40,8 @@ void json_send(int client_id, Slice request);
 
 const char *json_receive(double timeout);
 
+const char *json_receive_many(double timeout, int max_count);
+
 const char *json_execute(Slice request);
 
 }  // namespace td
@@ -357,6 +357,9 @@ static ActorOwn<> get_full_config(DcOption option, Promise<tl_object_ptr<telegra
     void on_result(NetQueryPtr net_query) final {
       G()->net_query_dispatcher().dispatch(std::move(net_query));
     }
+    void on_load_updated(double rtt, double queue_delay) final {
+      // nop
+    }
 
    private:
     ActorShared<> parent_;
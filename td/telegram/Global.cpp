@@ -32,6 +32,13 @@ Global::Global() {
   database_scheduler_id_ = min(current_scheduler_id + 1, max_scheduler_id);
   gc_scheduler_id_ = min(current_scheduler_id + 2, max_scheduler_id);
   slow_net_scheduler_id_ = min(current_scheduler_id + 3, max_scheduler_id);
+  // database readers are created only on dedicated schedulers, because they can be blocked for a long time
+  for (int32 i = 0; i < DATABASE_READER_SCHEDULER_COUNT; i++) {
+    auto scheduler_id = current_scheduler_id + 4 + i;
+    if (scheduler_id <= max_scheduler_id) {
+      database_reader_scheduler_ids_.push_back(scheduler_id);
+    }
+  }
 }
 
 Global::~Global() = default;
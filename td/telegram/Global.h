@@ -626,6 +626,14 @@ class Global final : public ActorContext {
     return slow_net_scheduler_id_;
   }
 
+  static constexpr int32 DATABASE_READER_SCHEDULER_COUNT = 2;
+
+  // dedicated schedulers, which run read-only database queries in parallel with the database scheduler;
+  // they exist only if ClientManager::set_use_message_database_readers(true) was called
+  const vector<int32> &get_database_reader_scheduler_ids() const {
+    return database_reader_scheduler_ids_;
+  }
+
   DcId get_webfile_dc_id() const;
 
   std::shared_ptr<DhConfig> get_dh_config() {
@@ -780,6 +788,7 @@ class Global final : public ActorContext {
   int32 database_scheduler_id_ = 0;
   int32 gc_scheduler_id_ = 0;
   int32 slow_net_scheduler_id_ = 0;
+  vector<int32> database_reader_scheduler_ids_;
 
   std::atomic<bool> store_all_files_in_files_directory_{false};
 
@@ -7,18 +7,26 @@
 #include "td/telegram/MessageDb.h"
 
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MessageSearchIndex.h"
 #include "td/telegram/UserId.h"
 #include "td/telegram/Version.h"
 
+#include "td/db/BlobCodec.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/WriteBatchPolicy.h"
 
 #include "td/actor/actor.h"
+#include "td/actor/MultiPromise.h"
 #include "td/actor/SchedulerLocalStorage.h"
 
+#include "td/utils/algorithm.h"
+#include "td/utils/as.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
@@ -30,7 +38,6 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
-#include <array>
 #include <iterator>
 #include <limits>
 #include <tuple>
@@ -41,6 +48,30 @@ namespace td {
 static constexpr int32 MESSAGE_DB_INDEX_COUNT = 30;
 static constexpr int32 MESSAGE_DB_INDEX_COUNT_OLD = 9;
 
+// compressed message data starts with the magic, which can't be the first 4 bytes of a serialized message,
+// because they contain a small positive version, followed by the identifier of the used dictionary
+static constexpr uint32 COMPRESSED_MESSAGE_DATA_MAGIC = 0x9a3c17e5;
+static constexpr size_t COMPRESSED_MESSAGE_DATA_HEADER_SIZE = 8;
+static constexpr size_t MIN_COMPRESSED_MESSAGE_DATA_SIZE = 256;
+
+static Status add_fts_triggers(SqliteDb &db) {
+  TRY_STATUS(db.exec(
+      "CREATE TRIGGER IF NOT EXISTS trigger_fts_delete BEFORE DELETE ON messages WHEN OLD.search_id IS NOT NULL"
+      " BEGIN INSERT INTO messages_fts(messages_fts, rowid, text) VALUES(\'delete\', OLD.search_id, OLD.text); END"));
+  return db.exec(
+      "CREATE TRIGGER IF NOT EXISTS trigger_fts_insert AFTER INSERT ON messages WHEN NEW.search_id IS NOT NULL"
+      " BEGIN INSERT INTO messages_fts(rowid, text) VALUES(NEW.search_id, NEW.text); END");
+}
+
+// messages.text contains also dialog and filter markers, which must not be indexed
+static Slice get_message_search_index_source_text(Slice text) {
+  auto pos = text.find('\a');
+  if (pos == Slice::npos) {
+    return text;
+  }
+  return text.substr(0, pos);
+}
+
 // NB: must happen inside a transaction
 Status init_message_db(SqliteDb &db, int32 version) {
   LOG(INFO) << "Init message database " << tag("version", version);
@@ -71,12 +102,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
     TRY_STATUS(
         db.exec("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(text, content='messages', "
                 "content_rowid='search_id', tokenize = \"unicode61 remove_diacritics 0 tokenchars '\a'\")"));
-    TRY_STATUS(db.exec(
-        "CREATE TRIGGER IF NOT EXISTS trigger_fts_delete BEFORE DELETE ON messages WHEN OLD.search_id IS NOT NULL"
-        " BEGIN INSERT INTO messages_fts(messages_fts, rowid, text) VALUES(\'delete\', OLD.search_id, OLD.text); END"));
-    TRY_STATUS(db.exec(
-        "CREATE TRIGGER IF NOT EXISTS trigger_fts_insert AFTER INSERT ON messages WHEN NEW.search_id IS NOT NULL"
-        " BEGIN INSERT INTO messages_fts(rowid, text) VALUES(NEW.search_id, NEW.text); END"));
+    TRY_STATUS(add_fts_triggers(db));
     //TRY_STATUS(db.exec(
     //"CREATE TRIGGER IF NOT EXISTS trigger_fts_update AFTER UPDATE ON messages WHEN NEW.search_id IS NOT NULL OR "
     //"OLD.search_id IS NOT NULL"
@@ -100,6 +126,11 @@ Status init_message_db(SqliteDb &db, int32 version) {
         "CREATE INDEX IF NOT EXISTS message_by_notification_id ON messages (dialog_id, notification_id) WHERE "
         "notification_id IS NOT NULL");
   };
+  auto add_message_data_dictionaries_table = [&db] {
+    return db.exec(
+        "CREATE TABLE IF NOT EXISTS message_data_dictionaries (dictionary_id INT4 PRIMARY KEY, codec INT4, "
+        "dictionary BLOB)");
+  };
   auto add_scheduled_messages_table = [&db] {
     TRY_STATUS(
         db.exec("CREATE TABLE IF NOT EXISTS scheduled_messages (dialog_id INT8, message_id INT8, "
@@ -113,6 +144,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
 
   if (version == 0) {
     LOG(INFO) << "Create new message database";
+    TRY_STATUS(db.exec("DROP TABLE IF EXISTS messages_search_index"));
     TRY_STATUS(
         db.exec("CREATE TABLE IF NOT EXISTS messages (dialog_id INT8, message_id INT8, unique_message_id INT4, "
                 "sender_user_id INT8, random_id INT8, data BLOB, ttl_expires_at INT4, index_mask INT4, search_id INT8, "
@@ -140,6 +172,8 @@ Status init_message_db(SqliteDb &db, int32 version) {
 
     TRY_STATUS(add_scheduled_messages_table());
 
+    TRY_STATUS(add_message_data_dictionaries_table());
+
     version = current_db_version();
   }
   if (version < static_cast<int32>(DbVersion::AddMessageDbMediaIndex)) {
@@ -167,6 +201,9 @@ Status init_message_db(SqliteDb &db, int32 version) {
   if (version < static_cast<int32>(DbVersion::AddMessageThreadSupport)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN top_thread_message_id INT8"));
   }
+  if (version < static_cast<int32>(DbVersion::AddMessageDbCompression)) {
+    TRY_STATUS(add_message_data_dictionaries_table());
+  }
   return Status::OK();
 }
 
@@ -174,9 +211,115 @@ Status init_message_db(SqliteDb &db, int32 version) {
 Status drop_message_db(SqliteDb &db, int32 version) {
   LOG(WARNING) << "Drop message database " << tag("version", version)
                << tag("current_db_version", current_db_version());
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS messages_search_index"));
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS message_data_dictionaries"));
   return db.exec("DROP TABLE IF EXISTS messages");
 }
 
+// NB: must happen inside a transaction
+Status init_message_data_compression(SqliteDb &db) {
+  TRY_RESULT(get_dictionary_count_stmt, db.get_statement("SELECT COUNT(*) FROM message_data_dictionaries"));
+  TRY_STATUS(get_dictionary_count_stmt.step());
+  CHECK(get_dictionary_count_stmt.has_row());
+  if (get_dictionary_count_stmt.view_int32(0) > 0) {
+    return Status::OK();
+  }
+
+  auto codec_type = BlobCodec::Type::Gzip;
+  if (BlobCodec::create(codec_type, string()) == nullptr) {
+    return Status::OK();
+  }
+
+  // the dictionary is trained once on the latest messages and is never replaced, because stored data references it;
+  // it is checked only during database initialization, so messages are stored uncompressed until the first start
+  // with enough stored messages; a better dictionary can be added later with the next identifier, because
+  // all dictionaries are kept and each compressed value specifies the used one
+  const int32 MAX_SAMPLE_COUNT = 2000;
+  const size_t MIN_SAMPLE_COUNT = 500;
+  const size_t MAX_DICTIONARY_SIZE = 32 << 10;
+  const size_t MIN_DICTIONARY_SIZE = 1 << 10;
+  TRY_RESULT(get_samples_stmt, db.get_statement("SELECT data FROM messages ORDER BY rowid DESC LIMIT ?1"));
+  get_samples_stmt.bind_int32(1, MAX_SAMPLE_COUNT).ensure();
+  vector<string> samples;
+  TRY_STATUS(get_samples_stmt.step());
+  while (get_samples_stmt.has_row()) {
+    auto data = get_samples_stmt.view_blob(0);
+    if (data.size() >= MIN_COMPRESSED_MESSAGE_DATA_SIZE) {
+      samples.push_back(data.str());
+    }
+    TRY_STATUS(get_samples_stmt.step());
+  }
+  if (samples.size() < MIN_SAMPLE_COUNT) {
+    return Status::OK();
+  }
+
+  auto dictionary =
+      BlobCodec::train_dictionary(transform(samples, [](const string &sample) { return Slice(sample); }),
+                                  MAX_DICTIONARY_SIZE);
+  if (dictionary.size() < MIN_DICTIONARY_SIZE) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Add message data dictionary of size " << dictionary.size() << " trained on " << samples.size()
+            << " messages";
+
+  TRY_RESULT(add_dictionary_stmt, db.get_statement("INSERT INTO message_data_dictionaries VALUES(?1, ?2, ?3)"));
+  add_dictionary_stmt.bind_int32(1, 1).ensure();
+  add_dictionary_stmt.bind_int32(2, static_cast<int32>(codec_type)).ensure();
+  add_dictionary_stmt.bind_blob(3, dictionary).ensure();
+  return add_dictionary_stmt.step();
+}
+
+// NB: must happen inside a transaction
+Status init_message_search_index(SqliteDb &db, bool use_search_index) {
+  TRY_RESULT(has_search_index, db.has_table("messages_search_index"));
+  if (has_search_index == use_search_index) {
+    return Status::OK();
+  }
+  if (use_search_index) {
+    return rebuild_message_search_index(db);
+  }
+
+  LOG(INFO) << "Drop message search index";
+  TRY_STATUS(db.exec("DROP TABLE messages_search_index"));
+  TRY_STATUS(db.exec("INSERT INTO messages_fts(messages_fts) VALUES('delete-all')"));
+  TRY_STATUS(db.exec(
+      "INSERT INTO messages_fts(rowid, text) SELECT search_id, text FROM messages WHERE search_id IS NOT NULL"));
+  return add_fts_triggers(db);
+}
+
+// NB: must happen inside a transaction
+Status rebuild_message_search_index(SqliteDb &db) {
+  LOG(INFO) << "Rebuild message search index";
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS messages_search_index"));
+  TRY_STATUS(
+      db.exec("CREATE TABLE messages_search_index (trigram INT8, search_id INT8, PRIMARY KEY (trigram, search_id)) "
+              "WITHOUT ROWID"));
+
+  // the full-text search index isn't used and maintained while the search index exists
+  TRY_STATUS(db.exec("DROP TRIGGER IF EXISTS trigger_fts_delete"));
+  TRY_STATUS(db.exec("DROP TRIGGER IF EXISTS trigger_fts_insert"));
+  TRY_STATUS(db.exec("INSERT INTO messages_fts(messages_fts) VALUES('delete-all')"));
+
+  TRY_RESULT(get_texts_stmt, db.get_statement("SELECT search_id, text FROM messages WHERE search_id IS NOT NULL"));
+  TRY_RESULT(add_trigram_stmt, db.get_statement("INSERT OR IGNORE INTO messages_search_index VALUES(?1, ?2)"));
+  int32 message_count = 0;
+  TRY_STATUS(get_texts_stmt.step());
+  while (get_texts_stmt.has_row()) {
+    auto search_id = get_texts_stmt.view_int64(0);
+    auto text = get_message_search_index_text(get_message_search_index_source_text(get_texts_stmt.view_string(1)));
+    for (auto trigram : get_message_search_index_trigrams(text)) {
+      add_trigram_stmt.bind_int64(1, trigram).ensure();
+      add_trigram_stmt.bind_int64(2, search_id).ensure();
+      TRY_STATUS(add_trigram_stmt.step());
+      add_trigram_stmt.reset();
+    }
+    message_count++;
+    TRY_STATUS(get_texts_stmt.step());
+  }
+  LOG(INFO) << "Added " << message_count << " messages to the search index";
+  return Status::OK();
+}
+
 class MessageDbImpl final : public MessageDbSyncInterface {
  public:
   explicit MessageDbImpl(SqliteDb db) : db_(std::move(db)) {
@@ -184,6 +327,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   }
 
   Status init() {
+    TRY_RESULT_ASSIGN(use_search_index_, db_.has_table("messages_search_index"));
+    TRY_STATUS(init_codecs());
+
     TRY_RESULT_ASSIGN(
         add_message_stmt_,
         db_.get_statement("INSERT OR REPLACE INTO messages VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12)"));
@@ -225,41 +371,6 @@ class MessageDbImpl final : public MessageDbSyncInterface {
                                         "IN (SELECT rowid FROM messages_fts WHERE messages_fts MATCH ?1 AND rowid < ?2 "
                                         "ORDER BY rowid DESC LIMIT ?3) ORDER BY search_id DESC"));
 
-    for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
-      TRY_RESULT_ASSIGN(
-          get_message_ids_stmts_[i],
-          db_.get_statement(
-              PSLICE() << "SELECT message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-                       << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT 1000000"));
-
-      TRY_RESULT_ASSIGN(
-          get_messages_from_index_stmts_[i].desc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT ?3"));
-
-      TRY_RESULT_ASSIGN(
-          get_messages_from_index_stmts_[i].asc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id > ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id ASC LIMIT ?3"));
-
-      // LOG(ERROR) << get_messages_from_index_stmts_[i].desc_stmt_.explain().ok();
-      // LOG(ERROR) << get_messages_from_index_stmts_[i].asc_stmt_.explain().ok();
-    }
-
-    for (int i = static_cast<int>(MessageSearchFilter::Call) - 1, pos = 0;
-         i < static_cast<int>(MessageSearchFilter::MissedCall); i++, pos++) {
-      TRY_RESULT_ASSIGN(
-          get_calls_stmts_[pos],
-          db_.get_statement(
-              PSLICE()
-              << "SELECT dialog_id, message_id, data FROM messages WHERE unique_message_id < ?1 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY unique_message_id DESC LIMIT ?2"));
-    }
-
     TRY_RESULT_ASSIGN(add_scheduled_message_stmt_,
                       db_.get_statement("INSERT OR REPLACE INTO scheduled_messages VALUES(?1, ?2, ?3, ?4)"));
     TRY_RESULT_ASSIGN(
@@ -295,6 +406,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     auto message_id = message_full_id.get_message_id();
     LOG_CHECK(dialog_id.is_valid()) << dialog_id << ' ' << message_id << ' ' << message_full_id;
     CHECK(message_id.is_valid());
+    if (use_search_index_) {
+      delete_search_index_trigrams("dialog_id = ?1 AND message_id = ?2", dialog_id.get(), message_id.get());
+    }
     SCOPE_EXIT {
       add_message_stmt_.reset();
     };
@@ -319,7 +433,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       add_message_stmt_.bind_null(5).ensure();
     }
 
-    add_message_stmt_.bind_blob(6, data.as_slice()).ensure();
+    auto compressed_data = compress_message_data(data.as_slice());
+    add_message_stmt_.bind_blob(6, compressed_data.empty() ? data.as_slice() : compressed_data.as_slice()).ensure();
 
     if (ttl_expires_at != 0) {
       add_message_stmt_.bind_int32(7, ttl_expires_at).ensure();
@@ -364,6 +479,10 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
 
     add_message_stmt_.step().ensure();
+
+    if (use_search_index_ && search_id != 0) {
+      add_search_index_trigrams(search_id, text);
+    }
   }
 
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) final {
@@ -397,6 +516,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     CHECK(message_id.is_valid() || message_id.is_valid_scheduled());
     bool is_scheduled = message_id.is_scheduled();
     bool is_scheduled_server = is_scheduled && message_id.is_scheduled_server();
+    if (use_search_index_ && !is_scheduled) {
+      delete_search_index_trigrams("dialog_id = ?1 AND message_id = ?2", dialog_id.get(), message_id.get());
+    }
     auto &stmt = is_scheduled
                      ? (is_scheduled_server ? delete_scheduled_server_message_stmt_ : delete_scheduled_message_stmt_)
                      : delete_message_stmt_;
@@ -416,6 +538,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     LOG(INFO) << "Delete all messages in " << dialog_id << " up to " << from_message_id << " from database";
     CHECK(dialog_id.is_valid());
     CHECK(from_message_id.is_valid());
+    if (use_search_index_) {
+      delete_search_index_trigrams("dialog_id = ?1 AND message_id <= ?2", dialog_id.get(), from_message_id.get());
+    }
     SCOPE_EXIT {
       delete_all_dialog_messages_stmt_.reset();
     };
@@ -431,6 +556,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     LOG(INFO) << "Delete all messages in " << dialog_id << " sent by " << sender_dialog_id << " from database";
     CHECK(dialog_id.is_valid());
     CHECK(sender_dialog_id.is_valid());
+    if (use_search_index_) {
+      delete_search_index_trigrams("dialog_id = ?1 AND sender_user_id = ?2", dialog_id.get(), sender_dialog_id.get());
+    }
     SCOPE_EXIT {
       delete_dialog_messages_by_sender_stmt_.reset();
     };
@@ -463,16 +591,17 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       return Status::Error("Not found");
     }
     MessageId received_message_id(stmt.view_int64(0));
-    Slice data = stmt.view_blob(1);
+    TRY_RESULT(data, get_message_data(stmt.view_blob(1)));
     if (is_scheduled_server) {
       CHECK(received_message_id.is_scheduled());
       CHECK(received_message_id.is_scheduled_server());
       CHECK(received_message_id.get_scheduled_server_message_id() == message_id.get_scheduled_server_message_id());
     } else {
       LOG_CHECK(received_message_id == message_id)
-          << received_message_id << ' ' << message_id << ' ' << get_message_info(received_message_id, data, true).first;
+          << received_message_id << ' ' << message_id << ' '
+          << get_message_info(received_message_id, data.as_slice(), true).first;
     }
-    return MessageDbDialogMessage{received_message_id, BufferSlice(data)};
+    return MessageDbDialogMessage{received_message_id, std::move(data)};
   }
 
   Result<MessageDbMessage> get_message_by_unique_message_id(ServerMessageId unique_message_id) final {
@@ -489,7 +618,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
     DialogId dialog_id(get_message_by_unique_message_id_stmt_.view_int64(0));
     MessageId message_id(get_message_by_unique_message_id_stmt_.view_int64(1));
-    return MessageDbMessage{dialog_id, message_id, BufferSlice(get_message_by_unique_message_id_stmt_.view_blob(2))};
+    TRY_RESULT(data, get_message_data(get_message_by_unique_message_id_stmt_.view_blob(2)));
+    return MessageDbMessage{dialog_id, message_id, std::move(data)};
   }
 
   Result<MessageDbDialogMessage> get_message_by_random_id(DialogId dialog_id, int64 random_id) final {
@@ -503,7 +633,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       return Status::Error("Not found");
     }
     MessageId message_id(get_message_by_random_id_stmt_.view_int64(0));
-    return MessageDbDialogMessage{message_id, BufferSlice(get_message_by_random_id_stmt_.view_blob(1))};
+    TRY_RESULT(data, get_message_data(get_message_by_random_id_stmt_.view_blob(1)));
+    return MessageDbDialogMessage{message_id, std::move(data)};
   }
 
   Result<MessageDbDialogMessage> get_dialog_message_by_date(DialogId dialog_id, MessageId first_message_id,
@@ -581,8 +712,12 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (get_expiring_messages_stmt_.has_row()) {
       DialogId dialog_id(get_expiring_messages_stmt_.view_int64(0));
       MessageId message_id(get_expiring_messages_stmt_.view_int64(1));
-      BufferSlice data(get_expiring_messages_stmt_.view_blob(2));
-      messages.push_back(MessageDbMessage{dialog_id, message_id, std::move(data)});
+      auto r_data = get_message_data(get_expiring_messages_stmt_.view_blob(2));
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+      } else {
+        messages.push_back(MessageDbMessage{dialog_id, message_id, r_data.move_as_ok()});
+      }
       get_expiring_messages_stmt_.step().ensure();
     }
 
@@ -590,7 +725,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   }
 
   MessageDbCalendar get_dialog_message_calendar(MessageDbDialogCalendarQuery query) final {
-    auto &stmt = get_messages_from_index_stmts_[message_search_filter_index(query.filter)].desc_stmt_;
+    auto &stmt = get_messages_from_index_stmt(query.filter, true);
     SCOPE_EXIT {
       stmt.reset();
     };
@@ -604,16 +739,22 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     stmt.step().ensure();
     int32 current_day = std::numeric_limits<int32>::max();
     while (stmt.has_row()) {
-      auto data_slice = stmt.view_blob(0);
+      auto r_data = get_message_data(stmt.view_blob(0));
       MessageId message_id(stmt.view_int64(1));
-      auto info = get_message_info(message_id, data_slice, false);
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << query.dialog_id << ": " << r_data.error();
+        stmt.step().ensure();
+        continue;
+      }
+      auto data = r_data.move_as_ok();
+      auto info = get_message_info(message_id, data.as_slice(), false);
       auto day = (query.tz_offset + info.second) / 86400;
       if (day >= current_day) {
         CHECK(!total_counts.empty());
         total_counts.back()++;
       } else {
         current_day = day;
-        messages.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+        messages.push_back(MessageDbDialogMessage{message_id, std::move(data)});
         total_counts.push_back(1);
       }
       stmt.step().ensure();
@@ -623,7 +764,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
 
   Result<MessageDbMessagePositions> get_dialog_sparse_message_positions(
       MessageDbGetDialogSparseMessagePositionsQuery query) final {
-    auto &stmt = get_message_ids_stmts_[message_search_filter_index(query.filter)];
+    auto &stmt = get_message_ids_stmt(query.filter);
     SCOPE_EXIT {
       stmt.reset();
     };
@@ -658,7 +799,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     if (query.filter != MessageSearchFilter::Empty) {
       return get_messages_from_index(query.dialog_id, query.from_message_id, query.filter, query.offset, query.limit);
     }
-    return get_messages_impl(get_messages_stmt_, query.dialog_id, query.from_message_id, query.offset, query.limit);
+    return get_messages_impl(get_messages_stmt_.asc_stmt_, get_messages_stmt_.desc_stmt_, query.dialog_id,
+                             query.from_message_id, query.offset, query.limit);
   }
 
   vector<MessageDbDialogMessage> get_scheduled_messages(DialogId dialog_id, int32 limit) final {
@@ -679,9 +821,13 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     vector<MessageDbDialogMessage> result;
     stmt.step().ensure();
     while (stmt.has_row()) {
-      auto data_slice = stmt.view_blob(0);
+      auto r_data = get_message_data(stmt.view_blob(0));
       MessageId message_id(stmt.view_int64(1));
-      result.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+      } else {
+        result.push_back(MessageDbDialogMessage{message_id, r_data.move_as_ok()});
+      }
       LOG(INFO) << "Load " << message_id << " in " << dialog_id << " from database";
       stmt.step().ensure();
     }
@@ -736,6 +882,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   }
 
   MessageDbFtsResult get_messages_fts(MessageDbFtsQuery query) final {
+    if (use_search_index_) {
+      return get_messages_from_search_index(std::move(query));
+    }
     SCOPE_EXIT {
       get_messages_fts_stmt_.reset();
     };
@@ -771,32 +920,130 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (stmt.has_row()) {
       DialogId dialog_id(stmt.view_int64(0));
       MessageId message_id(stmt.view_int64(1));
-      auto data_slice = stmt.view_blob(2);
+      auto r_data = get_message_data(stmt.view_blob(2));
       auto search_id = stmt.view_int64(3);
       result.next_search_id = search_id;
-      result.messages.push_back(MessageDbMessage{dialog_id, message_id, BufferSlice(data_slice)});
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+      } else {
+        result.messages.push_back(MessageDbMessage{dialog_id, message_id, r_data.move_as_ok()});
+      }
       stmt.step().ensure();
     }
     return result;
   }
 
+  MessageDbFtsResult get_messages_from_search_index(MessageDbFtsQuery query) {
+    LOG(INFO) << "Search for " << tag("query", query.query) << " in the search index in " << query.dialog_id
+              << tag("filter", query.filter) << tag("from_search_id", query.from_search_id)
+              << tag("limit", query.limit);
+    auto patterns = get_message_search_index_patterns(query.query);
+
+    // select messages containing all trigrams of at least one pattern for each of the words
+    vector<int64> trigrams;
+    vector<string> conditions;
+    for (auto &word_patterns : patterns) {
+      vector<string> word_conditions;
+      for (auto &pattern : word_patterns) {
+        auto pattern_trigrams = get_message_search_index_trigrams(pattern);
+        CHECK(!pattern_trigrams.empty());
+        word_conditions.push_back(PSTRING() << "SUM(trigram IN (" << implode_trigrams(pattern_trigrams)
+                                            << ")) = " << pattern_trigrams.size());
+        append(trigrams, std::move(pattern_trigrams));
+      }
+      conditions.push_back(PSTRING() << '(' << implode_conditions(word_conditions, " OR ") << ')');
+    }
+
+    // dialog and filter restrictions are checked by the database to avoid loading of non-matching candidates
+    string restrictions;
+    if (query.dialog_id.is_valid()) {
+      restrictions += PSTRING() << " AND dialog_id = " << query.dialog_id.get();
+    }
+    auto index_mask = message_search_filter_index_mask(query.filter);
+    if (index_mask != 0) {
+      restrictions += PSTRING() << " AND (index_mask & " << index_mask << ") = " << index_mask;
+    }
+
+    string candidates_query;
+    if (conditions.empty()) {
+      candidates_query = PSTRING() << "SELECT search_id FROM messages WHERE search_id IS NOT NULL AND search_id < ?1"
+                                   << restrictions << " ORDER BY search_id DESC LIMIT ?2";
+    } else {
+      td::unique(trigrams);
+      candidates_query = PSTRING() << "SELECT search_id FROM messages WHERE search_id IN (SELECT search_id FROM "
+                                   << "messages_search_index WHERE trigram IN (" << implode_trigrams(trigrams)
+                                   << ") AND search_id < ?1 GROUP BY search_id HAVING "
+                                   << implode_conditions(conditions, " AND ") << ')' << restrictions
+                                   << " ORDER BY search_id DESC LIMIT ?2";
+    }
+
+    MessageDbFtsResult result;
+    auto r_candidates_stmt = db_.get_statement(candidates_query);
+    if (r_candidates_stmt.is_error()) {
+      LOG(ERROR) << r_candidates_stmt.error();
+      return result;
+    }
+    auto candidates_stmt = r_candidates_stmt.move_as_ok();
+
+    const int32 candidate_batch_size = max(query.limit, static_cast<int32>(100));
+    auto from_search_id = query.from_search_id == 0 ? std::numeric_limits<int64>::max() : query.from_search_id;
+    while (true) {
+      vector<int64> search_ids;
+      candidates_stmt.bind_int64(1, from_search_id).ensure();
+      candidates_stmt.bind_int32(2, candidate_batch_size).ensure();
+      auto status = candidates_stmt.step();
+      while (status.is_ok() && candidates_stmt.has_row()) {
+        search_ids.push_back(candidates_stmt.view_int64(0));
+        status = candidates_stmt.step();
+      }
+      candidates_stmt.reset();
+      if (status.is_error()) {
+        LOG(ERROR) << status;
+        return result;
+      }
+
+      auto &stmt = get_cached_statement("SELECT dialog_id, message_id, data, text FROM messages WHERE search_id = ?1");
+      for (auto search_id : search_ids) {
+        SCOPE_EXIT {
+          stmt.reset();
+        };
+        stmt.bind_int64(1, search_id).ensure();
+        stmt.step().ensure();
+        if (!stmt.has_row() ||
+            !match_message_search_index_patterns(
+                get_message_search_index_text(get_message_search_index_source_text(stmt.view_string(3))),
+                patterns)) {
+          continue;
+        }
+        result.next_search_id = search_id;
+        DialogId dialog_id(stmt.view_int64(0));
+        MessageId message_id(stmt.view_int64(1));
+        auto r_data = get_message_data(stmt.view_blob(2));
+        if (r_data.is_error()) {
+          LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+          continue;
+        }
+        result.messages.push_back(MessageDbMessage{dialog_id, message_id, r_data.move_as_ok()});
+        if (result.messages.size() >= static_cast<size_t>(query.limit)) {
+          return result;
+        }
+      }
+      if (search_ids.size() < static_cast<size_t>(candidate_batch_size)) {
+        return result;
+      }
+      from_search_id = search_ids.back();
+    }
+  }
+
   vector<MessageDbDialogMessage> get_messages_from_index(DialogId dialog_id, MessageId from_message_id,
                                                          MessageSearchFilter filter, int32 offset, int32 limit) {
-    auto &stmt = get_messages_from_index_stmts_[message_search_filter_index(filter)];
-    return get_messages_impl(stmt, dialog_id, from_message_id, offset, limit);
+    return get_messages_impl(get_messages_from_index_stmt(filter, false), get_messages_from_index_stmt(filter, true),
+                             dialog_id, from_message_id, offset, limit);
   }
 
   MessageDbCallsResult get_calls(MessageDbCallsQuery query) final {
-    int32 pos;
-    if (query.filter == MessageSearchFilter::Call) {
-      pos = 0;
-    } else if (query.filter == MessageSearchFilter::MissedCall) {
-      pos = 1;
-    } else {
-      UNREACHABLE();
-    }
-
-    auto &stmt = get_calls_stmts_[pos];
+    CHECK(query.filter == MessageSearchFilter::Call || query.filter == MessageSearchFilter::MissedCall);
+    auto &stmt = get_calls_stmt(query.filter);
     SCOPE_EXIT {
       stmt.reset();
     };
@@ -809,8 +1056,12 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (stmt.has_row()) {
       DialogId dialog_id(stmt.view_int64(0));
       MessageId message_id(stmt.view_int64(1));
-      auto data_slice = stmt.view_blob(2);
-      result.messages.push_back(MessageDbMessage{dialog_id, message_id, BufferSlice(data_slice)});
+      auto r_data = get_message_data(stmt.view_blob(2));
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+      } else {
+        result.messages.push_back(MessageDbMessage{dialog_id, message_id, r_data.move_as_ok()});
+      }
       stmt.step().ensure();
     }
     return result;
@@ -825,6 +1076,10 @@ class MessageDbImpl final : public MessageDbSyncInterface {
 
  private:
   SqliteDb db_;
+  bool use_search_index_ = false;
+
+  FlatHashMap<int32, unique_ptr<BlobCodec>> codecs_;
+  int32 current_dictionary_id_ = 0;
 
   SqliteStatement add_message_stmt_;
 
@@ -845,10 +1100,6 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   SqliteStatement get_scheduled_messages_stmt_;
   SqliteStatement get_messages_from_notification_id_stmt_;
 
-  std::array<SqliteStatement, MESSAGE_DB_INDEX_COUNT> get_message_ids_stmts_;
-  std::array<GetMessagesStmt, MESSAGE_DB_INDEX_COUNT> get_messages_from_index_stmts_;
-  std::array<SqliteStatement, 2> get_calls_stmts_;
-
   SqliteStatement get_messages_fts_stmt_;
 
   SqliteStatement add_scheduled_message_stmt_;
@@ -857,8 +1108,145 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   SqliteStatement delete_scheduled_message_stmt_;
   SqliteStatement delete_scheduled_server_message_stmt_;
 
-  static vector<MessageDbDialogMessage> get_messages_impl(GetMessagesStmt &stmt, DialogId dialog_id,
-                                                          MessageId from_message_id, int32 offset, int32 limit) {
+  // statements for each of the search filters are prepared on first use and are kept in the statement cache
+  SqliteStatement &get_cached_statement(CSlice statement) {
+    auto r_stmt = db_.get_cached_statement(statement);
+    LOG_CHECK(r_stmt.is_ok()) << r_stmt.error() << ' ' << statement;
+    return *r_stmt.ok();
+  }
+
+  SqliteStatement &get_message_ids_stmt(MessageSearchFilter filter) {
+    return get_cached_statement(
+        PSLICE() << "SELECT message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
+                 << message_search_filter_index_mask(filter) << ") != 0 ORDER BY message_id DESC LIMIT 1000000");
+  }
+
+  SqliteStatement &get_messages_from_index_stmt(MessageSearchFilter filter, bool is_desc) {
+    return get_cached_statement(PSLICE() << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id "
+                                         << (is_desc ? '<' : '>') << " ?2 AND (index_mask & "
+                                         << message_search_filter_index_mask(filter) << ") != 0 ORDER BY message_id "
+                                         << (is_desc ? "DESC" : "ASC") << " LIMIT ?3");
+  }
+
+  SqliteStatement &get_calls_stmt(MessageSearchFilter filter) {
+    return get_cached_statement(
+        PSLICE() << "SELECT dialog_id, message_id, data FROM messages WHERE unique_message_id < ?1 AND (index_mask & "
+                 << message_search_filter_index_mask(filter) << ") != 0 ORDER BY unique_message_id DESC LIMIT ?2");
+  }
+
+  Status init_codecs() {
+    TRY_RESULT(stmt, db_.get_statement("SELECT dictionary_id, codec, dictionary FROM message_data_dictionaries"));
+    TRY_STATUS(stmt.step());
+    while (stmt.has_row()) {
+      auto dictionary_id = stmt.view_int32(0);
+      auto codec = BlobCodec::create(static_cast<BlobCodec::Type>(stmt.view_int32(1)), stmt.view_blob(2).str());
+      if (codec == nullptr) {
+        LOG(ERROR) << "Unsupported codec " << stmt.view_int32(1) << " is used by message data dictionary "
+                   << dictionary_id;
+      } else {
+        codecs_[dictionary_id] = std::move(codec);
+        current_dictionary_id_ = max(current_dictionary_id_, dictionary_id);
+      }
+      TRY_STATUS(stmt.step());
+    }
+    return Status::OK();
+  }
+
+  // returns an empty buffer if the data must be stored uncompressed
+  BufferSlice compress_message_data(Slice data) {
+    if (current_dictionary_id_ == 0 || data.size() < MIN_COMPRESSED_MESSAGE_DATA_SIZE) {
+      return BufferSlice();
+    }
+    // the compression must save at least 1/8 of the size to be worth decompression on each read
+    auto max_size = data.size() - data.size() / 8 - COMPRESSED_MESSAGE_DATA_HEADER_SIZE;
+    auto compressed_data = codecs_.find(current_dictionary_id_)->second->compress(data, max_size);
+    if (compressed_data.empty()) {
+      return BufferSlice();
+    }
+
+    BufferSlice result(COMPRESSED_MESSAGE_DATA_HEADER_SIZE + compressed_data.size());
+    as<uint32>(result.as_mutable_slice().begin()) = COMPRESSED_MESSAGE_DATA_MAGIC;
+    as<int32>(result.as_mutable_slice().begin() + 4) = current_dictionary_id_;
+    result.as_mutable_slice().substr(COMPRESSED_MESSAGE_DATA_HEADER_SIZE).copy_from(compressed_data.as_slice());
+    return result;
+  }
+
+  Result<BufferSlice> get_message_data(Slice data) {
+    if (data.size() < COMPRESSED_MESSAGE_DATA_HEADER_SIZE ||
+        as<uint32>(data.begin()) != COMPRESSED_MESSAGE_DATA_MAGIC) {
+      return BufferSlice(data);
+    }
+    int32 dictionary_id = as<int32>(data.begin() + 4);
+    auto it = codecs_.find(dictionary_id);
+    if (it == codecs_.end()) {
+      return Status::Error(PSLICE() << "Can't find message data dictionary " << dictionary_id);
+    }
+    auto r_data = it->second->decompress(data.substr(COMPRESSED_MESSAGE_DATA_HEADER_SIZE));
+    if (r_data.is_error()) {
+      return Status::Error(PSLICE() << "Failed to decompress message data: " << r_data.error().message());
+    }
+    return r_data.move_as_ok();
+  }
+
+  static string implode_conditions(const vector<string> &conditions, Slice delimiter) {
+    string result;
+    for (auto &condition : conditions) {
+      if (!result.empty()) {
+        result.append(delimiter.begin(), delimiter.size());
+      }
+      result += condition;
+    }
+    return result;
+  }
+
+  static string implode_trigrams(const vector<int64> &trigrams) {
+    return implode(transform(trigrams, [](int64 trigram) { return to_string(trigram); }), ',');
+  }
+
+  void add_search_index_trigrams(int64 search_id, Slice text) {
+    auto &stmt = get_cached_statement("INSERT OR IGNORE INTO messages_search_index VALUES(?1, ?2)");
+    for (auto trigram :
+         get_message_search_index_trigrams(get_message_search_index_text(get_message_search_index_source_text(text)))) {
+      stmt.bind_int64(1, trigram).ensure();
+      stmt.bind_int64(2, search_id).ensure();
+      stmt.step().ensure();
+      stmt.reset();
+    }
+  }
+
+  // deletes search index entries of the messages satisfying the condition before the messages are deleted
+  void delete_search_index_trigrams(Slice condition, int64 first_value, int64 second_value) {
+    vector<std::pair<int64, string>> texts;
+    {
+      auto &stmt = get_cached_statement(PSLICE() << "SELECT search_id, text FROM messages WHERE " << condition
+                                                 << " AND search_id IS NOT NULL");
+      SCOPE_EXIT {
+        stmt.reset();
+      };
+      stmt.bind_int64(1, first_value).ensure();
+      stmt.bind_int64(2, second_value).ensure();
+      stmt.step().ensure();
+      while (stmt.has_row()) {
+        texts.emplace_back(stmt.view_int64(0), stmt.view_string(1).str());
+        stmt.step().ensure();
+      }
+    }
+
+    auto &stmt = get_cached_statement("DELETE FROM messages_search_index WHERE trigram = ?1 AND search_id = ?2");
+    for (auto &text : texts) {
+      for (auto trigram : get_message_search_index_trigrams(
+               get_message_search_index_text(get_message_search_index_source_text(text.second)))) {
+        stmt.bind_int64(1, trigram).ensure();
+        stmt.bind_int64(2, text.first).ensure();
+        stmt.step().ensure();
+        stmt.reset();
+      }
+    }
+  }
+
+  vector<MessageDbDialogMessage> get_messages_impl(SqliteStatement &asc_stmt, SqliteStatement &desc_stmt,
+                                                   DialogId dialog_id, MessageId from_message_id, int32 offset,
+                                                   int32 limit) {
     LOG_CHECK(dialog_id.is_valid()) << dialog_id;
     CHECK(from_message_id.is_valid());
 
@@ -886,14 +1274,14 @@ class MessageDbImpl final : public MessageDbSyncInterface {
         left_cnt++;
       }
 
-      left = get_messages_inner(stmt.desc_stmt_, dialog_id, left_message_id, left_cnt);
+      left = get_messages_inner(desc_stmt, dialog_id, left_message_id, left_cnt);
 
       if (right_cnt == 1 && !left.empty() && false /*get_message_id(left[0].as_slice()) == message_id*/) {
         right_cnt = 0;
       }
     }
     if (right_cnt != 0) {
-      right = get_messages_inner(stmt.asc_stmt_, dialog_id, right_message_id, right_cnt);
+      right = get_messages_inner(asc_stmt, dialog_id, right_message_id, right_cnt);
       std::reverse(right.begin(), right.end());
     }
     if (left.empty()) {
@@ -909,8 +1297,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     return right;
   }
 
-  static vector<MessageDbDialogMessage> get_messages_inner(SqliteStatement &stmt, DialogId dialog_id,
-                                                           int64 from_message_id, int32 limit) {
+  vector<MessageDbDialogMessage> get_messages_inner(SqliteStatement &stmt, DialogId dialog_id, int64 from_message_id,
+                                                    int32 limit) {
     SCOPE_EXIT {
       stmt.reset();
     };
@@ -923,9 +1311,13 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     vector<MessageDbDialogMessage> result;
     stmt.step().ensure();
     while (stmt.has_row()) {
-      auto data_slice = stmt.view_blob(0);
+      auto r_data = get_message_data(stmt.view_blob(0));
       MessageId message_id(stmt.view_int64(1));
-      result.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+      if (r_data.is_error()) {
+        LOG(ERROR) << "Skip " << message_id << " in " << dialog_id << ": " << r_data.error();
+      } else {
+        result.push_back(MessageDbDialogMessage{message_id, r_data.move_as_ok()});
+      }
       LOG(INFO) << "Loaded " << message_id << " in " << dialog_id << " from database";
       stmt.step().ensure();
     }
@@ -988,8 +1380,13 @@ std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
 
 class MessageDbAsync final : public MessageDbAsyncInterface {
  public:
-  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db));
+  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+                 const vector<int32> &reader_scheduler_ids) {
+    vector<ActorOwn<Reader>> readers;
+    for (auto reader_scheduler_id : reader_scheduler_ids) {
+      readers.push_back(create_actor_on_scheduler<Reader>("MessageDbReader", reader_scheduler_id, sync_db));
+    }
+    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db), std::move(readers));
   }
 
   void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
@@ -1068,9 +1465,45 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
   }
 
  private:
+  // serves long read-only queries using its own connection in parallel with the writer
+  class Reader final : public Actor {
+   public:
+    explicit Reader(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe)
+        : sync_db_safe_(std::move(sync_db_safe)) {
+    }
+
+    void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
+      promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
+    }
+
+    void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
+      promise.set_value(sync_db_->get_messages(std::move(query)));
+    }
+
+    void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
+      promise.set_value(sync_db_->get_messages_fts(std::move(query)));
+    }
+
+    void close(Promise<> promise) {
+      sync_db_safe_.reset();
+      sync_db_ = nullptr;
+      promise.set_value(Unit());
+      stop();
+    }
+
+   private:
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
+    MessageDbSyncInterface *sync_db_ = nullptr;
+
+    void start_up() final {
+      sync_db_ = &sync_db_safe_->get();
+    }
+  };
+
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe, vector<ActorOwn<Reader>> readers)
+        : sync_db_safe_(std::move(sync_db_safe)), readers_(std::move(readers)) {
     }
     void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                      int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
@@ -1136,6 +1569,9 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_dialog_message_calendar, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
     }
 
@@ -1147,6 +1583,9 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_messages, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_messages(std::move(query)));
     }
     void get_scheduled_messages(DialogId dialog_id, int32 limit, Promise<vector<MessageDbDialogMessage>> promise) {
@@ -1164,6 +1603,9 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     }
     void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_messages_fts, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_messages_fts(std::move(query)));
     }
     void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) {
@@ -1172,58 +1614,71 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     }
 
     void close(Promise<> promise) {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Force);
+      LOG(INFO) << "Close MessageDb with write statistics " << write_batch_policy_.get_statistics();
+      // the database can be closed only after all readers have finished their queries
+      MultiPromiseActorSafe mpas{"MessageDbCloseMultiPromiseActor"};
+      mpas.add_promise(std::move(promise));
+      auto lock = mpas.get_promise();
+      for (auto &reader : readers_) {
+        send_closure(reader, &Reader::close, mpas.get_promise());
+      }
+      readers_.clear();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+      lock.set_value(Unit());
       stop();
     }
 
     void force_flush() {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Force);
       LOG(INFO) << "MessageDb flushed";
     }
 
    private:
     std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
     MessageDbSyncInterface *sync_db_ = nullptr;
-
-    static constexpr size_t MAX_PENDING_QUERY_COUNT{50};
-    static constexpr double MAX_PENDING_QUERY_DELAY{0.01};
+    vector<ActorOwn<Reader>> readers_;
+    size_t next_reader_pos_ = 0;
 
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
+    WriteBatchPolicy write_batch_policy_;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERY_COUNT) {
-        do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERY_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      if (pending_writes_.size() >= write_batch_policy_.get_max_write_count()) {
+        do_flush(WriteBatchPolicy::FlushReason::Full);
+      } else if (pending_writes_.size() == 1) {
+        set_timeout_in(write_batch_policy_.on_batch_start(Time::now_cached()));
       }
     }
     void add_read_query() {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Read);
+    }
+    // add_read_query must be called before, so that all pending writes are visible for the reader
+    ActorId<Reader> get_reader() {
+      CHECK(!readers_.empty());
+      auto &reader = readers_[next_reader_pos_++ % readers_.size()];
+      return reader.get();
     }
-    void do_flush() {
+    void do_flush(WriteBatchPolicy::FlushReason reason) {
       if (pending_writes_.empty()) {
         return;
       }
+      auto write_count = pending_writes_.size();
+      auto start_time = Time::now();
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
       sync_db_->commit_transaction().ensure();
+      write_batch_policy_.on_transaction(reason, write_count, start_time, Time::now());
       set_promises(finished_writes_);
       cancel_timeout();
     }
     void timeout_expired() final {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Timeout);
     }
 
     void start_up() final {
@@ -1234,8 +1689,9 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 };
 
 std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id) {
-  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id);
+                                                                 int32 scheduler_id,
+                                                                 const vector<int32> &reader_scheduler_ids) {
+  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id, reader_scheduler_ids);
 }
 
 }  // namespace td
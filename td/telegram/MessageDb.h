@@ -196,10 +196,21 @@ class MessageDbAsyncInterface {
 Status init_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 Status drop_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 
+// creates and fills or drops the dedicated search index, which replaces the full-text search index when enabled
+Status init_message_search_index(SqliteDb &db, bool use_search_index) TD_WARN_UNUSED_RESULT;
+Status rebuild_message_search_index(SqliteDb &db) TD_WARN_UNUSED_RESULT;
+
+// trains a dictionary for compression of message data if there is none yet and there are enough messages
+// must be called during database initialization; the dictionary is used by connections opened after the call
+Status init_message_data_compression(SqliteDb &db) TD_WARN_UNUSED_RESULT;
+
 std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
     std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
 
+// history, full-text search and calendar queries are served by readers on reader_scheduler_ids, if any,
+// in parallel with each other and with the writer
 std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id = -1);
+                                                                 int32 scheduler_id = -1,
+                                                                 const vector<int32> &reader_scheduler_ids = {});
 
 }  // namespace td
@@ -0,0 +1,78 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/MessageSearchIndex.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/misc.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/translit.h"
+#include "td/utils/utf8.h"
+
+#include <algorithm>
+
+namespace td {
+
+static constexpr size_t MIN_SUBSTRING_PATTERN_LENGTH = 3;
+
+string get_message_search_index_text(Slice text) {
+  auto words = utf8_get_search_words(text);
+  if (words.empty()) {
+    return string();
+  }
+  return PSTRING() << ' ' << implode(words) << ' ';
+}
+
+vector<int64> get_message_search_index_trigrams(Slice text) {
+  vector<int64> result;
+  uint64 trigram = 0;
+  size_t length = 0;
+  uint32 prev_code = 0;
+  for (auto ptr = text.ubegin(), end = text.uend(); ptr < end;) {
+    uint32 code;
+    ptr = next_utf8_unsafe(ptr, &code);
+    trigram = ((trigram << 21) | (code & 0x1FFFFF)) & ((static_cast<uint64>(1) << 63) - 1);
+    if (++length >= 3) {
+      result.push_back(static_cast<int64>(trigram));
+    }
+    if (prev_code == ' ' && code != ' ') {
+      // the first character of a word is indexed separately as a negative key to find one-character word prefixes
+      result.push_back(-1 - static_cast<int64>(code & 0x1FFFFF));
+    }
+    prev_code = code;
+  }
+  td::unique(result);
+  return result;
+}
+
+vector<vector<string>> get_message_search_index_patterns(Slice query) {
+  const size_t MAX_QUERY_SIZE = 1024;
+  vector<vector<string>> result;
+  for (auto &word : utf8_get_search_words(utf8_truncate(query, MAX_QUERY_SIZE))) {
+    auto words = get_word_transliterations(word, true);
+    words.push_back(std::move(word));
+
+    vector<string> patterns;
+    for (auto &w : words) {
+      if (utf8_length(w) >= MIN_SUBSTRING_PATTERN_LENGTH) {
+        patterns.push_back(std::move(w));
+      } else {
+        patterns.push_back(PSTRING() << ' ' << w);
+      }
+    }
+    td::unique(patterns);
+    result.push_back(std::move(patterns));
+  }
+  return result;
+}
+
+bool match_message_search_index_patterns(const string &text, const vector<vector<string>> &patterns) {
+  return all_of(patterns, [&text](const vector<string> &word_patterns) {
+    return any_of(word_patterns, [&text](const string &pattern) { return text.find(pattern) != string::npos; });
+  });
+}
+
+}  // namespace td
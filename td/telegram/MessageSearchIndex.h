@@ -0,0 +1,28 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// Texts are normalized to space-separated search words with leading and trailing spaces,
+// so a word prefix can be found as a substring, which starts with a space.
+string get_message_search_index_text(Slice text);
+
+// returns sorted distinct trigrams of code points of a normalized text or of a search pattern
+// and keys of the first characters of the words, which are preceded by a space
+vector<int64> get_message_search_index_trigrams(Slice text);
+
+// returns search patterns for each of the query words; one of the patterns for each word must be found in the text
+// patterns include word transliterations; short words are matched only as word prefixes
+vector<vector<string>> get_message_search_index_patterns(Slice query);
+
+bool match_message_search_index_patterns(const string &text, const vector<vector<string>> &patterns);
+
+}  // namespace td
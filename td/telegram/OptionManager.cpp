@@ -981,6 +981,11 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
         return;
       }
       break;
+    case 'q':
+      if (set_integer_option("query_packing_delay", 0, 100000)) {
+        return;
+      }
+      break;
     case 'r':
       // temporary option
       if (set_boolean_option("reuse_uploaded_photos_by_hash")) {
@@ -1010,6 +1015,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 'u':
+      if (set_boolean_option("use_message_search_index")) {
+        return;
+      }
       if (set_boolean_option("use_pfs")) {
         return;
       }
@@ -8658,6 +8658,14 @@ void Requests::on_request(uint64 id, const td_api::addLogMessage &request) {
   UNREACHABLE();
 }
 
+void Requests::on_request(uint64 id, const td_api::enableActorProfiling &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getActorStatistics &request) {
+  UNREACHABLE();
+}
+
 // test
 void Requests::on_request(uint64 id, const td_api::testNetwork &request) {
   CREATE_OK_REQUEST_PROMISE();
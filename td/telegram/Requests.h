@@ -1903,6 +1903,10 @@ class Requests {
 
   void on_request(uint64 id, const td_api::addLogMessage &request);
 
+  void on_request(uint64 id, const td_api::enableActorProfiling &request);
+
+  void on_request(uint64 id, const td_api::getActorStatistics &request);
+
   void on_request(uint64 id, const td_api::testNetwork &request);
 
   void on_request(uint64 id, td_api::testProxy &request);
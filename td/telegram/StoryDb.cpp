@@ -12,6 +12,7 @@
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/WriteBatchPolicy.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/SchedulerLocalStorage.h"
@@ -500,7 +501,8 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     }
 
     void close(Promise<Unit> promise) {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Force);
+      LOG(INFO) << "Close StoryDb with write statistics " << write_batch_policy_.get_statistics();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
       promise.set_value(Unit());
@@ -508,7 +510,7 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     }
 
     void force_flush() {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Force);
       LOG(INFO) << "StoryDb flushed";
     }
 
@@ -516,42 +518,38 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     std::shared_ptr<StoryDbSyncSafeInterface> sync_db_safe_;
     StoryDbSyncInterface *sync_db_ = nullptr;
 
-    static constexpr size_t MAX_PENDING_QUERY_COUNT{50};
-    static constexpr double MAX_PENDING_QUERY_DELAY{0.01};
-
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
+    WriteBatchPolicy write_batch_policy_;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERY_COUNT) {
-        do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERY_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      if (pending_writes_.size() >= write_batch_policy_.get_max_write_count()) {
+        do_flush(WriteBatchPolicy::FlushReason::Full);
+      } else if (pending_writes_.size() == 1) {
+        set_timeout_in(write_batch_policy_.on_batch_start(Time::now_cached()));
       }
     }
     void add_read_query() {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Read);
     }
-    void do_flush() {
+    void do_flush(WriteBatchPolicy::FlushReason reason) {
       if (pending_writes_.empty()) {
         return;
       }
+      auto write_count = pending_writes_.size();
+      auto start_time = Time::now();
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
       sync_db_->commit_transaction().ensure();
+      write_batch_policy_.on_transaction(reason, write_count, start_time, Time::now());
       set_promises(finished_writes_);
       cancel_timeout();
     }
     void timeout_expired() final {
-      do_flush();
+      do_flush(WriteBatchPolicy::FlushReason::Timeout);
     }
 
     void start_up() final {
@@ -21,6 +21,8 @@
 #include "td/telegram/td_api.hpp"
 #include "td/telegram/ThemeManager.h"
 
+#include "td/actor/actor.h"
+
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -104,6 +106,8 @@ bool SynchronousRequests::is_synchronous_request(const td_api::Function *functio
     case td_api::setLogTagVerbosityLevel::ID:
     case td_api::getLogTagVerbosityLevel::ID:
     case td_api::addLogMessage::ID:
+    case td_api::enableActorProfiling::ID:
+    case td_api::getActorStatistics::ID:
     case td_api::testReturnError::ID:
       return true;
     case td_api::getOption::ID:
@@ -386,6 +390,18 @@ td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api:
   return td_api::make_object<td_api::ok>();
 }
 
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::enableActorProfiling &request) {
+  if (!(request.log_period_ >= 0.0 && request.log_period_ <= 86400.0)) {
+    return make_error(400, "Invalid log period specified");
+  }
+  Scheduler::enable_actor_profiling(request.log_period_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getActorStatistics &request) {
+  return td_api::make_object<td_api::actorStatistics>(Scheduler::get_actor_statistics());
+}
+
 td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(td_api::testReturnError &request) {
   if (request.error_ == nullptr) {
     return td_api::make_object<td_api::error>(404, "Not Found");
@@ -336,6 +336,7 @@ void Td::run_request(uint64 id, td_api::object_ptr<td_api::Function> function) {
               });
           auto use_sqlite_pmc = parameters.second.use_message_database_ || parameters.second.use_chat_info_database_ ||
                                 parameters.second.use_file_database_;
+          parameters.second.database_reader_scheduler_ids_ = G()->get_database_reader_scheduler_ids();
           return TdDb::open(use_sqlite_pmc ? G()->get_database_scheduler_id() : G()->get_slow_net_scheduler_id(),
                             std::move(parameters.second), std::move(promise));
         }
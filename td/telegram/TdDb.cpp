@@ -55,6 +55,116 @@ std::string get_sqlite_path(const TdDb::Parameters &parameters) {
   return parameters.database_directory_ + db_name + ".sqlite";
 }
 
+// each group of events is collected by a separate handler, so groups can be replayed in parallel
+enum class BinlogEventGroup : int32 {
+  SecretChatsManager,
+  Users,
+  Chats,
+  Channels,
+  SecretChats,
+  WebPages,
+  PollManager,
+  DialogManager,
+  MessageQueryManager,
+  MessagesManager,
+  StoryManager,
+  NotificationSettingsManager,
+  NotificationManager,
+  AppLog,
+  AccountManager,
+  BinlogPmc,
+  ConfigPmc,
+  Count
+};
+
+BinlogEventGroup get_binlog_event_group(int32 type) {
+  switch (type) {
+    case LogEvent::HandlerType::SecretChats:
+      return BinlogEventGroup::SecretChatsManager;
+    case LogEvent::HandlerType::Users:
+      return BinlogEventGroup::Users;
+    case LogEvent::HandlerType::Chats:
+      return BinlogEventGroup::Chats;
+    case LogEvent::HandlerType::Channels:
+      return BinlogEventGroup::Channels;
+    case LogEvent::HandlerType::SecretChatInfos:
+      return BinlogEventGroup::SecretChats;
+    case LogEvent::HandlerType::WebPages:
+      return BinlogEventGroup::WebPages;
+    case LogEvent::HandlerType::SetPollAnswer:
+    case LogEvent::HandlerType::StopPoll:
+      return BinlogEventGroup::PollManager;
+    case LogEvent::HandlerType::ReorderPinnedDialogsOnServer:
+    case LogEvent::HandlerType::ToggleDialogIsBlockedOnServer:
+    case LogEvent::HandlerType::ToggleDialogIsMarkedAsUnreadOnServer:
+    case LogEvent::HandlerType::ToggleDialogIsPinnedOnServer:
+    case LogEvent::HandlerType::ToggleDialogIsTranslatableOnServer:
+    case LogEvent::HandlerType::ToggleDialogReportSpamStateOnServer:
+    case LogEvent::HandlerType::ToggleDialogViewAsMessagesOnServer:
+      return BinlogEventGroup::DialogManager;
+    case LogEvent::HandlerType::BlockMessageSenderFromRepliesOnServer:
+    case LogEvent::HandlerType::DeleteAllCallMessagesOnServer:
+    case LogEvent::HandlerType::DeleteAllChannelMessagesFromSenderOnServer:
+    case LogEvent::HandlerType::DeleteDialogHistoryOnServer:
+    case LogEvent::HandlerType::DeleteDialogMessagesByDateOnServer:
+    case LogEvent::HandlerType::DeleteMessagesOnServer:
+    case LogEvent::HandlerType::DeleteScheduledMessagesOnServer:
+    case LogEvent::HandlerType::DeleteTopicHistoryOnServer:
+    case LogEvent::HandlerType::ReadAllDialogMentionsOnServer:
+    case LogEvent::HandlerType::ReadAllDialogReactionsOnServer:
+    case LogEvent::HandlerType::ReadMessageContentsOnServer:
+    case LogEvent::HandlerType::UnpinAllDialogMessagesOnServer:
+      return BinlogEventGroup::MessageQueryManager;
+    case LogEvent::HandlerType::SendMessage:
+    case LogEvent::HandlerType::DeleteMessage:
+    case LogEvent::HandlerType::ReadHistoryOnServer:
+    case LogEvent::HandlerType::ForwardMessages:
+    case LogEvent::HandlerType::SendBotStartMessage:
+    case LogEvent::HandlerType::SendScreenshotTakenNotificationMessage:
+    case LogEvent::HandlerType::SendInlineQueryResultMessage:
+    case LogEvent::HandlerType::SaveDialogDraftMessageOnServer:
+    case LogEvent::HandlerType::UpdateDialogNotificationSettingsOnServer:
+    case LogEvent::HandlerType::RegetDialog:
+    case LogEvent::HandlerType::GetChannelDifference:
+    case LogEvent::HandlerType::ReadHistoryInSecretChat:
+    case LogEvent::HandlerType::SetDialogFolderIdOnServer:
+    case LogEvent::HandlerType::ReadMessageThreadHistoryOnServer:
+    case LogEvent::HandlerType::SendQuickReplyShortcutMessages:
+      return BinlogEventGroup::MessagesManager;
+    case LogEvent::HandlerType::DeleteStoryOnServer:
+    case LogEvent::HandlerType::ReadStoriesOnServer:
+    case LogEvent::HandlerType::LoadDialogExpiringStories:
+    case LogEvent::HandlerType::SendStory:
+    case LogEvent::HandlerType::EditStory:
+      return BinlogEventGroup::StoryManager;
+    case LogEvent::HandlerType::ResetAllNotificationSettingsOnServer:
+    case LogEvent::HandlerType::UpdateScopeNotificationSettingsOnServer:
+    case LogEvent::HandlerType::UpdateReactionNotificationSettingsOnServer:
+      return BinlogEventGroup::NotificationSettingsManager;
+    case LogEvent::HandlerType::AddMessagePushNotification:
+    case LogEvent::HandlerType::EditMessagePushNotification:
+      return BinlogEventGroup::NotificationManager;
+    case LogEvent::HandlerType::SaveAppLog:
+      return BinlogEventGroup::AppLog;
+    case LogEvent::HandlerType::ChangeAuthorizationSettingsOnServer:
+    case LogEvent::HandlerType::InvalidateSignInCodesOnServer:
+    case LogEvent::HandlerType::ResetAuthorizationOnServer:
+    case LogEvent::HandlerType::ResetAuthorizationsOnServer:
+    case LogEvent::HandlerType::ResetWebAuthorizationOnServer:
+    case LogEvent::HandlerType::ResetWebAuthorizationsOnServer:
+    case LogEvent::HandlerType::SetAccountTtlOnServer:
+    case LogEvent::HandlerType::SetAuthorizationTtlOnServer:
+    case LogEvent::HandlerType::SetDefaultHistoryTtlOnServer:
+      return BinlogEventGroup::AccountManager;
+    case LogEvent::HandlerType::BinlogPmcMagic:
+      return BinlogEventGroup::BinlogPmc;
+    case LogEvent::HandlerType::ConfigPmcMagic:
+      return BinlogEventGroup::ConfigPmc;
+    default:
+      return BinlogEventGroup::Count;
+  }
+}
+
 Status init_binlog(Binlog &binlog, string path, BinlogKeyValue<Binlog> &binlog_pmc, BinlogKeyValue<Binlog> &config_pmc,
                    TdDb::OpenedDatabase &events, DbKey key) {
   auto r_binlog_stat = stat(path);
@@ -68,109 +178,44 @@ Status init_binlog(Binlog &binlog, string path, BinlogKeyValue<Binlog> &binlog_p
     }
   }
 
-  auto callback = [&](const BinlogEvent &event) {
-    switch (event.type_) {
-      case LogEvent::HandlerType::SecretChats:
-        events.to_secret_chats_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::Users:
-        events.user_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::Chats:
-        events.chat_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::Channels:
-        events.channel_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::SecretChatInfos:
-        events.secret_chat_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::WebPages:
-        events.web_page_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::SetPollAnswer:
-      case LogEvent::HandlerType::StopPoll:
-        events.to_poll_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::ReorderPinnedDialogsOnServer:
-      case LogEvent::HandlerType::ToggleDialogIsBlockedOnServer:
-      case LogEvent::HandlerType::ToggleDialogIsMarkedAsUnreadOnServer:
-      case LogEvent::HandlerType::ToggleDialogIsPinnedOnServer:
-      case LogEvent::HandlerType::ToggleDialogIsTranslatableOnServer:
-      case LogEvent::HandlerType::ToggleDialogReportSpamStateOnServer:
-      case LogEvent::HandlerType::ToggleDialogViewAsMessagesOnServer:
-        events.to_dialog_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::BlockMessageSenderFromRepliesOnServer:
-      case LogEvent::HandlerType::DeleteAllCallMessagesOnServer:
-      case LogEvent::HandlerType::DeleteAllChannelMessagesFromSenderOnServer:
-      case LogEvent::HandlerType::DeleteDialogHistoryOnServer:
-      case LogEvent::HandlerType::DeleteDialogMessagesByDateOnServer:
-      case LogEvent::HandlerType::DeleteMessagesOnServer:
-      case LogEvent::HandlerType::DeleteScheduledMessagesOnServer:
-      case LogEvent::HandlerType::DeleteTopicHistoryOnServer:
-      case LogEvent::HandlerType::ReadAllDialogMentionsOnServer:
-      case LogEvent::HandlerType::ReadAllDialogReactionsOnServer:
-      case LogEvent::HandlerType::ReadMessageContentsOnServer:
-      case LogEvent::HandlerType::UnpinAllDialogMessagesOnServer:
-        events.to_message_query_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::SendMessage:
-      case LogEvent::HandlerType::DeleteMessage:
-      case LogEvent::HandlerType::ReadHistoryOnServer:
-      case LogEvent::HandlerType::ForwardMessages:
-      case LogEvent::HandlerType::SendBotStartMessage:
-      case LogEvent::HandlerType::SendScreenshotTakenNotificationMessage:
-      case LogEvent::HandlerType::SendInlineQueryResultMessage:
-      case LogEvent::HandlerType::SaveDialogDraftMessageOnServer:
-      case LogEvent::HandlerType::UpdateDialogNotificationSettingsOnServer:
-      case LogEvent::HandlerType::RegetDialog:
-      case LogEvent::HandlerType::GetChannelDifference:
-      case LogEvent::HandlerType::ReadHistoryInSecretChat:
-      case LogEvent::HandlerType::SetDialogFolderIdOnServer:
-      case LogEvent::HandlerType::ReadMessageThreadHistoryOnServer:
-      case LogEvent::HandlerType::SendQuickReplyShortcutMessages:
-        events.to_messages_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::DeleteStoryOnServer:
-      case LogEvent::HandlerType::ReadStoriesOnServer:
-      case LogEvent::HandlerType::LoadDialogExpiringStories:
-      case LogEvent::HandlerType::SendStory:
-      case LogEvent::HandlerType::EditStory:
-        events.to_story_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::ResetAllNotificationSettingsOnServer:
-      case LogEvent::HandlerType::UpdateScopeNotificationSettingsOnServer:
-      case LogEvent::HandlerType::UpdateReactionNotificationSettingsOnServer:
-        events.to_notification_settings_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::AddMessagePushNotification:
-      case LogEvent::HandlerType::EditMessagePushNotification:
-        events.to_notification_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::SaveAppLog:
-        events.save_app_log_events.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::ChangeAuthorizationSettingsOnServer:
-      case LogEvent::HandlerType::InvalidateSignInCodesOnServer:
-      case LogEvent::HandlerType::ResetAuthorizationOnServer:
-      case LogEvent::HandlerType::ResetAuthorizationsOnServer:
-      case LogEvent::HandlerType::ResetWebAuthorizationOnServer:
-      case LogEvent::HandlerType::ResetWebAuthorizationsOnServer:
-      case LogEvent::HandlerType::SetAccountTtlOnServer:
-      case LogEvent::HandlerType::SetAuthorizationTtlOnServer:
-      case LogEvent::HandlerType::SetDefaultHistoryTtlOnServer:
-        events.to_account_manager.push_back(event.clone());
-        break;
-      case LogEvent::HandlerType::BinlogPmcMagic:
-        binlog_pmc.external_init_handle(event);
-        break;
-      case LogEvent::HandlerType::ConfigPmcMagic:
-        config_pmc.external_init_handle(event);
-        break;
-      default:
-        LOG(FATAL) << "Unsupported log event type " << event.type_;
-    }
+  vector<Binlog::Callback> group_callbacks(static_cast<size_t>(BinlogEventGroup::Count));
+  auto set_group_events = [&group_callbacks](BinlogEventGroup group, vector<BinlogEvent> &group_events) {
+    group_callbacks[static_cast<size_t>(group)] = [&group_events](const BinlogEvent &event) {
+      group_events.push_back(event.clone());
+    };
+  };
+  set_group_events(BinlogEventGroup::SecretChatsManager, events.to_secret_chats_manager);
+  set_group_events(BinlogEventGroup::Users, events.user_events);
+  set_group_events(BinlogEventGroup::Chats, events.chat_events);
+  set_group_events(BinlogEventGroup::Channels, events.channel_events);
+  set_group_events(BinlogEventGroup::SecretChats, events.secret_chat_events);
+  set_group_events(BinlogEventGroup::WebPages, events.web_page_events);
+  set_group_events(BinlogEventGroup::PollManager, events.to_poll_manager);
+  set_group_events(BinlogEventGroup::DialogManager, events.to_dialog_manager);
+  set_group_events(BinlogEventGroup::MessageQueryManager, events.to_message_query_manager);
+  set_group_events(BinlogEventGroup::MessagesManager, events.to_messages_manager);
+  set_group_events(BinlogEventGroup::StoryManager, events.to_story_manager);
+  set_group_events(BinlogEventGroup::NotificationSettingsManager, events.to_notification_settings_manager);
+  set_group_events(BinlogEventGroup::NotificationManager, events.to_notification_manager);
+  set_group_events(BinlogEventGroup::AppLog, events.save_app_log_events);
+  set_group_events(BinlogEventGroup::AccountManager, events.to_account_manager);
+  group_callbacks[static_cast<size_t>(BinlogEventGroup::BinlogPmc)] = [&binlog_pmc](const BinlogEvent &event) {
+    binlog_pmc.external_init_handle(event);
+  };
+  group_callbacks[static_cast<size_t>(BinlogEventGroup::ConfigPmc)] = [&config_pmc](const BinlogEvent &event) {
+    config_pmc.external_init_handle(event);
+  };
+  // most events usually belong to a few groups, like messages, users, chats and the key-value storages, so more
+  // threads don't make the replay faster; the threads are created in addition to scheduler threads and
+  // several clients can be opened simultaneously, so their number is kept small;
+  // the number is additionally limited by the number of CPUs
+  static constexpr int32 MAX_BINLOG_REPLAY_THREAD_COUNT = 4;
+  binlog.set_parallel_replay(
+      [](const BinlogEvent &event) { return static_cast<size_t>(get_binlog_event_group(event.type_)); },
+      std::move(group_callbacks), MAX_BINLOG_REPLAY_THREAD_COUNT);
+
+  auto callback = [](const BinlogEvent &event) {
+    LOG(FATAL) << "Unsupported log event type " << event.type_;
   };
 
   auto init_status = binlog.init(std::move(path), callback, std::move(key));
@@ -353,7 +398,7 @@ void TdDb::do_close(bool destroy_flag, Promise<Unit> on_finished) {
 }
 
 Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const DbKey &old_key,
-                         BinlogKeyValue<Binlog> &binlog_pmc) {
+                         BinlogKeyValue<Binlog> &binlog_pmc, bool use_message_search_index) {
   CHECK(!parameters.use_message_database_ || parameters.use_chat_info_database_);
   CHECK(!parameters.use_chat_info_database_ || parameters.use_file_database_);
 
@@ -408,6 +453,8 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
   // init MessageDb
   if (use_message_database) {
     TRY_STATUS(init_message_db(db, user_version));
+    TRY_STATUS(init_message_search_index(db, use_message_search_index));
+    TRY_STATUS(init_message_data_compression(db));
   } else {
     TRY_STATUS(drop_message_db(db, user_version));
   }
@@ -482,7 +529,7 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   if (use_message_database) {
     message_db_sync_safe_ = create_message_db_sync(sql_connection_);
-    message_db_async_ = create_message_db_async(message_db_sync_safe_);
+    message_db_async_ = create_message_db_async(message_db_sync_safe_, -1, parameters.database_reader_scheduler_ids_);
   }
 
   if (use_story_database) {
@@ -551,9 +598,13 @@ void TdDb::open_impl(Parameters parameters, Promise<OpenedDatabase> &&promise) {
       drop_sqlite_key = true;
     }
   }
+  // the search index is built or dropped offline, so the option is applied only after restart
+  bool use_message_search_index = config_pmc->get("use_message_search_index") == "Btrue";
+
   VLOG(td_init) << "Start to init database";
   auto db = make_unique<TdDb>();
-  auto init_sqlite_status = db->init_sqlite(parameters, new_sqlite_key, old_sqlite_key, *binlog_pmc);
+  auto init_sqlite_status = db->init_sqlite(parameters, new_sqlite_key, old_sqlite_key, *binlog_pmc,
+                                            use_message_search_index);
   VLOG(td_init) << "Finish to init database";
   if (init_sqlite_status.is_error()) {
     LOG(ERROR) << "Destroy bad SQLite database because of " << init_sqlite_status;
@@ -561,7 +612,8 @@ void TdDb::open_impl(Parameters parameters, Promise<OpenedDatabase> &&promise) {
       db->sql_connection_->get().close();
     }
     SqliteDb::destroy(get_sqlite_path(parameters)).ignore();
-    init_sqlite_status = db->init_sqlite(parameters, new_sqlite_key, old_sqlite_key, *binlog_pmc);
+    init_sqlite_status = db->init_sqlite(parameters, new_sqlite_key, old_sqlite_key, *binlog_pmc,
+                                         use_message_search_index);
     if (init_sqlite_status.is_error()) {
       return promise.set_error(400, init_sqlite_status.message());
     }
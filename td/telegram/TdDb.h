@@ -60,6 +60,7 @@ class TdDb {
     bool use_file_database_ = false;
     bool use_chat_info_database_ = false;
     bool use_message_database_ = false;
+    vector<int32> database_reader_scheduler_ids_;
   };
 
   struct OpenedDatabase {
@@ -191,7 +192,7 @@ class TdDb {
   static Status check_parameters(Parameters &parameters);
 
   Status init_sqlite(const Parameters &parameters, const DbKey &key, const DbKey &old_key,
-                     BinlogKeyValue<Binlog> &binlog_pmc);
+                     BinlogKeyValue<Binlog> &binlog_pmc, bool use_message_search_index);
 
   void do_close(bool destroy_flag, Promise<Unit> on_finished);
 };
@@ -1996,8 +1996,8 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
       auto difference = move_tl_object_as<telegram_api::updates_difference>(difference_ptr);
       VLOG(get_difference) << "In get difference receive " << difference->users_.size() << " users and "
                            << difference->chats_.size() << " chats";
-      td_->user_manager_->on_get_users(std::move(difference->users_), "updates.difference");
-      td_->chat_manager_->on_get_chats(std::move(difference->chats_), "updates.difference");
+      td_->user_manager_->on_get_lazy_users(std::move(difference->users_), "updates.difference");
+      td_->chat_manager_->on_get_lazy_chats(std::move(difference->chats_), "updates.difference");
 
       if (get_difference_retry_count_ <= 5) {
         for (const auto &message : difference->new_messages_) {
@@ -2032,8 +2032,8 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
 
       VLOG(get_difference) << "In get difference receive " << difference->users_.size() << " users and "
                            << difference->chats_.size() << " chats";
-      td_->user_manager_->on_get_users(std::move(difference->users_), "updates.differenceSlice");
-      td_->chat_manager_->on_get_chats(std::move(difference->chats_), "updates.differenceSlice");
+      td_->user_manager_->on_get_lazy_users(std::move(difference->users_), "updates.differenceSlice");
+      td_->chat_manager_->on_get_lazy_chats(std::move(difference->chats_), "updates.differenceSlice");
 
       if (get_difference_retry_count_ <= 5) {
         for (const auto &message : difference->new_messages_) {
@@ -2129,8 +2129,8 @@ void UpdatesManager::on_get_pts_update(int32 pts,
         return;
       }
 
-      td_->user_manager_->on_get_users(std::move(difference->users_), "on_get_pts_update");
-      td_->chat_manager_->on_get_chats(std::move(difference->chats_), "on_get_pts_update");
+      td_->user_manager_->on_get_lazy_users(std::move(difference->users_), "on_get_pts_update");
+      td_->chat_manager_->on_get_lazy_chats(std::move(difference->chats_), "on_get_pts_update");
 
       for (auto &message : difference->new_messages_) {
         difference->other_updates_.push_back(
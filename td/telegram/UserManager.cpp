@@ -87,6 +87,7 @@
 
 #include "td/utils/algorithm.h"
 #include "td/utils/buffer.h"
+#include "td/utils/crypto.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -97,6 +98,7 @@
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
+#include "td/utils/tl_parsers.h"
 #include "td/utils/utf8.h"
 
 #include <algorithm>
@@ -3171,6 +3173,33 @@ void UserManager::on_get_users(vector<telegram_api::object_ptr<telegram_api::Use
   }
 }
 
+void UserManager::on_get_lazy_users(TlLazyVector<telegram_api::User> &&users, const char *source) {
+  size_t skipped_user_count = 0;
+  for (size_t i = 0; i < users.size(); i++) {
+    auto data = users.get_raw_buffer(i);
+    auto data_hash = crc64(data.as_slice());
+    auto received_data_hash = get_received_user_data_hash(data);
+    if (received_data_hash != nullptr && *received_data_hash == data_hash) {
+      // the same user has already been applied and hasn't changed since
+      skipped_user_count++;
+      continue;
+    }
+
+    auto user = users.get(i);
+    if (user == nullptr) {
+      LOG(ERROR) << "Failed to parse a user from " << source;
+      continue;
+    }
+    on_get_user(std::move(user), source);
+
+    received_data_hash = get_received_user_data_hash(data);
+    if (received_data_hash != nullptr) {
+      *received_data_hash = data_hash;
+    }
+  }
+  LOG(DEBUG) << "Skip parsing of " << skipped_user_count << " out of " << users.size() << " users from " << source;
+}
+
 void UserManager::on_binlog_user_event(BinlogEvent &&event) {
   if (!G()->use_chat_info_database()) {
     binlog_erase(G()->td_db()->get_binlog(), event.id_);
@@ -4473,6 +4502,22 @@ UserManager::User *UserManager::add_user(UserId user_id) {
   return user_ptr.get();
 }
 
+uint64 *UserManager::get_received_user_data_hash(const BufferSlice &data) {
+  TlBufferParser parser(&data);
+  if (parser.fetch_int() != telegram_api::user::ID) {
+    return nullptr;
+  }
+  UserId user_id(telegram_api::user::fetch_id(parser));
+  if (parser.get_error() != nullptr || !user_id.is_valid()) {
+    return nullptr;
+  }
+  User *u = get_user(user_id);
+  if (u == nullptr) {
+    return nullptr;
+  }
+  return &u->received_data_hash;
+}
+
 void UserManager::save_user(User *u, UserId user_id, bool from_binlog) {
   if (!G()->use_chat_info_database()) {
     return;
@@ -9122,6 +9167,7 @@ void UserManager::update_user(User *u, UserId user_id, bool from_binlog, bool fr
   SCOPE_EXIT {
     u->is_being_updated = false;
   };
+  u->received_data_hash = 0;
 
   if (user_id == get_my_id()) {
     if (td_->option_manager_->get_option_boolean("is_premium") != u->is_premium) {
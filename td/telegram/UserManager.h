@@ -49,6 +49,7 @@
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/Hints.h"
 #include "td/utils/Promise.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
@@ -121,6 +122,8 @@ class UserManager final : public Actor {
 
   void on_get_users(vector<telegram_api::object_ptr<telegram_api::User>> &&users, const char *source);
 
+  void on_get_lazy_users(TlLazyVector<telegram_api::User> &&users, const char *source);
+
   void on_binlog_user_event(BinlogEvent &&event);
 
   void on_binlog_secret_chat_event(BinlogEvent &&event);
@@ -633,6 +636,8 @@ class UserManager final : public Actor {
 
     bool is_received_from_server = false;  // true, if the user was received from the server and not the database
 
+    uint64 received_data_hash = 0;  // hash of the last applied telegram_api::user if it hasn't changed since
+
     uint64 log_event_id = 0;
 
     template <class StorerT>
@@ -838,6 +843,8 @@ class UserManager final : public Actor {
 
   User *add_user(UserId user_id);
 
+  uint64 *get_received_user_data_hash(const BufferSlice &data);
+
   void save_user(User *u, UserId user_id, bool from_binlog);
 
   static string get_user_database_key(UserId user_id);
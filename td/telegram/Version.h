@@ -85,6 +85,7 @@ enum class DbVersion : int32 {
   StorePinnedDialogsInBinlog,
   AddMessageThreadSupport,
   AddMessageThreadDatabase,
+  AddMessageDbCompression,  // compressed message data can't be read by previous versions, so downgrade is unsupported
   Next
 };
 
@@ -8170,6 +8170,12 @@ class CliClient final : public Actor {
       } else {
         execute(std::move(request));
       }
+    } else if (op == "eap") {
+      double log_period;
+      get_args(args, log_period);
+      execute(td_api::make_object<td_api::enableActorProfiling>(log_period));
+    } else if (op == "gactst") {
+      execute(td_api::make_object<td_api::getActorStatistics>());
     } else if (op == "q") {
       quit();
     } else if (op == "dnq") {
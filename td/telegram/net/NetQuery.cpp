@@ -141,6 +141,28 @@ void NetQuery::set_error(Status status, string source) {
   set_error_impl(std::move(status), std::move(source));
 }
 
+size_t NetQuery::get_expected_traffic_size() const {
+  static constexpr int32 MAX_FILE_PART_SIZE = 1 << 20;
+
+  size_t query_size = query_.size();
+  size_t result_size = 0;
+  if (gzip_flag_ == GzipFlag::Off && query_size >= sizeof(int32)) {
+    switch (tl_constructor_) {
+      case telegram_api::upload_getFile::ID:
+      case telegram_api::upload_getWebFile::ID:
+      case telegram_api::upload_getCdnFile::ID: {
+        // the result is a file part, which maximum size is the last field of the query
+        int32 limit = as<int32>(query_.as_slice().ubegin() + query_size - sizeof(int32));
+        result_size = static_cast<size_t>(clamp(limit, 0, MAX_FILE_PART_SIZE));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return query_size + result_size;
+}
+
 void NetQuery::set_error_impl(Status status, string source) {
   VLOG(net_query) << "Receive error " << *this << " " << status;
   status_ = std::move(status);
@@ -13,6 +13,7 @@
 #include "td/actor/actor.h"
 #include "td/actor/SignalSlot.h"
 
+#include "td/utils/ArenaAllocator.h"
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
@@ -90,6 +91,9 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
     return query_;
   }
 
+  // returns the expected total size of the query and its result in bytes
+  size_t get_expected_traffic_size() const;
+
   const BufferSlice &ok() const {
     CHECK(state_ == State::OK);
     return answer_;
@@ -322,6 +326,11 @@ inline void cancel_query(NetQueryRef &ref) {
 
 template <class T>
 Result<typename T::ReturnType> fetch_result(const BufferSlice &message) {
+  // objects of big responses are allocated together; their memory is freed after all of them are destroyed
+  static constexpr size_t MIN_ARENA_RESPONSE_SIZE = 1 << 14;
+  ArenaAllocator arena;
+  ArenaAllocator::Guard arena_guard(message.size() >= MIN_ARENA_RESPONSE_SIZE ? &arena : nullptr);
+
   TlBufferParser parser(&message);
   auto result = T::fetch_result(parser);
   parser.fetch_end();
@@ -20,9 +20,27 @@ uint64 NetQueryStats::get_count() const {
   return count_.load(std::memory_order_relaxed);
 }
 
+void NetQueryStats::on_session_count_changed(int32 old_session_count, int32 new_session_count) {
+  if (new_session_count > old_session_count) {
+    session_count_increase_count_.fetch_add(1, std::memory_order_relaxed);
+  } else if (new_session_count < old_session_count) {
+    session_count_decrease_count_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    return;
+  }
+  extra_session_count_.fetch_add(new_session_count - old_session_count, std::memory_order_relaxed);
+}
+
+int64 NetQueryStats::get_extra_session_count() const {
+  return extra_session_count_.load(std::memory_order_relaxed);
+}
+
 void NetQueryStats::dump_pending_network_queries() {
   auto n = get_count();
   LOG(WARNING) << tag("pending net queries", n);
+  LOG(WARNING) << tag("extra sessions", get_extra_session_count())
+               << tag("increased", session_count_increase_count_.load(std::memory_order_relaxed))
+               << tag("decreased", session_count_decrease_count_.load(std::memory_order_relaxed));
 
   if (!use_list_) {
     return;
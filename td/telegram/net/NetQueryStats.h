@@ -38,10 +38,19 @@ class NetQueryStats {
 
   uint64 get_count() const;
 
+  // must be called whenever the number of sessions is changed because of their load
+  void on_session_count_changed(int32 old_session_count, int32 new_session_count);
+
+  // returns the total number of sessions, added because of high load
+  int64 get_extra_session_count() const;
+
   void dump_pending_network_queries();
 
  private:
   NetQueryCounter::Counter count_{0};
+  std::atomic<int64> extra_session_count_{0};
+  std::atomic<uint64> session_count_increase_count_{0};
+  std::atomic<uint64> session_count_decrease_count_{0};
   std::atomic<bool> use_list_{true};
   TsList<NetQueryDebug> list_;
 };
@@ -868,7 +868,8 @@ Status Session::on_update(BufferSlice packet) {
 }
 
 Status Session::on_message_result_ok(mtproto::MessageId message_id, BufferSlice packet, size_t original_size) {
-  last_success_timestamp_ = Time::now();
+  auto now = Time::now();
+  last_success_timestamp_ = now;
 
   TlParser parser(packet.as_slice());
   int32 response_tl_id = parser.fetch_int();
@@ -915,10 +916,40 @@ Status Session::on_message_result_ok(mtproto::MessageId message_id, BufferSlice
   query.net_query_->set_message_id(0);
   return_query(std::move(query.net_query_));
 
+  auto rtt = now - query.sent_at_;
   sent_queries_.erase(it);
+  on_query_rtt(rtt, now);
   return Status::OK();
 }
 
+void Session::on_query_rtt(double rtt, double now) {
+  if (query_rtt_ == 0) {
+    query_rtt_ = rtt;
+  } else {
+    query_rtt_ += (rtt - query_rtt_) * 0.125;
+  }
+  if (min_query_rtt_ == 0 || rtt <= min_query_rtt_ || min_query_rtt_at_ < now - MIN_QUERY_RTT_EXPIRE_TIME) {
+    min_query_rtt_ = rtt;
+    min_query_rtt_at_ = now;
+  }
+  report_load(now);
+}
+
+void Session::report_load(double now) {
+  if (query_rtt_ == 0 || now < next_load_report_at_) {
+    return;
+  }
+  next_load_report_at_ = now + LOAD_REPORT_INTERVAL;
+
+  // a stuck query delays all subsequent results as well
+  auto delay = query_rtt_;
+  if (!sent_query_list_.empty()) {
+    // the oldest query is the last in the list
+    delay = max(delay, now - Query::from_list_node(sent_query_list_.prev)->sent_at_);
+  }
+  callback_->on_load_updated(min_query_rtt_, max(delay - min_query_rtt_, 0.0));
+}
+
 void Session::on_message_result_error(mtproto::MessageId message_id, int error_code, string message) {
   if (!check_utf8(message)) {
     LOG(ERROR) << "Receive invalid error message \"" << message << '"';
@@ -1150,7 +1181,7 @@ void Session::connection_send_query(ConnectionInfo *info, NetQueryPtr &&net_quer
     net_query->debug(PSTRING() << get_name() << ": send to " << info->connection_->get_debug_str());
     message_id = info->connection_->send_query(
         net_query->query().clone(), net_query->gzip_flag() == NetQuery::GzipFlag::On, message_id,
-        invoke_after_message_ids, static_cast<bool>(net_query->quick_ack_promise_));
+        invoke_after_message_ids, static_cast<bool>(net_query->quick_ack_promise_), net_query->is_high_priority());
 
     net_query->on_net_write(net_query->query().size());
   } else {
@@ -1286,6 +1317,8 @@ void Session::connection_open_finish(ConnectionInfo *info,
     info->connection_->destroy_key();
   }
   info->connection_->set_online(connection_online_flag_, is_primary_);
+  info->connection_->set_query_packing_delay(
+      static_cast<double>(G()->get_option_integer("query_packing_delay", DEFAULT_QUERY_PACKING_DELAY)) * 1e-6);
   info->connection_->set_name(name);
   Scheduler::subscribe(info->connection_->get_poll_info().extract_pollable_fd(this));
   info->mode_ = mode_;
@@ -1514,6 +1547,7 @@ void Session::loop() {
 
   auth_loop(now);
   connection_online_update(now, false);
+  report_load(now);
 
   double wakeup_at = 0;
   main_connection_.wakeup_at_ = 0;
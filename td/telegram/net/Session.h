@@ -64,6 +64,8 @@ class Session final
     virtual void on_server_salt_updated(vector<mtproto::ServerSalt> server_salts) = 0;
     virtual void on_update(BufferSlice &&update, uint64 auth_key_id) = 0;
     virtual void on_result(NetQueryPtr net_query) = 0;
+    // rtt is the minimum recent response time, queue_delay is the time by which responses are delayed beyond it
+    virtual void on_load_updated(double rtt, double queue_delay) = 0;
   };
 
   Session(unique_ptr<Callback> callback, std::shared_ptr<AuthDataShared> shared_auth_data, int32 raw_dc_id, int32 dc_id,
@@ -131,6 +133,10 @@ class Session final
   double last_success_timestamp_ = 0;       // time when auth_key and Session definitely was valid
   double last_bind_success_timestamp_ = 0;  // time when auth_key and Session definitely was valid and authorized
   size_t dropped_size_ = 0;
+  double query_rtt_ = 0;  // smoothed time between sending of a query and receiving of its result
+  double min_query_rtt_ = 0;
+  double min_query_rtt_at_ = 0;
+  double next_load_report_at_ = 0;
 
   FlatHashSet<mtproto::MessageId, mtproto::MessageIdHash> unknown_queries_;
   vector<mtproto::MessageId> to_cancel_message_ids_;
@@ -179,6 +185,9 @@ class Session final
 
   static constexpr double ACTIVITY_TIMEOUT = 60 * 5;
   static constexpr size_t MAX_INFLIGHT_QUERIES = 1024;
+  static constexpr double LOAD_REPORT_INTERVAL = 1.0;
+  static constexpr double MIN_QUERY_RTT_EXPIRE_TIME = 60.0;
+  static constexpr int64 DEFAULT_QUERY_PACKING_DELAY = 1000;  // in microseconds
 
   struct ContainerInfo {
     size_t ref_cnt;
@@ -254,6 +263,9 @@ class Session final
   void add_query(NetQueryPtr &&net_query);
   void resend_query(NetQueryPtr query);
 
+  void on_query_rtt(double rtt, double now);
+  void report_load(double now);
+
   void connection_open(ConnectionInfo *info, double now, bool ask_info = false);
   void connection_add(unique_ptr<mtproto::RawConnection> raw_connection);
   void connection_check_mode(ConnectionInfo *info);
@@ -0,0 +1,124 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/SessionLoadBalancer.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/Random.h"
+
+namespace td {
+
+SessionLoadBalancer::SessionLoadBalancer(int32 session_count, int32 max_extra_session_count)
+    : session_count_(session_count), max_extra_session_count_(max_extra_session_count) {
+  CHECK(session_count_ > 0);
+  CHECK(max_extra_session_count_ >= 0);
+  sessions_.resize(session_count_);
+}
+
+int32 SessionLoadBalancer::get_query_count(size_t session_id) const {
+  CHECK(session_id < sessions_.size());
+  return sessions_[session_id].query_count;
+}
+
+size_t SessionLoadBalancer::get_least_loaded_session() const {
+  size_t pos = 0;
+  size_t equal_count = 1;
+  auto min_load = get_load(sessions_[pos]);
+  auto active_session_count = static_cast<size_t>(get_active_session_count());
+  for (size_t i = 1; i < active_session_count; i++) {
+    auto load = get_load(sessions_[i]);
+    if (load < min_load) {
+      pos = i;
+      min_load = load;
+      equal_count = 1;
+    } else if (load == min_load) {
+      equal_count++;
+      if (Random::fast_uint32() % equal_count == 0) {
+        pos = i;
+      }
+    }
+  }
+  return pos;
+}
+
+void SessionLoadBalancer::on_query_sent(size_t session_id, int64 traffic_size) {
+  CHECK(session_id < sessions_.size());
+  auto &session = sessions_[session_id];
+  session.query_count++;
+  session.traffic_size += traffic_size;
+}
+
+void SessionLoadBalancer::on_query_finished(size_t session_id, int64 traffic_size) {
+  CHECK(session_id < sessions_.size());
+  auto &session = sessions_[session_id];
+  CHECK(session.query_count > 0);
+  session.query_count--;
+  session.traffic_size -= traffic_size;
+  if (session.query_count == 0 || session.traffic_size < 0) {
+    // the query could have been changed after it was sent
+    session.traffic_size = 0;
+  }
+  if (session.query_count == 0 && session_id >= static_cast<size_t>(get_active_session_count())) {
+    close_idle_sessions();
+  }
+}
+
+void SessionLoadBalancer::on_load_updated(size_t session_id, double rtt, double queue_delay, double now) {
+  if (session_id >= sessions_.size()) {
+    return;
+  }
+  auto &session = sessions_[session_id];
+  session.rtt = rtt;
+  session.queue_delay = queue_delay;
+  update_extra_session_count(now);
+}
+
+int64 SessionLoadBalancer::get_load(const SessionLoad &session) {
+  return session.traffic_size + session.query_count * QUERY_TRAFFIC_OVERHEAD;
+}
+
+bool SessionLoadBalancer::is_congested(const SessionLoad &session) {
+  // results are delayed at least twice as much as they could be
+  return session.query_count >= 2 && session.queue_delay >= max(session.rtt, MIN_QUEUE_DELAY);
+}
+
+void SessionLoadBalancer::update_extra_session_count(double now) {
+  if (max_extra_session_count_ == 0 || now < next_extra_session_count_update_at_) {
+    return;
+  }
+
+  auto active_session_count = get_active_session_count();
+  int32 congested_session_count = 0;
+  int32 query_count = 0;
+  for (int32 i = 0; i < active_session_count; i++) {
+    if (is_congested(sessions_[i])) {
+      congested_session_count++;
+    }
+    query_count += sessions_[i].query_count;
+  }
+
+  if (congested_session_count == active_session_count && extra_session_count_ < max_extra_session_count_) {
+    extra_session_count_++;
+    if (sessions_.size() < static_cast<size_t>(get_active_session_count())) {
+      sessions_.emplace_back();
+    }
+  } else if (congested_session_count == 0 && extra_session_count_ > 0 && query_count + 1 < active_session_count) {
+    extra_session_count_--;
+    close_idle_sessions();
+  } else {
+    return;
+  }
+  next_extra_session_count_update_at_ = now + EXTRA_SESSION_COUNT_UPDATE_DELAY;
+}
+
+void SessionLoadBalancer::close_idle_sessions() {
+  auto active_session_count = static_cast<size_t>(get_active_session_count());
+  while (sessions_.size() > active_session_count && sessions_.back().query_count == 0) {
+    sessions_.pop_back();
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,71 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+
+// chooses sessions for new queries and decides when extra sessions must be added or removed
+class SessionLoadBalancer {
+ public:
+  static constexpr int32 MAX_EXTRA_SESSION_COUNT = 8;
+  static constexpr double EXTRA_SESSION_COUNT_UPDATE_DELAY = 5.0;
+
+  SessionLoadBalancer() = default;
+  SessionLoadBalancer(int32 session_count, int32 max_extra_session_count);
+
+  // new queries are sent only to the first get_active_session_count() sessions
+  int32 get_active_session_count() const {
+    return session_count_ + extra_session_count_;
+  }
+
+  int32 get_extra_session_count() const {
+    return extra_session_count_;
+  }
+
+  // returns the number of sessions, including inactive sessions with unfinished queries
+  size_t get_session_count() const {
+    return sessions_.size();
+  }
+
+  int32 get_query_count(size_t session_id) const;
+
+  size_t get_least_loaded_session() const;
+
+  void on_query_sent(size_t session_id, int64 traffic_size);
+
+  void on_query_finished(size_t session_id, int64 traffic_size);
+
+  void on_load_updated(size_t session_id, double rtt, double queue_delay, double now);
+
+ private:
+  struct SessionLoad {
+    int32 query_count{0};
+    int64 traffic_size{0};
+    double rtt{0};
+    double queue_delay{0};
+  };
+  int32 session_count_ = 0;
+  int32 extra_session_count_ = 0;
+  int32 max_extra_session_count_ = 0;
+  double next_extra_session_count_update_at_ = 0;
+  vector<SessionLoad> sessions_;
+
+  static constexpr int64 QUERY_TRAFFIC_OVERHEAD = 1024;
+  static constexpr double MIN_QUEUE_DELAY = 0.5;
+
+  static int64 get_load(const SessionLoad &session);
+
+  static bool is_congested(const SessionLoad &session);
+
+  void update_extra_session_count(double now);
+
+  void close_idle_sessions();
+};
+
+}  // namespace td
@@ -6,15 +6,18 @@
 //
 #include "td/telegram/net/SessionMultiProxy.h"
 
+#include "td/telegram/Global.h"
+#include "td/telegram/net/NetQueryCreator.h"
+#include "td/telegram/net/NetQueryStats.h"
 #include "td/telegram/net/SessionProxy.h"
 
 #include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
-#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -41,34 +44,22 @@ void SessionMultiProxy::send(NetQueryPtr query) {
   if (query->auth_flag() == NetQuery::AuthFlag::On) {
     size_t session_rand = query->session_rand();
     if (session_rand) {
-      pos = session_rand % sessions_.size();
+      // the session must not depend on the number of extra sessions
+      pos = session_rand % session_count_;
     } else {
-      size_t equal_count = 1;
-      int min_query_count = sessions_[pos].query_count;
-      for (size_t i = 1; i < sessions_.size(); i++) {
-        if (sessions_[i].query_count < min_query_count) {
-          pos = i;
-          min_query_count = sessions_[pos].query_count;
-          equal_count = 1;
-        } else if (sessions_[i].query_count == min_query_count) {
-          equal_count++;
-          if (Random::fast_uint32() % equal_count == 0) {
-            pos = i;
-          }
-        }
-      }
+      pos = load_balancer_.get_least_loaded_session();
     }
   }
   // query->debug(PSTRING() << get_name() << ": send to proxy #" << pos);
-  sessions_[pos].query_count++;
-  send_closure(sessions_[pos].proxy, &SessionProxy::send, std::move(query));
+  load_balancer_.on_query_sent(pos, static_cast<int64>(query->get_expected_traffic_size()));
+  send_closure(sessions_[pos], &SessionProxy::send, std::move(query));
 }
 
 void SessionMultiProxy::update_main_flag(bool is_main) {
   LOG(INFO) << "Update is_main to " << is_main;
   is_main_ = is_main;
   for (auto &session : sessions_) {
-    send_closure(session.proxy, &SessionProxy::update_main_flag, is_main);
+    send_closure(session, &SessionProxy::update_main_flag, is_main);
   }
 }
 
@@ -121,14 +112,19 @@ void SessionMultiProxy::update_options(int32 session_count, bool use_pfs, bool n
 
 void SessionMultiProxy::update_mtproto_header() {
   for (auto &session : sessions_) {
-    send_closure_later(session.proxy, &SessionProxy::update_mtproto_header);
+    send_closure_later(session, &SessionProxy::update_mtproto_header);
   }
 }
 
 void SessionMultiProxy::start_up() {
+  net_query_stats_ = &G()->net_query_creator().get_stats();
   init();
 }
 
+void SessionMultiProxy::tear_down() {
+  set_extra_session_count(0);
+}
+
 bool SessionMultiProxy::get_pfs_flag() const {
   return use_pfs_ && !is_cdn_;
 }
@@ -136,44 +132,82 @@ bool SessionMultiProxy::get_pfs_flag() const {
 void SessionMultiProxy::init() {
   sessions_generation_++;
   sessions_.clear();
+  // main sessions must use the specified number of sessions, because it affects the used auth keys
+  int32 max_extra_session_count = 0;
+  if (!is_primary_ && !need_destroy_auth_key_) {
+    max_extra_session_count = min(session_count_, SessionLoadBalancer::MAX_EXTRA_SESSION_COUNT);
+  }
+  load_balancer_ = SessionLoadBalancer(session_count_, max_extra_session_count);
   if (is_main_ && session_count_ > 1) {
     LOG(WARNING) << tag("session_count", session_count_);
   }
-  for (int32 i = 0; i < session_count_; i++) {
-    string name = PSTRING() << "Session" << get_name().substr(Slice("SessionMulti").size())
-                            << format::cond(session_count_ > 1, format::concat("#", i));
-
-    SessionInfo info;
-    class Callback final : public SessionProxy::Callback {
-     public:
-      Callback(ActorId<SessionMultiProxy> parent, uint32 generation, int32 session_id)
-          : parent_(parent), generation_(generation), session_id_(session_id) {
-      }
-      void on_query_finished() final {
-        send_closure(parent_, &SessionMultiProxy::on_query_finished, generation_, session_id_);
-      }
-
-     private:
-      ActorId<SessionMultiProxy> parent_;
-      uint32 generation_;
-      int32 session_id_;
-    };
-    info.proxy =
-        create_actor<SessionProxy>(name, make_unique<Callback>(actor_id(this), sessions_generation_, i), auth_data_,
-                                   is_primary_, is_main_, allow_media_only_, is_media_, get_pfs_flag(),
-                                   session_count_ > 1 && is_primary_, is_cdn_, need_destroy_auth_key_ && i == 0);
-    sessions_.push_back(std::move(info));
-  }
-}
-
-void SessionMultiProxy::on_query_finished(uint32 generation, int session_id) {
+  sync_sessions();
+}
+
+ActorOwn<SessionProxy> SessionMultiProxy::create_session(int32 session_id) {
+  string name = PSTRING() << "Session" << get_name().substr(Slice("SessionMulti").size())
+                          << format::cond(session_count_ > 1 || session_id > 0, format::concat("#", session_id));
+
+  class Callback final : public SessionProxy::Callback {
+   public:
+    Callback(ActorId<SessionMultiProxy> parent, uint32 generation, int32 session_id)
+        : parent_(parent), generation_(generation), session_id_(session_id) {
+    }
+    void on_query_finished(size_t traffic_size) final {
+      send_closure(parent_, &SessionMultiProxy::on_query_finished, generation_, session_id_, traffic_size);
+    }
+    void on_load_updated(double rtt, double queue_delay) final {
+      send_closure(parent_, &SessionMultiProxy::on_load_updated, generation_, session_id_, rtt, queue_delay);
+    }
+
+   private:
+    ActorId<SessionMultiProxy> parent_;
+    uint32 generation_;
+    int32 session_id_;
+  };
+  return create_actor<SessionProxy>(
+      name, make_unique<Callback>(actor_id(this), sessions_generation_, session_id), auth_data_, is_primary_, is_main_,
+      allow_media_only_, is_media_, get_pfs_flag(), session_count_ > 1 && is_primary_, is_cdn_,
+      need_destroy_auth_key_ && session_id == 0);
+}
+
+void SessionMultiProxy::set_extra_session_count(int32 extra_session_count) {
+  if (extra_session_count == extra_session_count_) {
+    return;
+  }
+  LOG(INFO) << "Change number of extra sessions from " << extra_session_count_ << " to " << extra_session_count;
+  if (net_query_stats_ != nullptr) {
+    net_query_stats_->on_session_count_changed(extra_session_count_, extra_session_count);
+  }
+  extra_session_count_ = extra_session_count;
+}
+
+void SessionMultiProxy::sync_sessions() {
+  set_extra_session_count(load_balancer_.get_extra_session_count());
+  auto session_count = load_balancer_.get_session_count();
+  while (sessions_.size() > session_count) {
+    sessions_.pop_back();
+  }
+  while (sessions_.size() < session_count) {
+    sessions_.push_back(create_session(static_cast<int32>(sessions_.size())));
+  }
+}
+
+void SessionMultiProxy::on_query_finished(uint32 generation, int32 session_id, size_t traffic_size) {
   if (generation != sessions_generation_) {
     return;
   }
   CHECK(static_cast<size_t>(session_id) < sessions_.size());
-  auto &query_count = sessions_[session_id].query_count;
-  CHECK(query_count > 0);
-  query_count--;
+  load_balancer_.on_query_finished(session_id, static_cast<int64>(traffic_size));
+  sync_sessions();
+}
+
+void SessionMultiProxy::on_load_updated(uint32 generation, int32 session_id, double rtt, double queue_delay) {
+  if (generation != sessions_generation_) {
+    return;
+  }
+  load_balancer_.on_load_updated(session_id, rtt, queue_delay, Time::now());
+  sync_sessions();
 }
 
 }  // namespace td
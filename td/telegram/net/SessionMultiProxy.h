@@ -8,6 +8,7 @@
 
 #include "td/telegram/net/AuthDataShared.h"
 #include "td/telegram/net/NetQuery.h"
+#include "td/telegram/net/SessionLoadBalancer.h"
 
 #include "td/actor/actor.h"
 
@@ -15,6 +16,7 @@
 
 namespace td {
 
+class NetQueryStats;
 class SessionProxy;
 
 class SessionMultiProxy final : public Actor {
@@ -45,19 +47,27 @@ class SessionMultiProxy final : public Actor {
   bool is_media_ = false;
   bool is_cdn_ = false;
   bool need_destroy_auth_key_ = false;
-  struct SessionInfo {
-    ActorOwn<SessionProxy> proxy;
-    int query_count{0};
-  };
   uint32 sessions_generation_{0};
-  std::vector<SessionInfo> sessions_;
+  std::vector<ActorOwn<SessionProxy>> sessions_;
+  SessionLoadBalancer load_balancer_;
+  int32 extra_session_count_ = 0;
+  NetQueryStats *net_query_stats_ = nullptr;
 
   void start_up() final;
+  void tear_down() final;
   void init();
 
+  ActorOwn<SessionProxy> create_session(int32 session_id);
+
   bool get_pfs_flag() const;
 
-  void on_query_finished(uint32 generation, int session_id);
+  void set_extra_session_count(int32 extra_session_count);
+
+  void sync_sessions();
+
+  void on_query_finished(uint32 generation, int32 session_id, size_t traffic_size);
+
+  void on_load_updated(uint32 generation, int32 session_id, double rtt, double queue_delay);
 };
 
 }  // namespace td
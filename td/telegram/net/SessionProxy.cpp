@@ -80,11 +80,15 @@ class SessionCallback final : public Session::Callback {
 
   void on_result(NetQueryPtr query) final {
     if (UniqueId::extract_type(query->id()) != UniqueId::BindKey) {
-      send_closure(parent_, &SessionProxy::on_query_finished);
+      send_closure(parent_, &SessionProxy::on_query_finished, query->get_expected_traffic_size());
     }
     G()->net_query_dispatcher().dispatch(std::move(query));
   }
 
+  void on_load_updated(double rtt, double queue_delay) final {
+    send_closure(parent_, &SessionProxy::on_load_updated, rtt, queue_delay);
+  }
+
  private:
   ActorShared<SessionProxy> parent_;
   DcId dc_id_;
@@ -147,7 +151,7 @@ void SessionProxy::start_up() {
 void SessionProxy::tear_down() {
   for (auto &query : pending_queries_) {
     query->resend();
-    callback_->on_query_finished();
+    callback_->on_query_finished(query->get_expected_traffic_size());
     G()->net_query_dispatcher().dispatch(std::move(query));
   }
   pending_queries_.clear();
@@ -280,8 +284,12 @@ void SessionProxy::on_server_salt_updated(std::vector<mtproto::ServerSalt> serve
   server_salts_ = std::move(server_salts);
 }
 
-void SessionProxy::on_query_finished() {
-  callback_->on_query_finished();
+void SessionProxy::on_query_finished(size_t traffic_size) {
+  callback_->on_query_finished(traffic_size);
+}
+
+void SessionProxy::on_load_updated(double rtt, double queue_delay) {
+  callback_->on_load_updated(rtt, queue_delay);
 }
 
 }  // namespace td
@@ -29,7 +29,8 @@ class SessionProxy final : public Actor {
   class Callback {
    public:
     virtual ~Callback() = default;
-    virtual void on_query_finished() = 0;
+    virtual void on_query_finished(size_t traffic_size) = 0;
+    virtual void on_load_updated(double rtt, double queue_delay) = 0;
   };
 
   SessionProxy(unique_ptr<Callback> callback, std::shared_ptr<AuthDataShared> shared_auth_data, bool is_primary,
@@ -69,7 +70,8 @@ class SessionProxy final : public Actor {
   void on_tmp_auth_key_updated(mtproto::AuthKey auth_key);
   void on_server_salt_updated(std::vector<mtproto::ServerSalt> server_salts);
 
-  void on_query_finished();
+  void on_query_finished(size_t traffic_size);
+  void on_load_updated(double rtt, double queue_delay);
 
   string tmp_auth_key_key() const;
 
@@ -0,0 +1,103 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_binary_client.h"
+
+#include "td/telegram/Client.h"
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_binary.h"
+
+#include "td/utils/common.h"
+#include "td/utils/port/thread_local.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
+
+#include <limits>
+#include <utility>
+
+static td::ClientManager *GetClientManager() {
+  return td::ClientManager::get_manager_singleton();
+}
+
+static td::td_api::object_ptr<td::td_api::Function> GetReturnErrorFunction(td::Slice error_message) {
+  auto error = td::td_api::make_object<td::td_api::error>(400, error_message.str());
+  return td::td_api::make_object<td::td_api::testReturnError>(std::move(error));
+}
+
+static td::td_api::object_ptr<td::td_api::Function> GetRequest(const char *request, int request_size) {
+  if (request == nullptr || request_size < 0) {
+    return GetReturnErrorFunction("Invalid request");
+  }
+  td::TlParser p(td::Slice(request, static_cast<size_t>(request_size)));
+  td::td_api::object_ptr<td::td_api::Function> function;
+  td::td_api::fetch_binary(p, function);
+  p.fetch_end();
+  if (p.get_error() != nullptr) {
+    return GetReturnErrorFunction(PSLICE() << "Failed to parse request as TDLib function: " << p.get_error());
+  }
+  if (function == nullptr) {
+    return GetReturnErrorFunction("Request is empty");
+  }
+  return function;
+}
+
+static TD_THREAD_LOCAL td::string *current_output;
+
+// responses are serialized to the per-thread output buffer, which is reused between calls
+static TdBinaryResponse StoreResponse(const td::td_api::Object &object, td::int64 request_id, int client_id) {
+  static constexpr size_t MAX_OUTPUT_BUFFER_SIZE = 1 << 22;
+
+  td::TlStorerCalcLength calc_length;
+  calc_length.store_int(object.get_id());
+  td::td_api::store_binary(calc_length, object);
+  auto length = calc_length.get_length();
+  CHECK(length <= static_cast<size_t>(std::numeric_limits<int>::max()));
+
+  td::init_thread_local<td::string>(current_output);
+  auto &output = *current_output;
+  if (output.size() < length || output.size() > td::max(MAX_OUTPUT_BUFFER_SIZE, length * 2)) {
+    output = td::string(length, '\0');
+  }
+  td::TlStorerUnsafe storer(td::MutableSlice(output).ubegin());
+  storer.store_int(object.get_id());
+  td::td_api::store_binary(storer, object);
+  CHECK(storer.get_buf() == td::MutableSlice(output).ubegin() + length);
+
+  TdBinaryResponse response;
+  response.request_id = request_id;
+  response.client_id = client_id;
+  response.data = output.data();
+  response.data_size = static_cast<int>(length);
+  return response;
+}
+
+int TdBinaryClientCreateId() {
+  return GetClientManager()->create_client_id();
+}
+
+void TdBinaryClientSend(int client_id, long long request_id, const char *request, int request_size) {
+  GetClientManager()->send(client_id, request_id, GetRequest(request, request_size));
+}
+
+TdBinaryResponse TdBinaryClientReceive(double timeout) {
+  auto response = GetClientManager()->receive(timeout);
+  if (response.object == nullptr) {
+    TdBinaryResponse empty_response;
+    empty_response.request_id = 0;
+    empty_response.client_id = response.client_id;
+    empty_response.data = nullptr;
+    empty_response.data_size = 0;
+    return empty_response;
+  }
+  return StoreResponse(*response.object, response.request_id, response.client_id);
+}
+
+TdBinaryResponse TdBinaryClientExecute(const char *request, int request_size) {
+  auto result = td::ClientManager::execute(GetRequest(request, request_size));
+  return StoreResponse(*result, 0, 0);
+}
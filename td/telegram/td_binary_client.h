@@ -0,0 +1,63 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+/**
+ * \file
+ * C interface for interaction with TDLib via TL-serialized objects.
+ * Requests are boxed td_api functions and responses are boxed td_api objects, serialized in the TL binary format
+ * with little-endian 32-bit constructor identifiers. Empty optional objects are serialized as the "null" constructor.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct TdBinaryResponse {
+  long long request_id;
+  int client_id;
+  const char *data;
+  int data_size;
+};
+
+/**
+ * Returns an opaque identifier of a new TDLib instance.
+ * The TDLib instance will not send updates until the first request is sent to it.
+ */
+int TdBinaryClientCreateId();
+
+/**
+ * Sends request to the TDLib client. May be called from any thread.
+ * \param[in] client_id TDLib client identifier.
+ * \param[in] request_id Request identifier, which will be returned with the response. Must be non-zero.
+ * \param[in] request Request serialized as a boxed td_api function. The data can be freed after the call.
+ * \param[in] request_size Size of the request in bytes.
+ */
+void TdBinaryClientSend(int client_id, long long request_id, const char *request, int request_size);
+
+/**
+ * Receives incoming updates and request responses. Must not be called simultaneously from two different threads.
+ * The returned data will be valid only until the next call to TdBinaryClientReceive or TdBinaryClientExecute
+ * from the same thread. If no response was received, data of the returned response is null.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \return Received response, or a response with data equal to null if the timeout expired.
+ */
+struct TdBinaryResponse TdBinaryClientReceive(double timeout);
+
+/**
+ * Synchronously executes a TDLib request. Only a few requests can be executed synchronously.
+ * The returned data will be valid only until the next call to TdBinaryClientReceive or TdBinaryClientExecute
+ * from the same thread.
+ * \param[in] request Request serialized as a boxed td_api function.
+ * \param[in] request_size Size of the request in bytes.
+ * \return Response with the serialized result of the request.
+ */
+struct TdBinaryResponse TdBinaryClientExecute(const char *request, int request_size);
+
+#ifdef __cplusplus
+}
+#endif
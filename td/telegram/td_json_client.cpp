@@ -43,6 +43,10 @@ const char *td_receive(double timeout) {
   return td::json_receive(timeout);
 }
 
+const char *td_receive_many(double timeout, int max_count) {
+  return td::json_receive_many(timeout, max_count);
+}
+
 const char *td_execute(const char *request) {
   return td::json_execute(td::Slice(request == nullptr ? "" : request));
 }
@@ -76,6 +76,17 @@ TDJSON_EXPORT void td_send(int client_id, const char *request);
  */
 TDJSON_EXPORT const char *td_receive(double timeout);
 
+/**
+ * Receives several incoming updates and request responses at once. Waits for new data only if there are no updates
+ * and responses to return. Must not be called simultaneously from two different threads.
+ * The returned pointer can be used until the next call to td_receive, td_receive_many or td_execute, after which it will be deallocated by TDLib.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[in] max_count The maximum number of updates and responses to return.
+ * \return JSON-serialized null-terminated array of incoming updates and request responses in the order they were received.
+ *         May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_receive_many(double timeout, int max_count);
+
 /**
  * Synchronously executes a TDLib request.
  * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -0,0 +1,138 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+/**
+ * \file
+ * Contains the declaration of a vector of TL-objects, which are parsed only on access
+ */
+
+#include "td/tl/TlObject.h"
+
+#include "td/utils/buffer.h"
+#include "td/utils/Slice.h"
+#include "td/utils/tl_parsers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace td {
+
+/**
+ * Vector of serialized TL-objects of the type T. The objects are checked for validity when the vector is fetched,
+ * but are parsed only on access, so unneeded objects don't need to be allocated.
+ */
+template <class T>
+class TlLazyVector {
+ public:
+  class Iterator {
+   public:
+    Iterator(const TlLazyVector *vector, std::size_t pos) : vector_(vector), pos_(pos) {
+    }
+
+    tl_object_ptr<T> operator*() const {
+      return vector_->get(pos_);
+    }
+
+    Iterator &operator++() {
+      pos_++;
+      return *this;
+    }
+
+    bool operator!=(const Iterator &other) const {
+      return pos_ != other.pos_;
+    }
+
+   private:
+    const TlLazyVector *vector_;
+    std::size_t pos_;
+  };
+
+  TlLazyVector() = default;
+
+  /**
+   * Creates the vector from serialized objects.
+   * \param[in] data Serialized objects.
+   * \param[in] offsets Offsets of the objects in data followed by the size of data.
+   */
+  TlLazyVector(BufferSlice data, std::vector<std::uint32_t> offsets)
+      : data_(std::move(data)), offsets_(std::move(offsets)) {
+  }
+
+  TlLazyVector(const TlLazyVector &) = delete;
+  TlLazyVector &operator=(const TlLazyVector &) = delete;
+  TlLazyVector(TlLazyVector &&) = default;
+  TlLazyVector &operator=(TlLazyVector &&) = default;
+  ~TlLazyVector() = default;
+
+  std::size_t size() const {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   * Returns serialized object with the given index.
+   */
+  Slice get_raw(std::size_t pos) const {
+    return data_.as_slice().substr(offsets_[pos], offsets_[pos + 1] - offsets_[pos]);
+  }
+
+  /**
+   * Returns serialized object with the given index, sharing memory with the vector.
+   */
+  BufferSlice get_raw_buffer(std::size_t pos) const {
+    return data_.from_slice(get_raw(pos));
+  }
+
+  /**
+   * Parses object with the given index. Returns nullptr if the object can't be parsed.
+   */
+  tl_object_ptr<T> get(std::size_t pos) const {
+    auto data = get_raw_buffer(pos);
+    TlBufferParser parser(&data);
+    auto result = T::fetch(parser);
+    parser.fetch_end();
+    if (parser.get_error() != nullptr) {
+      return nullptr;
+    }
+    return result;
+  }
+
+  /**
+   * Parses all objects.
+   */
+  std::vector<tl_object_ptr<T>> get_all() const {
+    std::vector<tl_object_ptr<T>> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); i++) {
+      auto object = get(i);
+      if (object != nullptr) {
+        result.push_back(std::move(object));
+      }
+    }
+    return result;
+  }
+
+  Iterator begin() const {
+    return Iterator(this, 0);
+  }
+
+  Iterator end() const {
+    return Iterator(this, size());
+  }
+
+ private:
+  BufferSlice data_;
+  std::vector<std::uint32_t> offsets_;
+};
+
+}  // namespace td
@@ -0,0 +1,153 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/tl/TlObject.h"
+#include "td/tl/tl_object_parse.h"
+#include "td/tl/tl_object_store.h"
+
+#include "td/utils/common.h"
+#include "td/utils/misc.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/TlDowncastHelper.h"
+
+#include <type_traits>
+
+namespace td {
+
+// any object in td_api can be empty, so objects are always stored boxed and the constructor null is used for them
+constexpr int32 TL_BINARY_ID_NULL = 0x56730bcc;
+
+// the maximum nesting level of fetched objects; the same as the maximum depth of parsed JSON
+constexpr int32 TL_BINARY_MAX_DEPTH = 100;
+
+template <class StorerT>
+void store_binary(StorerT &s, int32 x) {
+  s.store_int(x);
+}
+
+template <class StorerT>
+void store_binary(StorerT &s, int64 x) {
+  s.store_long(x);
+}
+
+template <class StorerT>
+void store_binary(StorerT &s, double x) {
+  s.store_binary(x);
+}
+
+template <class StorerT>
+void store_binary(StorerT &s, bool x) {
+  TlStoreBool::store(x, s);
+}
+
+template <class StorerT>
+void store_binary(StorerT &s, const string &x) {
+  s.store_string(x);
+}
+
+template <class StorerT, class T>
+void store_binary(StorerT &s, const tl_object_ptr<T> &object) {
+  if (object == nullptr) {
+    s.store_int(TL_BINARY_ID_NULL);
+    return;
+  }
+  s.store_int(static_cast<const TlObject &>(*object).get_id());
+  store_binary(s, *object);
+}
+
+template <class StorerT, class T>
+void store_binary(StorerT &s, const vector<T> &v) {
+  s.store_int(narrow_cast<int32>(v.size()));
+  for (const auto &x : v) {
+    store_binary(s, x);
+  }
+}
+
+inline void fetch_binary(TlParser &p, int32 &to, int32 max_depth) {
+  to = p.fetch_int();
+}
+
+inline void fetch_binary(TlParser &p, int64 &to, int32 max_depth) {
+  to = p.fetch_long();
+}
+
+inline void fetch_binary(TlParser &p, double &to, int32 max_depth) {
+  to = p.fetch_double();
+}
+
+inline void fetch_binary(TlParser &p, bool &to, int32 max_depth) {
+  to = TlFetchBool::parse(p);
+}
+
+inline void fetch_binary(TlParser &p, string &to, int32 max_depth) {
+  to = p.fetch_string<string>();
+}
+
+template <class T>
+std::enable_if_t<!std::is_constructible<T>::value> fetch_binary(TlParser &p, tl_object_ptr<T> &to,
+                                                               int32 max_depth) {
+  if (max_depth <= 0) {
+    p.set_error("Too big object depth");
+    to = nullptr;
+    return;
+  }
+  auto constructor = p.fetch_int();
+  if (constructor == TL_BINARY_ID_NULL || p.get_error() != nullptr) {
+    to = nullptr;
+    return;
+  }
+
+  TlDowncastHelper<T> helper(constructor);
+  bool ok = downcast_call(static_cast<T &>(helper), [&](auto &dummy) {
+    auto result = make_tl_object<std::decay_t<decltype(dummy)>>();
+    fetch_binary(p, *result, max_depth - 1);
+    to = std::move(result);
+  });
+  if (!ok) {
+    p.set_error("Unknown constructor found");
+  }
+}
+
+template <class T>
+std::enable_if_t<std::is_constructible<T>::value> fetch_binary(TlParser &p, tl_object_ptr<T> &to,
+                                                              int32 max_depth) {
+  if (max_depth <= 0) {
+    p.set_error("Too big object depth");
+    to = nullptr;
+    return;
+  }
+  auto constructor = p.fetch_int();
+  if (constructor == TL_BINARY_ID_NULL || p.get_error() != nullptr) {
+    to = nullptr;
+    return;
+  }
+  if (constructor != T::ID) {
+    p.set_error("Wrong constructor found");
+    return;
+  }
+  to = make_tl_object<T>();
+  fetch_binary(p, *to, max_depth - 1);
+}
+
+template <class T>
+void fetch_binary(TlParser &p, vector<T> &to, int32 max_depth) {
+  const uint32 multiplicity = p.fetch_int();
+  to.clear();
+  if (p.get_left_len() < multiplicity) {
+    p.set_error("Wrong vector length");
+    return;
+  }
+  to.reserve(multiplicity);
+  for (uint32 i = 0; i < multiplicity && p.get_error() == nullptr; i++) {
+    T value{};
+    fetch_binary(p, value, max_depth);
+    to.push_back(std::move(value));
+  }
+}
+
+}  // namespace td
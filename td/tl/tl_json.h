@@ -16,6 +16,7 @@
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
 #include "td/utils/TlDowncastHelper.h"
 
 #include <type_traits>
@@ -58,6 +59,60 @@ void to_json(JsonValueScope &jv, const vector<T> &v) {
   }
 }
 
+inline void store_json(StringBuilder &sb, int32 value) {
+  sb << value;
+}
+
+inline void store_json(StringBuilder &sb, int64 value) {
+  sb << value;
+}
+
+inline void store_json(StringBuilder &sb, double value) {
+  sb << JsonFloat(value);
+}
+
+inline void store_json(StringBuilder &sb, const string &value) {
+  sb << JsonString(value);
+}
+
+inline void store_json(StringBuilder &sb, const JsonVectorInt64 &vec) {
+  sb << '[';
+  bool is_first = true;
+  for (auto &value : vec.value) {
+    if (is_first) {
+      is_first = false;
+    } else {
+      sb << ',';
+    }
+    sb << '"' << value << '"';
+  }
+  sb << ']';
+}
+
+template <class T>
+void store_json(StringBuilder &sb, const tl_object_ptr<T> &value) {
+  if (value) {
+    store_json(sb, *value);
+  } else {
+    sb << JsonNull();
+  }
+}
+
+template <class T>
+void store_json(StringBuilder &sb, const vector<T> &v) {
+  sb << '[';
+  bool is_first = true;
+  for (auto &value : v) {
+    if (is_first) {
+      is_first = false;
+    } else {
+      sb << ',';
+    }
+    store_json(sb, value);
+  }
+  sb << ']';
+}
+
 inline Status from_json(int32 &to, JsonValue from) {
   if (from.type() != JsonValue::Type::Number && from.type() != JsonValue::Type::String) {
     if (from.type() == JsonValue::Type::Null) {
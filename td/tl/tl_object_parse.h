@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/tl/TlLazyVector.h"
 #include "td/tl/TlObject.h"
 
 #include "td/utils/SliceBuilder.h"
@@ -13,6 +14,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace td {
@@ -30,6 +32,17 @@ class TlFetchBoxed {
     }
     return Func::parse(parser);
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    auto parsed_constructor_id = parser.fetch_int();
+    if (parsed_constructor_id != constructor_id) {
+      parser.set_error(PSTRING() << "Wrong constructor " << parsed_constructor_id << " found instead of "
+                                 << constructor_id);
+      return;
+    }
+    Func::skip(parser);
+  }
 };
 
 class TlFetchBool {
@@ -48,6 +61,11 @@ class TlFetchBool {
     }
     return false;
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parse(parser);
+  }
 };
 
 class TlFetchInt {
@@ -56,6 +74,11 @@ class TlFetchInt {
   static std::int32_t parse(ParserT &parser) {
     return parser.fetch_int();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.fetch_int();
+  }
 };
 
 class TlFetchLong {
@@ -64,6 +87,11 @@ class TlFetchLong {
   static std::int64_t parse(ParserT &parser) {
     return parser.fetch_long();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.fetch_long();
+  }
 };
 
 class TlFetchDouble {
@@ -72,6 +100,11 @@ class TlFetchDouble {
   static double parse(ParserT &parser) {
     return parser.fetch_double();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.fetch_double();
+  }
 };
 
 class TlFetchInt128 {
@@ -80,6 +113,11 @@ class TlFetchInt128 {
   static UInt128 parse(ParserT &parser) {
     return parser.template fetch_binary<UInt128>();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.template fetch_binary<UInt128>();
+  }
 };
 
 class TlFetchInt256 {
@@ -88,6 +126,11 @@ class TlFetchInt256 {
   static UInt256 parse(ParserT &parser) {
     return parser.template fetch_binary<UInt256>();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.template fetch_binary<UInt256>();
+  }
 };
 
 class TlFetchInt512 {
@@ -96,6 +139,11 @@ class TlFetchInt512 {
   static UInt512 parse(ParserT &parser) {
     return parser.template fetch_binary<UInt512>();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.template fetch_binary<UInt512>();
+  }
 };
 
 template <class T>
@@ -105,6 +153,11 @@ class TlFetchString {
   static T parse(ParserT &parser) {
     return parser.template fetch_string<T>();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.skip_string();
+  }
 };
 
 template <class T>
@@ -114,6 +167,11 @@ class TlFetchBytes {
   static T parse(ParserT &parser) {
     return parser.template fetch_string<T>();
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    parser.skip_string();
+  }
 };
 
 template <class Func>
@@ -133,6 +191,18 @@ class TlFetchVector {
     }
     return v;
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    const std::uint32_t multiplicity = parser.fetch_int();
+    if (parser.get_left_len() < multiplicity) {
+      parser.set_error("Wrong vector length");
+      return;
+    }
+    for (std::uint32_t i = 0; i < multiplicity && parser.get_error() == nullptr; i++) {
+      Func::skip(parser);
+    }
+  }
 };
 
 template <class T>
@@ -142,6 +212,42 @@ class TlFetchObject {
   static tl_object_ptr<T> parse(ParserT &parser) {
     return T::fetch(parser);
   }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    T::skip(parser);
+  }
+};
+
+// elements are only checked for validity and are parsed on access
+template <class T>
+class TlFetchLazyVector {
+ public:
+  template <class ParserT>
+  static TlLazyVector<T> parse(ParserT &parser) {
+    const std::uint32_t multiplicity = parser.fetch_int();
+    if (parser.get_left_len() < multiplicity) {
+      parser.set_error("Wrong vector length");
+      return TlLazyVector<T>();
+    }
+    auto begin_left_len = parser.get_left_len();
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(multiplicity + 1);
+    for (std::uint32_t i = 0; i < multiplicity && parser.get_error() == nullptr; i++) {
+      offsets.push_back(static_cast<std::uint32_t>(begin_left_len - parser.get_left_len()));
+      T::skip(parser);
+    }
+    if (parser.get_error() != nullptr) {
+      return TlLazyVector<T>();
+    }
+    offsets.push_back(static_cast<std::uint32_t>(begin_left_len - parser.get_left_len()));
+    return TlLazyVector<T>(parser.get_fetched_buffer_slice(begin_left_len), std::move(offsets));
+  }
+
+  template <class ParserT>
+  static void skip(ParserT &parser) {
+    TlFetchVector<TlFetchObject<T>>::skip(parser);
+  }
 };
 
 }  // namespace td
@@ -62,6 +62,21 @@ ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 t
   state_ = State::Start;
 }
 
+void ConcurrentScheduler::enable_work_stealing() {
+  CHECK(state_ == State::Start);
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  // the extra scheduler never runs actors, so it can't take part in work stealing
+  auto sched_count = static_cast<int32>(schedulers_.size()) - extra_scheduler_;
+  if (sched_count <= 1) {
+    return;
+  }
+  auto group = std::make_shared<Scheduler::WorkStealingGroup>(sched_count);
+  for (int32 i = 0; i < sched_count; i++) {
+    schedulers_[i]->enable_work_stealing(group);
+  }
+#endif
+}
+
 void ConcurrentScheduler::test_one_thread_run() {
   do {
     for (auto &sched : schedulers_) {
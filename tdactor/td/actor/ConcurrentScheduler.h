@@ -44,6 +44,9 @@ class ConcurrentScheduler final : private Scheduler::Callback {
     return schedulers_.back()->get_const_guard();
   }
 
+  // allows idle schedulers to steal ready stealable actors from busy schedulers; must be called before start()
+  void enable_work_stealing();
+
   void test_one_thread_run();
 
   bool is_finished() const {
@@ -22,6 +22,7 @@ namespace td {
 class Actor : public ObserverBase {
  public:
   using Deleter = ActorInfo::Deleter;
+  using MailboxOverflowPolicy = ActorInfo::MailboxOverflowPolicy;
   Actor() = default;
   Actor(const Actor &) = delete;
   Actor &operator=(const Actor &) = delete;
@@ -61,6 +62,10 @@ class Actor : public ObserverBase {
   virtual void on_finish_migrate() {
   }
 
+  // called before processing of the mailbox if it has overflowed with MailboxOverflowPolicy::Notify
+  virtual void on_mailbox_overflow() {
+  }
+
   void notify() override;
 
   // proxy to scheduler
@@ -75,6 +80,14 @@ class Actor : public ObserverBase {
   void migrate(int32 sched_id);
   void do_migrate(int32 sched_id);
 
+  // allows the scheduler to migrate the actor to an idle scheduler if work stealing is enabled
+  // the actor must not depend on the scheduler it runs on, for example it must not subscribe to any file descriptors
+  void set_stealable(bool is_stealable);
+
+  // limits the number of events pending in the mailbox; 0 means no limit
+  void set_mailbox_capacity(size_t capacity, MailboxOverflowPolicy policy);
+  uint64 get_mailbox_overflow_count() const;
+
   uint64 get_link_token();
   std::weak_ptr<ActorContext> get_context_weak_ptr() const;
   std::shared_ptr<ActorContext> set_context(std::shared_ptr<ActorContext> context);
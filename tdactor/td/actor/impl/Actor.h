@@ -72,6 +72,15 @@ inline void Actor::migrate(int32 sched_id) {
 inline void Actor::do_migrate(int32 sched_id) {
   Scheduler::instance()->do_migrate_actor(this, sched_id);
 }
+inline void Actor::set_stealable(bool is_stealable) {
+  info_->set_stealable(is_stealable);
+}
+inline void Actor::set_mailbox_capacity(size_t capacity, MailboxOverflowPolicy policy) {
+  info_->set_mailbox_capacity(capacity, policy);
+}
+inline uint64 Actor::get_mailbox_overflow_count() const {
+  return info_->get_mailbox_overflow_count();
+}
 
 template <class ActorType>
 std::enable_if_t<std::is_base_of<Actor, ActorType>::value> start_migrate(ActorType &obj, int32 sched_id) {
@@ -17,6 +17,7 @@
 #include "td/utils/StringBuilder.h"
 
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -47,12 +48,28 @@ class ActorContext {
   std::weak_ptr<ActorContext> this_ptr_;
 };
 
+// runtime statistics of all actors with the same name, which are run by one scheduler
+struct ActorProfile {
+  string name;
+  uint64 event_count = 0;
+  double total_time = 0.0;
+  double max_event_time = 0.0;
+  size_t max_mailbox_size = 0;
+  uint64 mailbox_overflow_count = 0;
+};
+
 class ActorInfo final
     : private ListNode
     , private HeapNode {
  public:
   enum class Deleter : uint8 { Destroy, None };
 
+  // what to do with a new event if the mailbox is full; applied only to custom and raw events
+  // Reject - drop the event
+  // Coalesce - replace a pending event calling the same actor method; add the event if there is none
+  // Notify - add the event and call Actor::on_mailbox_overflow before the next event is processed
+  enum class MailboxOverflowPolicy : uint8 { Reject, Coalesce, Notify };
+
   ActorInfo() = default;
   ~ActorInfo() = default;
 
@@ -108,14 +125,34 @@ class ActorInfo final
   bool need_context() const;
   bool need_start_up() const;
 
+  void set_stealable(bool is_stealable);
+  bool is_stealable() const;
+
+  void set_profile(ActorProfile *profile);
+  ActorProfile *get_profile() const;
+
+  void set_mailbox_capacity(size_t capacity, MailboxOverflowPolicy policy);
+  size_t get_mailbox_capacity() const;
+  MailboxOverflowPolicy get_mailbox_overflow_policy() const;
+  void on_mailbox_overflow();
+  uint64 get_mailbox_overflow_count() const;
+  bool need_notify_mailbox_overflow() const;
+  void set_need_notify_mailbox_overflow(bool need_notify);
+
  private:
   Deleter deleter_ = Deleter::None;
   bool need_context_ = true;
   bool need_start_up_ = true;
   bool is_running_ = false;
+  bool is_stealable_ = false;
+  bool need_notify_mailbox_overflow_ = false;
+  MailboxOverflowPolicy mailbox_overflow_policy_ = MailboxOverflowPolicy::Reject;
 
   std::atomic<int32> sched_id_{0};
   Actor *actor_ = nullptr;
+  ActorProfile *profile_ = nullptr;
+  size_t mailbox_capacity_ = std::numeric_limits<size_t>::max();
+  uint64 mailbox_overflow_count_ = 0;
 
 #ifdef TD_DEBUG
   string name_;
@@ -19,6 +19,7 @@
 #include "td/utils/StringBuilder.h"
 
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -50,6 +51,12 @@ inline void ActorInfo::init(int32 sched_id, Slice name, ObjectPool<ActorInfo>::O
   need_context_ = need_context;
   need_start_up_ = need_start_up;
   is_running_ = false;
+  is_stealable_ = false;
+  profile_ = nullptr;
+  mailbox_capacity_ = std::numeric_limits<size_t>::max();
+  mailbox_overflow_policy_ = MailboxOverflowPolicy::Reject;
+  mailbox_overflow_count_ = 0;
+  need_notify_mailbox_overflow_ = false;
 }
 
 inline bool ActorInfo::need_context() const {
@@ -60,6 +67,54 @@ inline bool ActorInfo::need_start_up() const {
   return need_start_up_;
 }
 
+inline void ActorInfo::set_stealable(bool is_stealable) {
+  is_stealable_ = is_stealable;
+}
+
+inline bool ActorInfo::is_stealable() const {
+  return is_stealable_;
+}
+
+inline void ActorInfo::set_profile(ActorProfile *profile) {
+  profile_ = profile;
+}
+
+inline ActorProfile *ActorInfo::get_profile() const {
+  return profile_;
+}
+
+inline void ActorInfo::set_mailbox_capacity(size_t capacity, MailboxOverflowPolicy policy) {
+  mailbox_capacity_ = capacity == 0 ? std::numeric_limits<size_t>::max() : capacity;
+  mailbox_overflow_policy_ = policy;
+}
+
+inline size_t ActorInfo::get_mailbox_capacity() const {
+  return mailbox_capacity_;
+}
+
+inline ActorInfo::MailboxOverflowPolicy ActorInfo::get_mailbox_overflow_policy() const {
+  return mailbox_overflow_policy_;
+}
+
+inline void ActorInfo::on_mailbox_overflow() {
+  mailbox_overflow_count_++;
+  if (profile_ != nullptr) {
+    profile_->mailbox_overflow_count++;
+  }
+}
+
+inline uint64 ActorInfo::get_mailbox_overflow_count() const {
+  return mailbox_overflow_count_;
+}
+
+inline bool ActorInfo::need_notify_mailbox_overflow() const {
+  return need_notify_mailbox_overflow_;
+}
+
+inline void ActorInfo::set_need_notify_mailbox_overflow(bool need_notify) {
+  need_notify_mailbox_overflow_ = need_notify;
+}
+
 inline void ActorInfo::on_actor_moved(Actor *actor_new_ptr) {
   actor_ = actor_new_ptr;
 }
@@ -52,6 +52,16 @@ class CustomEvent {
   }
   virtual void finish_migrate() {
   }
+
+  // returns true if both events call the same actor method, so the older of them can be replaced with the newer one
+  virtual bool is_same_call(const CustomEvent &other) const {
+    return false;
+  }
+
+  // unique for every event type
+  virtual const void *get_type_tag() const {
+    return nullptr;
+  }
 };
 
 template <class ClosureT>
@@ -78,6 +88,16 @@ class ClosureEvent final : public CustomEvent {
     });
   }
 
+  bool is_same_call(const CustomEvent &other) const final {
+    return other.get_type_tag() == get_type_tag() &&
+           closure_.has_same_function(static_cast<const ClosureEvent &>(other).closure_);
+  }
+
+  const void *get_type_tag() const final {
+    static const char type_tag = 0;
+    return &type_tag;
+  }
+
  private:
   ClosureT closure_;
 };
@@ -28,6 +28,7 @@
 #include "td/utils/Time.h"
 #include "td/utils/type_traits.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -69,6 +70,24 @@ class Scheduler {
     virtual void on_finish() = 0;
     virtual void register_at_finish(std::function<void()>) = 0;
   };
+
+  // state shared between schedulers, which are allowed to steal actors from each other
+  class WorkStealingGroup {
+   public:
+    explicit WorkStealingGroup(int32 sched_count) : slots_(static_cast<size_t>(sched_count)) {
+    }
+
+   private:
+    struct Slot {
+      std::atomic<int32> stealable_actor_count{0};
+      std::atomic<int32> thief_sched_id{-1};
+      std::atomic<bool> is_idle{false};
+    };
+    vector<Slot> slots_;
+
+    friend class Scheduler;
+  };
+
   Scheduler() = default;
   Scheduler(const Scheduler &) = delete;
   Scheduler &operator=(const Scheduler &) = delete;
@@ -81,6 +100,19 @@ class Scheduler {
   int32 sched_id() const;
   int32 sched_count() const;
 
+  void enable_work_stealing(std::shared_ptr<WorkStealingGroup> group);
+
+  // enables collection of runtime statistics for all actors created after the call in the process;
+  // if log_period is positive, the statistics are written to the log every log_period seconds
+  static void enable_actor_profiling(double log_period);
+
+  // disables collection of runtime statistics for actors created after the call and periodic statistics logging;
+  // already collected statistics are kept
+  static void disable_actor_profiling();
+
+  // returns statistics collected by all schedulers; they are published by a scheduler at most once per second
+  static string get_actor_statistics();
+
   template <class ActorT, class... Args>
   TD_WARN_UNUSED_RESULT ActorOwn<ActorT> create_actor(Slice name, Args &&...args);
   template <class ActorT, class... Args>
@@ -200,6 +232,7 @@ class Scheduler {
 
   void register_migrated_actor(ActorInfo *actor_info);
   void add_to_mailbox(ActorInfo *actor_info, Event &&event);
+  bool add_to_full_mailbox(ActorInfo *actor_info, Event &event);
   void clear_mailbox(ActorInfo *actor_info);
 
   void flush_mailbox(ActorInfo *actor_info);
@@ -212,8 +245,19 @@ class Scheduler {
 
   void send_later_impl(const ActorId<> &actor_id, Event &&event);
 
+  void flush_outbound_batches();
+
+  void init_actor_profile(ActorInfo *actor_info, Slice name);
+  ActorProfile *get_actor_profile(Slice name);
+  void publish_actor_profiles();
+
   Timestamp run_timeout();
   void run_mailbox();
+  bool need_delay_event(const ActorId<> &actor_id) const;
+  void publish_ready_actors(const ListNode &ready_actors);
+  void give_actor_to_thief(ListNode &ready_actors);
+  void withdraw_steal_request();
+  void try_steal_actor();
   Timestamp run_events(Timestamp timeout);
   void run_poll(Timestamp timeout);
 
@@ -245,6 +289,16 @@ class Scheduler {
   int32 sched_n_ = 0;
   std::shared_ptr<MpscPollableQueue<EventFull>> inbound_queue_;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound_queues_;
+  std::vector<std::vector<EventFull>> outbound_batches_;
+  bool batch_outbound_events_ = false;
+
+  static constexpr int32 WORK_STEALING_MIN_STEALABLE_ACTOR_COUNT = 2;
+  std::shared_ptr<WorkStealingGroup> work_stealing_group_;
+  int32 steal_victim_sched_id_ = -1;
+
+  static constexpr double ACTOR_PROFILES_PUBLISH_PERIOD = 1.0;
+  FlatHashMap<string, unique_ptr<ActorProfile>> actor_profiles_;
+  double next_actor_profiles_publish_time_ = 0.0;
 
   std::shared_ptr<ActorContext> save_context_;
 
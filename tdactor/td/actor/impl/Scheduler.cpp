@@ -25,10 +25,15 @@
 #include "td/utils/Promise.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/StackAllocator.h"
+#include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 namespace td {
@@ -96,7 +101,11 @@ void Scheduler::ServiceActor::loop() {
     } else {
       VLOG(actor) << "Receive " << event.data();
       finish_migrate(event.data());
-      event.try_emit();
+      if (Scheduler::instance()->need_delay_event(event.actor_id())) {
+        event.try_emit_later();
+      } else {
+        event.try_emit();
+      }
     }
   }
   queue->reader_flush();
@@ -160,6 +169,10 @@ EventGuard::EventGuard(Scheduler *scheduler, ActorInfo *actor_info) : scheduler_
   save_log_tag2_ = actor_info->get_name().c_str();
 #endif
   swap_context(actor_info);
+
+  if (actor_info->get_profile() != nullptr) {
+    start_time_ = Time::now();
+  }
 }
 
 EventGuard::~EventGuard() {
@@ -179,6 +192,17 @@ EventGuard::~EventGuard() {
       << info->need_context() << " " << info->empty() << " " << info->is_migrating() << " " << save_log_tag2_ << " "
       << info->get_name() << " " << scheduler_->close_flag_;
 #endif
+  auto profile = info->get_profile();
+  if (profile != nullptr) {
+    auto elapsed_time = Time::now() - start_time_;
+    profile->event_count += event_count_;
+    profile->total_time += elapsed_time;
+    // if times of separate events weren't reported, then the guard was used for a single event
+    auto max_event_time = max_event_time_ < 0.0 ? elapsed_time : max_event_time_;
+    if (max_event_time > profile->max_event_time) {
+      profile->max_event_time = max_event_time;
+    }
+  }
   if (event_context_.flags & Scheduler::EventContext::Stop) {
     scheduler_->do_stop_actor(info);
     return;
@@ -229,10 +253,17 @@ void Scheduler::init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<Eve
   outbound_queues_ = std::move(outbound);
   sched_id_ = id;
   sched_n_ = static_cast<int32>(outbound_queues_.size());
+  outbound_batches_.resize(outbound_queues_.size());
   service_actor_.set_queue(inbound_queue_);
   register_actor(PSLICE() << "ServiceActor" << id, &service_actor_).release();
 }
 
+void Scheduler::enable_work_stealing(std::shared_ptr<WorkStealingGroup> group) {
+  CHECK(group != nullptr);
+  CHECK(0 <= sched_id_ && static_cast<size_t>(sched_id_) < group->slots_.size());
+  work_stealing_group_ = std::move(group);
+}
+
 void Scheduler::clear() {
   if (service_actor_.empty()) {
     return;
@@ -244,6 +275,16 @@ void Scheduler::clear() {
   if (!service_actor_.empty()) {
     service_actor_.do_stop();
   }
+  // actors, which were migrated to the scheduler after its last run, must be stopped too
+  if (inbound_queue_) {
+    while (inbound_queue_->reader_wait_nonblock() > 0) {
+      EventFull event = inbound_queue_->reader_get_unsafe();
+      if (event.actor_id().empty() && !event.data().empty()) {
+        register_migrated_actor(static_cast<ActorInfo *>(event.data().data.ptr));
+      }
+    }
+    inbound_queue_->reader_flush();
+  }
   while (!pending_actors_.empty()) {
     auto actor_info = ActorInfo::from_list_node(pending_actors_.get());
     do_stop_actor(actor_info);
@@ -254,6 +295,10 @@ void Scheduler::clear() {
   }
   poll_.clear();
 
+  if (!ExitGuard::is_exited()) {
+    publish_actor_profiles();
+  }
+
   if (callback_ && !ExitGuard::is_exited()) {
     // can't move lambda with unique_ptr inside into std::function
     auto ptr = actor_info_pool_.release();
@@ -341,6 +386,10 @@ void Scheduler::register_migrated_actor(ActorInfo *actor_info) {
   for (auto &event : actor_info->mailbox_) {
     finish_migrate(event);
   }
+  if (actor_info->get_profile() != nullptr) {
+    // the name is owned by the previous scheduler and is never changed
+    actor_info->set_profile(get_actor_profile(actor_info->get_profile()->name));
+  }
   auto it = pending_events_.find(actor_info);
   if (it != pending_events_.end()) {
     append(actor_info->mailbox_, std::move(it->second));
@@ -363,8 +412,143 @@ void Scheduler::send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_i
       VLOG(actor) << "Send to scheduler " << sched_id << ": " << event;
     }
     start_migrate(event, sched_id);
-    outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
-    outbound_queues_[sched_id]->writer_flush();
+    if (batch_outbound_events_) {
+      outbound_batches_[sched_id].push_back(EventCreator::event_unsafe(actor_id, std::move(event)));
+    } else {
+      outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
+      outbound_queues_[sched_id]->writer_flush();
+    }
+  }
+}
+
+void Scheduler::flush_outbound_batches() {
+  for (size_t i = 0; i < outbound_batches_.size(); i++) {
+    auto &batch = outbound_batches_[i];
+    if (!batch.empty()) {
+      VLOG(actor) << "Send " << batch.size() << " events to scheduler " << i;
+      outbound_queues_[i]->writer_put_batch(batch);
+    }
+  }
+}
+
+namespace {
+
+struct ActorProfiler {
+  std::atomic<bool> is_enabled{false};
+
+  std::mutex mutex;
+  double log_period = 0.0;
+  double next_log_time = 0.0;
+  FlatHashMap<string, ActorProfile> profiles;
+};
+
+ActorProfiler &get_actor_profiler() {
+  static ActorProfiler profiler;
+  return profiler;
+}
+
+string get_actor_profiles_statistics(const FlatHashMap<string, ActorProfile> &profiles) {
+  vector<const ActorProfile *> sorted_profiles;
+  sorted_profiles.reserve(profiles.size());
+  for (auto &it : profiles) {
+    sorted_profiles.push_back(&it.second);
+  }
+  std::sort(sorted_profiles.begin(), sorted_profiles.end(),
+            [](const ActorProfile *lhs, const ActorProfile *rhs) { return lhs->total_time > rhs->total_time; });
+
+  auto buf = StackAllocator::alloc(1 << 14);
+  StringBuilder sb(buf.as_slice(), true);
+  for (auto profile : sorted_profiles) {
+    sb << profile->name << ": " << profile->event_count << " events in " << format::as_time(profile->total_time)
+       << ", max event time " << format::as_time(profile->max_event_time) << ", max mailbox size "
+       << profile->max_mailbox_size;
+    if (profile->mailbox_overflow_count != 0) {
+      sb << ", " << profile->mailbox_overflow_count << " mailbox overflows";
+    }
+    sb << '\n';
+  }
+  return sb.as_cslice().str();
+}
+
+}  // namespace
+
+void Scheduler::enable_actor_profiling(double log_period) {
+  auto &profiler = get_actor_profiler();
+  {
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+    profiler.log_period = log_period;
+    profiler.next_log_time = Time::now() + log_period;
+  }
+  profiler.is_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Scheduler::disable_actor_profiling() {
+  auto &profiler = get_actor_profiler();
+  profiler.is_enabled.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(profiler.mutex);
+  profiler.log_period = 0.0;
+}
+
+string Scheduler::get_actor_statistics() {
+  auto &profiler = get_actor_profiler();
+  std::lock_guard<std::mutex> lock(profiler.mutex);
+  return get_actor_profiles_statistics(profiler.profiles);
+}
+
+void Scheduler::init_actor_profile(ActorInfo *actor_info, Slice name) {
+  if (get_actor_profiler().is_enabled.load(std::memory_order_relaxed)) {
+    actor_info->set_profile(get_actor_profile(name));
+  }
+}
+
+ActorProfile *Scheduler::get_actor_profile(Slice name) {
+  auto &profile = actor_profiles_[name.str()];
+  if (profile == nullptr) {
+    profile = make_unique<ActorProfile>();
+    profile->name = name.str();
+  }
+  return profile.get();
+}
+
+void Scheduler::publish_actor_profiles() {
+  if (actor_profiles_.empty()) {
+    return;
+  }
+  next_actor_profiles_publish_time_ = Time::now() + ACTOR_PROFILES_PUBLISH_PERIOD;
+
+  auto &profiler = get_actor_profiler();
+  string statistics;
+  {
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+    for (auto &it : actor_profiles_) {
+      auto &local_profile = *it.second;
+      if (local_profile.event_count == 0 && local_profile.max_mailbox_size == 0 &&
+          local_profile.mailbox_overflow_count == 0) {
+        continue;
+      }
+      auto &profile = profiler.profiles[it.first];
+      profile.name = it.first;
+      profile.event_count += local_profile.event_count;
+      profile.total_time += local_profile.total_time;
+      profile.max_event_time = max(profile.max_event_time, local_profile.max_event_time);
+      profile.max_mailbox_size = max(profile.max_mailbox_size, local_profile.max_mailbox_size);
+      profile.mailbox_overflow_count += local_profile.mailbox_overflow_count;
+
+      // only the difference is published next time
+      local_profile.event_count = 0;
+      local_profile.total_time = 0.0;
+      local_profile.max_event_time = 0.0;
+      local_profile.max_mailbox_size = 0;
+      local_profile.mailbox_overflow_count = 0;
+    }
+
+    if (profiler.log_period > 0 && Time::now_cached() >= profiler.next_log_time) {
+      profiler.next_log_time = Time::now_cached() + profiler.log_period;
+      statistics = get_actor_profiles_statistics(profiler.profiles);
+    }
+  }
+  if (!statistics.empty()) {
+    LOG(INFO) << "Actor statistics:\n" << statistics;
   }
 }
 
@@ -406,6 +590,10 @@ void Scheduler::destroy_on_scheduler_impl(int32 sched_id, Promise<Unit> action)
 }
 
 void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
+  if (unlikely(actor_info->mailbox_.size() >= actor_info->get_mailbox_capacity()) &&
+      !add_to_full_mailbox(actor_info, event)) {
+    return;
+  }
   if (!actor_info->is_running()) {
     auto node = actor_info->get_list_node();
     node->remove();
@@ -413,6 +601,45 @@ void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
   }
   VLOG(actor) << "Add to mailbox: " << *actor_info << " " << event;
   actor_info->mailbox_.push_back(std::move(event));
+  auto profile = actor_info->get_profile();
+  if (profile != nullptr && actor_info->mailbox_.size() > profile->max_mailbox_size) {
+    profile->max_mailbox_size = actor_info->mailbox_.size();
+  }
+}
+
+bool Scheduler::add_to_full_mailbox(ActorInfo *actor_info, Event &event) {
+  if (event.type != Event::Type::Custom && event.type != Event::Type::Raw) {
+    // system events are never limited
+    return true;
+  }
+  actor_info->on_mailbox_overflow();
+  switch (actor_info->get_mailbox_overflow_policy()) {
+    case ActorInfo::MailboxOverflowPolicy::Reject:
+      VLOG(actor) << "Drop event for " << *actor_info << " with full mailbox: " << event;
+      return false;
+    case ActorInfo::MailboxOverflowPolicy::Coalesce: {
+      // the event being processed by a running actor must not be replaced
+      if (event.type != Event::Type::Custom || actor_info->is_running()) {
+        return true;
+      }
+      auto &mailbox = actor_info->mailbox_;
+      for (auto it = mailbox.rbegin(); it != mailbox.rend(); ++it) {
+        if (it->type == Event::Type::Custom && it->link_token == event.link_token &&
+            it->data.custom_event->is_same_call(*event.data.custom_event)) {
+          VLOG(actor) << "Coalesce event for " << *actor_info << " with full mailbox: " << event;
+          *it = std::move(event);
+          return false;
+        }
+      }
+      return true;
+    }
+    case ActorInfo::MailboxOverflowPolicy::Notify:
+      actor_info->set_need_notify_mailbox_overflow(true);
+      return true;
+    default:
+      UNREACHABLE();
+      return true;
+  }
 }
 
 void Scheduler::do_stop_actor(Actor *actor) {
@@ -526,17 +753,36 @@ void Scheduler::flush_mailbox(ActorInfo *actor_info) {
   size_t mailbox_size = mailbox.size();
   CHECK(mailbox_size != 0);
   EventGuard guard(this, actor_info);
+  if (unlikely(actor_info->need_notify_mailbox_overflow())) {
+    actor_info->set_need_notify_mailbox_overflow(false);
+    actor_info->get_actor_unsafe()->on_mailbox_overflow();
+  }
   size_t i = 0;
-  for (; i < mailbox_size && guard.can_run(); i++) {
-    do_event(actor_info, std::move(mailbox[i]));
+  if (likely(!guard.need_event_time())) {
+    for (; i < mailbox_size && guard.can_run(); i++) {
+      do_event(actor_info, std::move(mailbox[i]));
+    }
+  } else {
+    for (; i < mailbox_size && guard.can_run(); i++) {
+      auto event_start_time = Time::now();
+      do_event(actor_info, std::move(mailbox[i]));
+      guard.on_event_processed(Time::now() - event_start_time);
+    }
   }
+  guard.set_event_count(i);
   mailbox.erase(mailbox.begin(), mailbox.begin() + i);
 }
 
 void Scheduler::run_mailbox() {
   VLOG(actor) << "Run mailbox : begin";
   ListNode ready_actors = std::move(ready_actors_);
+  if (work_stealing_group_ != nullptr) {
+    publish_ready_actors(ready_actors);
+  }
   while (!ready_actors.empty()) {
+    if (work_stealing_group_ != nullptr) {
+      give_actor_to_thief(ready_actors);
+    }
     ListNode *node = ready_actors.get();
     CHECK(node);
     auto actor_info = ActorInfo::from_list_node(node);
@@ -562,6 +808,133 @@ void Scheduler::run_mailbox() {
   // LOG_CHECK(cnt == actor_count_) << cnt << " vs " << actor_count_;
 }
 
+bool Scheduler::need_delay_event(const ActorId<> &actor_id) const {
+  if (work_stealing_group_ == nullptr) {
+    return false;
+  }
+  // events for stealable actors are added to the mailbox, so the actor becomes ready and can be stolen
+  const ActorInfo *actor_info = actor_id.get_actor_info();
+  return actor_info != nullptr && actor_info->migrate_dest_flag_atomic() == std::make_pair(sched_id_, false) &&
+         actor_info->is_stealable();
+}
+
+static bool can_steal_actor(const ActorInfo *actor_info) {
+  // actor's timeout would be lost during migration
+  return actor_info->is_stealable() && !actor_info->is_migrating() && !actor_info->get_heap_node()->in_heap();
+}
+
+void Scheduler::publish_ready_actors(const ListNode &ready_actors) {
+  int32 stealable_actor_count = 0;
+  bool has_work = false;
+  for (const ListNode *end = &ready_actors, *it = ready_actors.next; it != end; it = it->next) {
+    auto actor_info = ActorInfo::from_list_node(const_cast<ListNode *>(it));
+    if (can_steal_actor(actor_info)) {
+      stealable_actor_count++;
+    }
+    if (actor_info->get_actor_unsafe() != &service_actor_) {
+      has_work = true;
+    }
+  }
+
+  auto &slots = work_stealing_group_->slots_;
+  slots[sched_id_].stealable_actor_count.store(stealable_actor_count, std::memory_order_relaxed);
+
+  if (has_work) {
+    // we have own work to do
+    withdraw_steal_request();
+  }
+
+  if (stealable_actor_count < WORK_STEALING_MIN_STEALABLE_ACTOR_COUNT) {
+    return;
+  }
+
+  // wake up an idle scheduler, so it can steal some of our actors
+  for (int32 i = 0; i < static_cast<int32>(slots.size()); i++) {
+    if (i == sched_id_) {
+      continue;
+    }
+    bool is_idle = true;
+    if (slots[i].is_idle.load(std::memory_order_relaxed) &&
+        slots[i].is_idle.compare_exchange_strong(is_idle, false, std::memory_order_acq_rel)) {
+      VLOG(actor) << "Wake up idle scheduler " << i;
+      outbound_queues_[i]->writer_put({});
+      return;
+    }
+  }
+}
+
+void Scheduler::give_actor_to_thief(ListNode &ready_actors) {
+  auto &slot = work_stealing_group_->slots_[sched_id_];
+  auto thief_sched_id = slot.thief_sched_id.load(std::memory_order_relaxed);
+  if (thief_sched_id == -1) {
+    return;
+  }
+
+  // the first ready actor is kept, because it will be run next anyway
+  ListNode *end = &ready_actors;
+  if (ready_actors.next == end) {
+    return;
+  }
+  ActorInfo *stolen_actor_info = nullptr;
+  for (ListNode *it = ready_actors.next->next; it != end; it = it->next) {
+    auto actor_info = ActorInfo::from_list_node(it);
+    if (can_steal_actor(actor_info)) {
+      stolen_actor_info = actor_info;
+      break;
+    }
+  }
+  if (stolen_actor_info == nullptr) {
+    return;
+  }
+  if (!slot.thief_sched_id.compare_exchange_strong(thief_sched_id, -1, std::memory_order_acq_rel)) {
+    // the request was withdrawn
+    return;
+  }
+
+  VLOG(actor) << "Actor " << *stolen_actor_info << " is stolen by scheduler " << thief_sched_id;
+  do_migrate_actor(stolen_actor_info, thief_sched_id);
+}
+
+void Scheduler::withdraw_steal_request() {
+  if (steal_victim_sched_id_ == -1) {
+    return;
+  }
+  // the request may have been already served
+  auto thief_sched_id = sched_id_;
+  work_stealing_group_->slots_[steal_victim_sched_id_].thief_sched_id.compare_exchange_strong(
+      thief_sched_id, -1, std::memory_order_acq_rel);
+  steal_victim_sched_id_ = -1;
+}
+
+void Scheduler::try_steal_actor() {
+  auto &slots = work_stealing_group_->slots_;
+  slots[sched_id_].stealable_actor_count.store(0, std::memory_order_relaxed);
+  withdraw_steal_request();
+
+  int32 victim_sched_id = -1;
+  int32 max_stealable_actor_count = WORK_STEALING_MIN_STEALABLE_ACTOR_COUNT - 1;
+  for (int32 i = 0; i < static_cast<int32>(slots.size()); i++) {
+    if (i == sched_id_ || slots[i].is_idle.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    auto stealable_actor_count = slots[i].stealable_actor_count.load(std::memory_order_relaxed);
+    if (stealable_actor_count > max_stealable_actor_count) {
+      max_stealable_actor_count = stealable_actor_count;
+      victim_sched_id = i;
+    }
+  }
+  if (victim_sched_id == -1) {
+    return;
+  }
+
+  int32 expected_sched_id = -1;
+  if (slots[victim_sched_id].thief_sched_id.compare_exchange_strong(expected_sched_id, sched_id_,
+                                                                     std::memory_order_acq_rel)) {
+    VLOG(actor) << "Try to steal an actor from scheduler " << victim_sched_id;
+    steal_victim_sched_id_ = victim_sched_id;
+  }
+}
+
 Timestamp Scheduler::run_timeout() {
   double now = Time::now();
   //TODO: use Timestamp().is_in_past()
@@ -580,21 +953,41 @@ Timestamp Scheduler::run_events(Timestamp timeout) {
   do {
     run_mailbox();
     res = run_timeout();
+    if (batch_outbound_events_) {
+      flush_outbound_batches();
+    }
   } while (!ready_actors_.empty() && !timeout.is_in_past());
+  if (!actor_profiles_.empty() && Time::now_cached() >= next_actor_profiles_publish_time_) {
+    publish_actor_profiles();
+  }
   return res;
 }
 
 void Scheduler::run_no_guard(Timestamp timeout) {
   CHECK(has_guard_);
+  // events for other schedulers are sent in batches once per run_events iteration
+  batch_outbound_events_ = true;
   SCOPE_EXIT {
     yield_flag_ = false;
+    flush_outbound_batches();
+    batch_outbound_events_ = false;
   };
 
   timeout.relax(run_events(timeout));
   if (yield_flag_) {
     return;
   }
-  run_poll(timeout);
+  if (work_stealing_group_ != nullptr) {
+    auto &is_idle = work_stealing_group_->slots_[sched_id_].is_idle;
+    if (ready_actors_.empty()) {
+      try_steal_actor();
+      is_idle.store(true, std::memory_order_release);
+    }
+    run_poll(timeout);
+    is_idle.store(false, std::memory_order_relaxed);
+  } else {
+    run_poll(timeout);
+  }
   run_events(timeout);
 }
 
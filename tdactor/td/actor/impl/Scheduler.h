@@ -34,6 +34,21 @@ class EventGuard {
     return event_context_.flags == 0;
   }
 
+  void set_event_count(size_t event_count) {
+    event_count_ = event_count;
+  }
+
+  bool need_event_time() const {
+    return start_time_ != 0.0;
+  }
+
+  // must be called after each event if several events are processed under the guard and need_event_time() is true
+  void on_event_processed(double event_time) {
+    if (event_time > max_event_time_) {
+      max_event_time_ = event_time;
+    }
+  }
+
   EventGuard(const EventGuard &) = delete;
   EventGuard &operator=(const EventGuard &) = delete;
   EventGuard(EventGuard &&) = delete;
@@ -46,6 +61,9 @@ class EventGuard {
   Scheduler *scheduler_;
   ActorContext *save_context_;
   const char *save_log_tag2_;
+  double start_time_ = 0.0;
+  double max_event_time_ = -1.0;
+  size_t event_count_ = 1;
 
   void swap_context(ActorInfo *info);
 };
@@ -104,6 +122,7 @@ ActorOwn<ActorT> Scheduler::register_actor_impl(Slice name, ActorT *actor_ptr, A
   auto actor_info = info.get();
   actor_info->init(sched_id_, name, std::move(info), static_cast<Actor *>(actor_ptr), deleter,
                    ActorTraits<ActorT>::need_context, ActorTraits<ActorT>::need_start_up);
+  init_actor_profile(actor_info, name);
   VLOG(actor) << "Create actor " << *actor_info << " (actor_count = " << actor_count_ << ')';
 
   ActorId<ActorT> actor_id = weak_info->actor_id(actor_ptr);
@@ -12,6 +12,7 @@
 
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/Observer.h"
 #include "td/utils/port/FileFd.h"
@@ -680,3 +681,118 @@ TEST(Actors, MultiPromiseSendClosureLater) {
   }
   scheduler.finish();
 }
+
+class ProfiledActorTest final : public td::Actor {
+ public:
+  void start_up() final {
+    for (int i = 0; i < 5; i++) {
+      td::send_closure_later(actor_id(this), &ProfiledActorTest::on_event);
+    }
+  }
+
+  void on_event() {
+    if (++event_count_ == 5) {
+      td::Scheduler::instance()->finish();
+    }
+  }
+
+ private:
+  int event_count_ = 0;
+};
+
+TEST(Actors, actor_profiling) {
+  td::Scheduler::enable_actor_profiling(0.0);
+  td::ConcurrentScheduler scheduler(0, 0);
+  scheduler.create_actor_unsafe<ProfiledActorTest>(0, "ProfiledActorTest").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+    // empty
+  }
+  scheduler.finish();
+  td::Scheduler::disable_actor_profiling();
+
+  auto statistics = td::Scheduler::get_actor_statistics();
+  auto begin_pos = statistics.find("ProfiledActorTest: ");
+  ASSERT_TRUE(begin_pos != td::string::npos);
+  auto end_pos = statistics.find('\n', begin_pos);
+  ASSERT_TRUE(end_pos != td::string::npos);
+  td::Slice line(statistics.data() + begin_pos, statistics.data() + end_pos);
+  // start, 5 closures and stop; all closures are added to the mailbox before the start event is removed from it
+  ASSERT_TRUE(td::begins_with(line, "ProfiledActorTest: 7 events in "));
+  ASSERT_TRUE(td::ends_with(line, ", max mailbox size 6"));
+}
+
+class BoundedMailboxReceiver final : public td::Actor {
+ public:
+  BoundedMailboxReceiver(MailboxOverflowPolicy policy, td::vector<int> *values) : policy_(policy), values_(values) {
+  }
+
+  void start_up() final {
+    set_mailbox_capacity(2, policy_);
+  }
+
+  void on_value(int value) {
+    values_->push_back(value);
+  }
+
+  void on_mailbox_overflow() final {
+    values_->push_back(-1);
+  }
+
+  void tear_down() final {
+    values_->push_back(-static_cast<int>(get_mailbox_overflow_count()) - 10);
+  }
+
+ private:
+  MailboxOverflowPolicy policy_;
+  td::vector<int> *values_;
+};
+
+class BoundedMailboxSender final : public td::Actor {
+ public:
+  BoundedMailboxSender(td::Actor::MailboxOverflowPolicy policy, td::vector<int> *values)
+      : policy_(policy), values_(values) {
+  }
+
+  void start_up() final {
+    receiver_ = td::create_actor<BoundedMailboxReceiver>("BoundedMailboxReceiver", policy_, values_);
+    send_closure_later(actor_id(this), &BoundedMailboxSender::send_values);
+  }
+
+  void send_values() {
+    for (int i = 0; i < 5; i++) {
+      td::send_closure_later(receiver_, &BoundedMailboxReceiver::on_value, i);
+    }
+    send_closure_later(actor_id(this), &BoundedMailboxSender::finish);
+  }
+
+  void finish() {
+    receiver_.reset();
+    td::Scheduler::instance()->finish();
+  }
+
+ private:
+  td::Actor::MailboxOverflowPolicy policy_;
+  td::vector<int> *values_;
+  td::ActorOwn<BoundedMailboxReceiver> receiver_;
+};
+
+static td::vector<int> run_bounded_mailbox_test(td::Actor::MailboxOverflowPolicy policy) {
+  td::vector<int> values;
+  td::ConcurrentScheduler scheduler(0, 0);
+  scheduler.create_actor_unsafe<BoundedMailboxSender>(0, "BoundedMailboxSender", policy, &values).release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+    // empty
+  }
+  scheduler.finish();
+  return values;
+}
+
+TEST(Actors, bounded_mailbox) {
+  // the last value is -10 - <number of overflows>
+  ASSERT_EQ(td::vector<int>({0, 1, -13}), run_bounded_mailbox_test(td::Actor::MailboxOverflowPolicy::Reject));
+  ASSERT_EQ(td::vector<int>({0, 4, -13}), run_bounded_mailbox_test(td::Actor::MailboxOverflowPolicy::Coalesce));
+  ASSERT_EQ(td::vector<int>({-1, 0, 1, 2, 3, 4, -13}),
+            run_bounded_mailbox_test(td::Actor::MailboxOverflowPolicy::Notify));
+}
@@ -12,6 +12,8 @@
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
 
+#include <atomic>
+
 class PowerWorker final : public td::Actor {
  public:
   class Callback {
@@ -186,3 +188,163 @@ TEST(Actors, send_closure_while_finish) {
   }
   sched.finish();
 }
+
+class OrderedReceiver final : public td::Actor {
+ public:
+  explicit OrderedReceiver(std::atomic<int> *received_count) : received_count_(received_count) {
+  }
+
+  void receive(int seq_no) {
+    ASSERT_EQ(next_seq_no_, seq_no);
+    next_seq_no_++;
+    (*received_count_)++;
+  }
+
+ private:
+  std::atomic<int> *received_count_;
+  int next_seq_no_ = 0;
+};
+
+class BatchSender final : public td::Actor {
+ public:
+  BatchSender(td::vector<td::ActorId<OrderedReceiver>> receivers, int message_count)
+      : receivers_(std::move(receivers)), message_count_(message_count) {
+  }
+
+ private:
+  td::vector<td::ActorId<OrderedReceiver>> receivers_;
+  int message_count_;
+  int sent_count_ = 0;
+
+  void loop() final {
+    // send messages in several iterations of the scheduler loop, so they are split between many batches
+    for (int i = 0; i < 1000 && sent_count_ < message_count_; i++, sent_count_++) {
+      for (auto &receiver : receivers_) {
+        td::send_closure(receiver, &OrderedReceiver::receive, sent_count_);
+      }
+    }
+    if (sent_count_ < message_count_) {
+      yield();
+    }
+  }
+};
+
+static void test_batched_send_closure(int message_count) {
+  constexpr int RECEIVER_COUNT = 4;
+  std::atomic<int> received_count{0};
+  td::ConcurrentScheduler sched(3, 0);
+
+  td::vector<td::ActorId<OrderedReceiver>> receivers;
+  for (int i = 0; i < RECEIVER_COUNT; i++) {
+    receivers.push_back(
+        sched.create_actor_unsafe<OrderedReceiver>(i % 2 + 2, PSLICE() << "OrderedReceiver" << i, &received_count)
+            .release());
+  }
+  sched.create_actor_unsafe<BatchSender>(1, "BatchSender", std::move(receivers), message_count).release();
+
+  sched.start();
+  // the sender becomes idle after the last message, so the last incomplete batch must be sent without new events
+  auto end_time = td::Time::now() + 10;
+  while (received_count.load() < RECEIVER_COUNT * message_count && td::Time::now() < end_time) {
+    sched.run_main(0.01);
+  }
+  sched.finish();
+  ASSERT_EQ(RECEIVER_COUNT * message_count, received_count.load());
+}
+
+TEST(Actors, send_closure_batch_order) {
+  test_batched_send_closure(100000);
+}
+
+TEST(Actors, send_closure_batch_single_message) {
+  test_batched_send_closure(1);
+}
+
+class StealingManager;
+
+class StealableWorker final : public td::Actor {
+ public:
+  explicit StealableWorker(td::ActorId<StealingManager> manager) : manager_(manager) {
+  }
+
+  void task(td::uint32 x, td::uint32 p);
+
+ private:
+  td::ActorId<StealingManager> manager_;
+
+  void start_up() final {
+    set_stealable(true);
+  }
+};
+
+class StealingManager final : public td::Actor {
+ public:
+  static constexpr td::int32 WORKER_SCHED_ID = 2;
+
+  StealingManager(int workers_n, int queries_n, int query_size, std::atomic<int> *stolen_task_count)
+      : workers_n_(workers_n), left_query_(queries_n), query_size_(query_size), stolen_task_count_(stolen_task_count) {
+  }
+
+  void on_task_done(td::uint32 result, td::int32 sched_id) {
+    pending_query_count_--;
+    if (sched_id != WORKER_SCHED_ID) {
+      (*stolen_task_count_)++;
+    }
+    if (left_query_ > 0) {
+      send_task(left_query_ % workers_n_);
+    }
+    if (pending_query_count_ == 0) {
+      td::Scheduler::instance()->finish();
+      stop();
+    }
+  }
+
+ private:
+  int workers_n_;
+  int left_query_;
+  int query_size_;
+  std::atomic<int> *stolen_task_count_;
+  int pending_query_count_ = 0;
+  td::vector<td::ActorOwn<StealableWorker>> workers_;
+
+  void send_task(int worker_id) {
+    td::send_closure(workers_[worker_id], &StealableWorker::task, 3, query_size_);
+    left_query_--;
+    pending_query_count_++;
+  }
+
+  void start_up() final {
+    for (int i = 0; i < workers_n_; i++) {
+      // all workers are created on the same scheduler
+      workers_.push_back(td::create_actor_on_scheduler<StealableWorker>(PSLICE() << "StealableWorker" << i,
+                                                                        WORKER_SCHED_ID, actor_id(this)));
+    }
+    for (int i = 0; i < workers_n_ * 10 && left_query_ > 0; i++) {
+      send_task(i % workers_n_);
+    }
+  }
+};
+
+void StealableWorker::task(td::uint32 x, td::uint32 p) {
+  td::uint32 res = 1;
+  for (td::uint32 i = 0; i < p; i++) {
+    res *= x;
+  }
+  td::send_closure(manager_, &StealingManager::on_task_done, res, td::Scheduler::instance()->sched_id());
+}
+
+TEST(Actors, workers_work_stealing) {
+  std::atomic<int> stolen_task_count{0};
+  td::ConcurrentScheduler sched(3, 0);
+  sched.enable_work_stealing();
+  sched.create_actor_unsafe<StealingManager>(1, "StealingManager", 10, 3000, 100000, &stolen_task_count).release();
+
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+
+  // all workers were created on the same scheduler, so some tasks must have been run by other schedulers
+  ASSERT_TRUE(stolen_task_count.load() > 0);
+}
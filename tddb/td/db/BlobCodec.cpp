@@ -0,0 +1,199 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/BlobCodec.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/Gzip.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+namespace td {
+
+#if TD_HAVE_ZLIB
+class GzipBlobCodec final : public BlobCodec {
+ public:
+  explicit GzipBlobCodec(string dictionary) : dictionary_(std::move(dictionary)) {
+  }
+
+  Type get_type() const final {
+    return Type::Gzip;
+  }
+
+  BufferSlice compress(Slice data, size_t max_size) final {
+    if (data.empty() || max_size == 0) {
+      return BufferSlice();
+    }
+    if (prepare(encoder_, Gzip::Mode::Encode).is_error()) {
+      return BufferSlice();
+    }
+    BufferWriter result{max_size};
+    encoder_.set_input(data);
+    encoder_.close_input();
+    encoder_.set_output(result.prepare_append().truncate(max_size));
+    auto r_state = encoder_.run();
+    if (r_state.is_error() || r_state.ok() != Gzip::State::Done) {
+      return BufferSlice();
+    }
+    result.confirm_append(encoder_.flush_output());
+    return result.as_buffer_slice();
+  }
+
+  Result<BufferSlice> decompress(Slice data) final {
+    TRY_STATUS(prepare(decoder_, Gzip::Mode::Decode));
+    ChainBufferWriter result;
+    decoder_.set_input(data);
+    decoder_.close_input();
+    auto output_size = data.size() * 4;
+    while (true) {
+      decoder_.set_output(result.prepare_append_at_least(output_size));
+      TRY_RESULT(state, decoder_.run());
+      result.confirm_append(decoder_.flush_output());
+      if (state == Gzip::State::Done) {
+        break;
+      }
+      if (!decoder_.need_output()) {
+        return Status::Error("Compressed data is truncated");
+      }
+      output_size *= 2;
+    }
+    return result.extract_reader().move_as_buffer_slice();
+  }
+
+ private:
+  string dictionary_;
+
+  // the streams are created once and reset before each value to avoid reallocation of zlib state
+  Gzip encoder_;
+  Gzip decoder_;
+  bool is_encoder_inited_ = false;
+  bool is_decoder_inited_ = false;
+
+  Status prepare(Gzip &gzip, Gzip::Mode mode) {
+    auto &is_inited = mode == Gzip::Mode::Encode ? is_encoder_inited_ : is_decoder_inited_;
+    if (is_inited) {
+      return gzip.reset();
+    }
+    TRY_STATUS(mode == Gzip::Mode::Encode ? gzip.init_encode(dictionary_) : gzip.init_decode(dictionary_));
+    gzip.set_reusable();
+    is_inited = true;
+    return Status::OK();
+  }
+};
+#endif
+
+unique_ptr<BlobCodec> BlobCodec::create(Type type, string dictionary) {
+  switch (type) {
+    case Type::Gzip:
+#if TD_HAVE_ZLIB
+      return td::make_unique<GzipBlobCodec>(std::move(dictionary));
+#else
+      return nullptr;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+string BlobCodec::train_dictionary(const vector<Slice> &samples, size_t max_size) {
+  static constexpr size_t SUBSTRING_SIZE = 8;
+  static constexpr size_t SEGMENT_SIZE = 64;
+
+  auto get_substring = [](const char *ptr) {
+    uint64 result;
+    std::memcpy(&result, ptr, sizeof(result));
+    return result;
+  };
+
+  // for each substring count the number of samples containing it
+  std::unordered_map<uint64, uint32> substring_counts;
+  for (auto sample : samples) {
+    if (sample.size() < SUBSTRING_SIZE) {
+      continue;
+    }
+    vector<uint64> substrings;
+    substrings.reserve(sample.size() - SUBSTRING_SIZE + 1);
+    for (size_t i = 0; i + SUBSTRING_SIZE <= sample.size(); i++) {
+      substrings.push_back(get_substring(sample.data() + i));
+    }
+    td::unique(substrings);
+    for (auto substring : substrings) {
+      substring_counts[substring]++;
+    }
+  }
+
+  // substrings found in only one sample don't help to compress other values
+  auto get_score = [&](Slice data) {
+    uint64 score = 0;
+    for (size_t i = 0; i + SUBSTRING_SIZE <= data.size(); i++) {
+      auto count = substring_counts[get_substring(data.data() + i)];
+      if (count > 1) {
+        score += count - 1;
+      }
+    }
+    return score;
+  };
+
+  struct Segment {
+    uint64 score;
+    Slice data;
+
+    bool operator<(const Segment &other) const {
+      return score < other.score;
+    }
+  };
+  vector<Segment> segments;
+  for (auto sample : samples) {
+    for (size_t begin = 0; begin + SUBSTRING_SIZE <= sample.size(); begin += SEGMENT_SIZE) {
+      auto data = sample.substr(begin, SEGMENT_SIZE);
+      auto score = get_score(data);
+      if (score > 0) {
+        segments.push_back(Segment{score, data});
+      }
+    }
+  }
+
+  // greedily choose the best segments; scores only decrease, because substrings of chosen segments aren't counted
+  // anymore, so a segment with the recalculated score, which is still the best, can be chosen immediately
+  vector<Slice> chosen_segments;
+  size_t total_size = 0;
+  std::make_heap(segments.begin(), segments.end());
+  while (!segments.empty() && total_size + SUBSTRING_SIZE <= max_size) {
+    std::pop_heap(segments.begin(), segments.end());
+    auto segment = segments.back();
+    segments.pop_back();
+
+    auto score = get_score(segment.data);
+    if (score == 0 || total_size + segment.data.size() > max_size) {
+      continue;
+    }
+    if (score < segment.score) {
+      segment.score = score;
+      segments.push_back(segment);
+      std::push_heap(segments.begin(), segments.end());
+      continue;
+    }
+
+    for (size_t i = 0; i + SUBSTRING_SIZE <= segment.data.size(); i++) {
+      substring_counts[get_substring(segment.data.data() + i)] = 0;
+    }
+    chosen_segments.push_back(segment.data);
+    total_size += segment.data.size();
+  }
+
+  // the best segments are placed at the end of the dictionary, where they are cheaper to reference
+  string result;
+  result.reserve(total_size);
+  for (auto it = chosen_segments.rbegin(); it != chosen_segments.rend(); ++it) {
+    result.append(it->begin(), it->size());
+  }
+  return result;
+}
+
+}  // namespace td
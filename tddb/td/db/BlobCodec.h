@@ -0,0 +1,42 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Status.h"
+
+namespace td {
+
+// compresses small database values using a dictionary shared by all of them
+// a codec keeps its compression state between calls, so it must be used from one thread at a time
+class BlobCodec {
+ public:
+  // append only; stored in databases
+  enum class Type : int32 { Gzip = 1 };
+
+  BlobCodec() = default;
+  BlobCodec(const BlobCodec &) = delete;
+  BlobCodec &operator=(const BlobCodec &) = delete;
+  virtual ~BlobCodec() = default;
+
+  virtual Type get_type() const = 0;
+
+  // returns an empty buffer if the data can't be compressed to at most max_size bytes
+  virtual BufferSlice compress(Slice data, size_t max_size) = 0;
+
+  virtual Result<BufferSlice> decompress(Slice data) = 0;
+
+  // returns nullptr if the codec isn't supported by the build
+  static unique_ptr<BlobCodec> create(Type type, string dictionary);
+
+  // builds a dictionary of at most max_size bytes from segments of the samples with the most common substrings
+  static string train_dictionary(const vector<Slice> &samples, size_t max_size);
+};
+
+}  // namespace td
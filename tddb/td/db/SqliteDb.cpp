@@ -7,10 +7,12 @@
 #include "td/db/SqliteDb.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/Stat.h"
+#include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
@@ -69,6 +71,63 @@ string db_key_to_sqlcipher_key(const DbKey &db_key) {
 }
 }  // namespace
 
+class SqliteDb::StatementCache {
+ public:
+  SqliteStatement *get(const string &statement) {
+    auto it = statements_.find(statement);
+    if (it == statements_.end()) {
+      statistics_.miss_count++;
+      return nullptr;
+    }
+    statistics_.hit_count++;
+    it->second->last_use_time = ++time_;
+    return &it->second->statement;
+  }
+
+  SqliteStatement *add(string statement_text, SqliteStatement &&statement) {
+    if (statements_.size() >= STATEMENT_CACHE_SIZE) {
+      auto lru_it = statements_.begin();
+      for (auto it = statements_.begin(); it != statements_.end(); ++it) {
+        if (it->second->last_use_time < lru_it->second->last_use_time) {
+          lru_it = it;
+        }
+      }
+      statements_.erase(lru_it);
+    }
+    auto &entry = statements_[std::move(statement_text)];
+    CHECK(entry == nullptr);
+    entry = make_unique<Entry>();
+    entry->statement = std::move(statement);
+    entry->last_use_time = ++time_;
+    return &entry->statement;
+  }
+
+  StatementCacheStatistics get_statistics() const {
+    auto result = statistics_;
+    result.size = statements_.size();
+    return result;
+  }
+
+ private:
+  struct Entry {
+    SqliteStatement statement;
+    uint64 last_use_time = 0;
+  };
+  FlatHashMap<string, unique_ptr<Entry>> statements_;
+  uint64 time_ = 0;
+  StatementCacheStatistics statistics_;
+};
+
+SqliteDb::SqliteDb() = default;
+
+SqliteDb::SqliteDb(std::shared_ptr<detail::RawSqliteDb> raw, bool enable_logging)
+    : raw_(std::move(raw)), enable_logging_(enable_logging) {
+}
+
+SqliteDb::SqliteDb(SqliteDb &&other) noexcept = default;
+
+SqliteDb &SqliteDb::operator=(SqliteDb &&other) noexcept = default;
+
 SqliteDb::~SqliteDb() = default;
 
 Status SqliteDb::init(CSlice path, bool allow_creation) {
@@ -181,16 +240,27 @@ Status SqliteDb::set_user_version(int32 version) {
   return exec(PSLICE() << "PRAGMA user_version = " << version);
 }
 
+Status SqliteDb::exec_cached(CSlice cmd) {
+  TRY_RESULT(stmt, get_cached_statement(cmd));
+  SCOPE_EXIT {
+    stmt->reset();
+  };
+  do {
+    TRY_STATUS(stmt->step());
+  } while (stmt->can_step());
+  return Status::OK();
+}
+
 Status SqliteDb::begin_read_transaction() {
   if (raw_->on_begin()) {
-    return exec("BEGIN");
+    return exec_cached("BEGIN");
   }
   return Status::OK();
 }
 
 Status SqliteDb::begin_write_transaction() {
   if (raw_->on_begin()) {
-    return exec("BEGIN IMMEDIATE");
+    return exec_cached("BEGIN IMMEDIATE");
   }
   return Status::OK();
 }
@@ -198,7 +268,7 @@ Status SqliteDb::begin_write_transaction() {
 Status SqliteDb::commit_transaction() {
   TRY_RESULT(need_commit, raw_->on_commit());
   if (need_commit) {
-    return exec("COMMIT");
+    return exec_cached("COMMIT");
   }
   return Status::OK();
 }
@@ -320,4 +390,24 @@ Result<SqliteStatement> SqliteDb::get_statement(CSlice statement) {
   return SqliteStatement(stmt, raw_);
 }
 
+Result<SqliteStatement *> SqliteDb::get_cached_statement(CSlice statement) {
+  if (statement_cache_ == nullptr) {
+    statement_cache_ = make_unique<StatementCache>();
+  }
+  auto statement_text = statement.str();
+  auto *result = statement_cache_->get(statement_text);
+  if (result != nullptr) {
+    return result;
+  }
+  TRY_RESULT(stmt, get_statement(statement));
+  return statement_cache_->add(std::move(statement_text), std::move(stmt));
+}
+
+SqliteDb::StatementCacheStatistics SqliteDb::get_statement_cache_statistics() const {
+  if (statement_cache_ == nullptr) {
+    return {};
+  }
+  return statement_cache_->get_statistics();
+}
+
 }  // namespace td
@@ -24,9 +24,9 @@ namespace td {
 
 class SqliteDb {
  public:
-  SqliteDb() = default;
-  SqliteDb(SqliteDb &&) = default;
-  SqliteDb &operator=(SqliteDb &&) = default;
+  SqliteDb();
+  SqliteDb(SqliteDb &&other) noexcept;
+  SqliteDb &operator=(SqliteDb &&other) noexcept;
   SqliteDb(const SqliteDb &) = delete;
   SqliteDb &operator=(const SqliteDb &) = delete;
   ~SqliteDb();
@@ -70,6 +70,19 @@ class SqliteDb {
 
   Result<SqliteStatement> get_statement(CSlice statement) TD_WARN_UNUSED_RESULT;
 
+  // returns a statement from the cache of the last used statements of the connection; the statement is owned
+  // by the cache, must be reset after use and remains valid until STATEMENT_CACHE_SIZE other statements are requested
+  Result<SqliteStatement *> get_cached_statement(CSlice statement) TD_WARN_UNUSED_RESULT;
+
+  static constexpr size_t STATEMENT_CACHE_SIZE = 64;
+
+  struct StatementCacheStatistics {
+    uint64 hit_count = 0;
+    uint64 miss_count = 0;
+    size_t size = 0;
+  };
+  StatementCacheStatistics get_statement_cache_statistics() const;
+
   template <class F>
   static void with_db_path(Slice main_path, F &&f) {
     detail::RawSqliteDb::with_db_path(main_path, f);
@@ -78,11 +91,14 @@ class SqliteDb {
   optional<int32> get_cipher_version() const;
 
  private:
-  SqliteDb(std::shared_ptr<detail::RawSqliteDb> raw, bool enable_logging)
-      : raw_(std::move(raw)), enable_logging_(enable_logging) {
-  }
+  class StatementCache;
+
+  SqliteDb(std::shared_ptr<detail::RawSqliteDb> raw, bool enable_logging);
   std::shared_ptr<detail::RawSqliteDb> raw_;
   bool enable_logging_ = false;
+  unique_ptr<StatementCache> statement_cache_;
+
+  Status exec_cached(CSlice cmd) TD_WARN_UNUSED_RESULT;
 
   Status init(CSlice path, bool allow_creation) TD_WARN_UNUSED_RESULT;
 
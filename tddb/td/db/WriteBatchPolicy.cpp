@@ -0,0 +1,79 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/WriteBatchPolicy.h"
+
+#include "td/utils/logging.h"
+
+namespace td {
+
+static const char *get_flush_reason_string(WriteBatchPolicy::FlushReason reason) {
+  switch (reason) {
+    case WriteBatchPolicy::FlushReason::Full:
+      return "full batch";
+    case WriteBatchPolicy::FlushReason::Timeout:
+      return "timeout";
+    case WriteBatchPolicy::FlushReason::Read:
+      return "read query";
+    case WriteBatchPolicy::FlushReason::Force:
+      return "force flush";
+    default:
+      UNREACHABLE();
+      return "";
+  }
+}
+
+void WriteBatchPolicy::reset() {
+  max_write_count_ = MIN_WRITE_COUNT;
+  max_delay_ = MIN_DELAY;
+}
+
+double WriteBatchPolicy::on_batch_start(double now) {
+  if (now > last_transaction_time_ + IDLE_TIME) {
+    reset();
+  }
+  return max_delay_;
+}
+
+void WriteBatchPolicy::on_transaction(FlushReason reason, size_t write_count, double start_time, double finish_time) {
+  auto transaction_time = finish_time - start_time;
+  last_transaction_time_ = finish_time;
+  statistics_.transaction_count++;
+  statistics_.write_count += write_count;
+  statistics_.max_transaction_write_count = max(statistics_.max_transaction_write_count, write_count);
+  statistics_.transaction_time += transaction_time;
+  statistics_.max_transaction_time = max(statistics_.max_transaction_time, transaction_time);
+  LOG(DEBUG) << "Commit " << write_count << " writes in " << transaction_time << " seconds because of "
+             << get_flush_reason_string(reason) << " with limits " << max_write_count_ << " and " << max_delay_;
+
+  switch (reason) {
+    case FlushReason::Full:
+      // writes are added faster than they are committed
+      max_write_count_ = min(max_write_count_ * 2, MAX_WRITE_COUNT);
+      max_delay_ = min(max_delay_ * 2, MAX_DELAY);
+      break;
+    case FlushReason::Timeout:
+      if (write_count * 4 <= max_write_count_) {
+        max_write_count_ = max(max_write_count_ / 2, MIN_WRITE_COUNT);
+        max_delay_ = max(max_delay_ / 2, MIN_DELAY);
+      }
+      break;
+    case FlushReason::Read:
+    case FlushReason::Force:
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+StringBuilder &operator<<(StringBuilder &string_builder, const WriteBatchPolicy::Statistics &statistics) {
+  return string_builder << "[transactions:" << statistics.transaction_count << "][writes:" << statistics.write_count
+                        << "][max_writes:" << statistics.max_transaction_write_count
+                        << "][time:" << statistics.transaction_time << "][max_time:" << statistics.max_transaction_time
+                        << ']';
+}
+
+}  // namespace td
@@ -0,0 +1,58 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/StringBuilder.h"
+
+namespace td {
+
+// chooses how many writes are combined in one transaction and how long to wait for more writes:
+// transactions grow while writes are added faster than they are committed and shrink back when the load drops
+class WriteBatchPolicy {
+ public:
+  enum class FlushReason : int32 { Full, Timeout, Read, Force };
+
+  struct Statistics {
+    uint64 transaction_count = 0;
+    uint64 write_count = 0;
+    size_t max_transaction_write_count = 0;
+    double transaction_time = 0;
+    double max_transaction_time = 0;
+  };
+
+  size_t get_max_write_count() const {
+    return max_write_count_;
+  }
+
+  // must be called when the first write is added to an empty batch; returns the maximum time to wait for other writes
+  double on_batch_start(double now);
+
+  void on_transaction(FlushReason reason, size_t write_count, double start_time, double finish_time);
+
+  const Statistics &get_statistics() const {
+    return statistics_;
+  }
+
+ private:
+  static constexpr size_t MIN_WRITE_COUNT = 50;
+  static constexpr size_t MAX_WRITE_COUNT = 3200;
+  static constexpr double MIN_DELAY = 0.01;
+  static constexpr double MAX_DELAY = 0.08;
+  static constexpr double IDLE_TIME = 1.0;
+
+  size_t max_write_count_ = MIN_WRITE_COUNT;
+  double max_delay_ = MIN_DELAY;
+  double last_transaction_time_ = 0;
+  Statistics statistics_;
+
+  void reset();
+};
+
+StringBuilder &operator<<(StringBuilder &string_builder, const WriteBatchPolicy::Statistics &statistics);
+
+}  // namespace td
@@ -14,10 +14,12 @@
 #include "td/utils/misc.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/port/MemoryMapping.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/PollFlags.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/Stat.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
@@ -26,6 +28,9 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace td {
 namespace detail {
 struct AesCtrEncryptionEvent {
@@ -159,6 +164,116 @@ class BinlogReader {
   bool is_encrypted_{false};
 };
 
+// reads events in place from the memory mapped binlog; the encrypted part is decrypted in chunks
+class MappedBinlogReader {
+ public:
+  explicit MappedBinlogReader(Slice data) : data_(data) {
+  }
+
+  int64 offset() const {
+    return offset_;
+  }
+
+  // all data after the current position is encrypted with the new state, initialized with the given key and IV
+  void enable_decryption(AesCtrState &&aes_ctr_state, Slice key, Slice iv) {
+    data_pos_ -= decrypted_.size() - decrypted_pos_;
+    decrypted_.clear();
+    decrypted_pos_ = 0;
+    aes_ctr_state_ = std::move(aes_ctr_state);
+    as_mutable_slice(key_).copy_from(key);
+    as_mutable_slice(iv_).copy_from(iv);
+    encrypted_data_pos_ = data_pos_;
+    is_encrypted_ = true;
+  }
+
+  // returns the state after decryption of the data before the current offset; data after it isn't accessed
+  AesCtrState move_aes_ctr_state() {
+    CHECK(is_encrypted_);
+    if (decrypted_pos_ == decrypted_.size()) {
+      return std::move(aes_ctr_state_);
+    }
+
+    // the state can't be rewound, so the data before the current offset is decrypted once more
+    auto end_pos = data_pos_ - (decrypted_.size() - decrypted_pos_);
+    AesCtrState aes_ctr_state;
+    aes_ctr_state.init(as_slice(key_), as_slice(iv_));
+    string buffer(td::min(end_pos - encrypted_data_pos_, DECRYPTION_CHUNK_SIZE), '\0');
+    for (auto pos = encrypted_data_pos_; pos < end_pos; pos += buffer.size()) {
+      auto chunk_size = td::min(end_pos - pos, buffer.size());
+      aes_ctr_state.decrypt(data_.substr(pos, chunk_size), MutableSlice(buffer).substr(0, chunk_size));
+    }
+    return aes_ctr_state;
+  }
+
+  // returns false if there is no complete event left
+  Result<bool> read_next(BinlogEvent *event) {
+    auto input = prepare_input(4);
+    if (input.size() < 4) {
+      return false;
+    }
+    auto size = static_cast<size_t>(TlParser(input.substr(0, 4)).fetch_int());
+    if (size > BinlogEvent::MAX_SIZE) {
+      return Status::Error(PSLICE() << "Too big event " << tag("size", size));
+    }
+    if (size < BinlogEvent::MIN_SIZE) {
+      return Status::Error(PSLICE() << "Too small event " << tag("size", size));
+    }
+    if (size % 4 != 0) {
+      return Status::Error(-2, PSLICE() << "Event of size " << size << " at offset " << offset_ << " out of "
+                                        << data_.size() << ' ' << tag("is_encrypted", is_encrypted_)
+                                        << format::as_hex_dump<4>(input.truncate(28)));
+    }
+
+    input = prepare_input(size);
+    if (input.size() < size) {
+      return false;
+    }
+
+    event->debug_info_ = BinlogDebugInfo{__FILE__, __LINE__};
+    event->init(input.substr(0, size).str());
+    TRY_STATUS(event->validate());
+    if (is_encrypted_) {
+      decrypted_pos_ += size;
+    } else {
+      data_pos_ += size;
+    }
+    offset_ += static_cast<int64>(size);
+    event->offset_ = offset_;
+    return true;
+  }
+
+ private:
+  static constexpr size_t DECRYPTION_CHUNK_SIZE = 1 << 20;
+
+  Slice data_;
+  size_t data_pos_ = 0;
+  int64 offset_ = 0;
+
+  bool is_encrypted_ = false;
+  AesCtrState aes_ctr_state_;
+  UInt256 key_;
+  UInt128 iv_;
+  size_t encrypted_data_pos_ = 0;
+  string decrypted_;
+  size_t decrypted_pos_ = 0;
+
+  Slice prepare_input(size_t size) {
+    if (!is_encrypted_) {
+      return data_.substr(data_pos_);
+    }
+    if (decrypted_.size() - decrypted_pos_ < size && data_pos_ < data_.size()) {
+      decrypted_.erase(0, decrypted_pos_);
+      decrypted_pos_ = 0;
+      auto old_size = decrypted_.size();
+      auto chunk_size = td::min(data_.size() - data_pos_, td::max(size - old_size, DECRYPTION_CHUNK_SIZE));
+      decrypted_.resize(old_size + chunk_size);
+      aes_ctr_state_.decrypt(data_.substr(data_pos_, chunk_size), MutableSlice(decrypted_).substr(old_size));
+      data_pos_ += chunk_size;
+    }
+    return Slice(decrypted_).substr(decrypted_pos_);
+  }
+};
+
 static int64 file_size(CSlice path) {
   auto r_stat = stat(path);
   if (r_stat.is_error()) {
@@ -166,6 +281,20 @@ static int64 file_size(CSlice path) {
   }
   return r_stat.ok().size_;
 }
+struct BinlogCompaction {
+  string path;
+  FileFd fd;
+  bool is_encrypted = false;
+  AesCtrState aes_ctr_state;
+  uint64 next_event_id = 0;  // all alive events with smaller identifiers are already copied
+  string buffer;
+  int64 size = 0;
+  uint64 events = 0;
+  double start_time = 0;
+  int64 start_size = 0;
+  uint64 start_events = 0;
+};
+
 }  // namespace detail
 
 int32 VERBOSITY_NAME(binlog) = VERBOSITY_NAME(DEBUG) + 8;
@@ -248,9 +377,17 @@ void Binlog::add_event(BinlogEvent &&event) {
       return fd_size > min_size && fd_size / rate > processor_->total_raw_events_size();
     };
     if (need_reindex(50000, 5) || need_reindex(100000, 4) || need_reindex(300000, 3) || need_reindex(500000, 2)) {
-      LOG(INFO) << tag("fd_size", format::as_size(fd_size))
-                << tag("total events size", format::as_size(processor_->total_raw_events_size()));
-      do_reindex();
+      if (use_incremental_compaction_) {
+        if (compaction_ == nullptr && Time::now_cached() >= next_compaction_time_) {
+          LOG(INFO) << tag("fd_size", format::as_size(fd_size))
+                    << tag("total events size", format::as_size(processor_->total_raw_events_size()));
+          start_compaction();
+        }
+      } else {
+        LOG(INFO) << tag("fd_size", format::as_size(fd_size))
+                  << tag("total events size", format::as_size(processor_->total_raw_events_size()));
+        do_reindex();
+      }
     }
   }
 }
@@ -286,6 +423,9 @@ Status Binlog::close(bool need_sync) {
   if (fd_.empty()) {
     return Status::OK();
   }
+  if (compaction_ != nullptr) {
+    cancel_compaction();
+  }
   if (need_sync) {
     sync("close");
   } else {
@@ -336,6 +476,13 @@ void Binlog::do_event(BinlogEvent &&event) {
     VLOG(binlog) << "Write binlog event: " << format::cond(state_ == State::Reindex, "[reindex] ")
                  << event.public_to_string();
     buffer_writer_.append(as_slice(event.raw_event_));
+
+    if (compaction_ != nullptr && event.id_ < compaction_->next_event_id) {
+      // the event changes an already copied event, so it must be copied too
+      CHECK(state_ == State::Run);
+      compaction_->buffer.append(as_slice(event.raw_event_).data(), event.raw_event_.size());
+      compaction_->events++;
+    }
   }
 
   if (event.type_ < 0) {
@@ -412,9 +559,12 @@ void Binlog::sync(const char *source) {
   flush(source);
   if (need_sync_) {
     LOG(INFO) << "Sync binlog from " << source;
+    auto start_time = Time::now();
     auto status = fd_.sync();
     LOG_IF(FATAL, status.is_error()) << "Failed to sync binlog: " << status;
     need_sync_ = false;
+    statistics_.sync_count++;
+    statistics_.sync_time += Time::now() - start_time;
   }
 }
 
@@ -461,6 +611,12 @@ void Binlog::lazy_flush() {
 }
 
 void Binlog::update_read_encryption() {
+  if (mapped_reader_ptr_ != nullptr) {
+    if (encryption_type_ == EncryptionType::AesCtr) {
+      mapped_reader_ptr_->enable_decryption(std::move(aes_ctr_state_), as_slice(aes_ctr_key_), as_slice(aes_ctr_iv_));
+    }
+    return;
+  }
   CHECK(binlog_reader_ptr_);
   switch (encryption_type_) {
     case EncryptionType::None: {
@@ -507,17 +663,135 @@ void Binlog::update_write_encryption() {
 
 Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callback) {
   state_ = State::Load;
+  info_.wrong_password = false;
 
+  TRY_RESULT(file_size, fd_.get_size());
+  Result<MemoryMapping> r_mapping = Status::Error("Binlog is empty");
+  if (file_size > 0) {
+    r_mapping = MemoryMapping::create_from_file(fd_);
+  }
+  if (r_mapping.is_ok()) {
+    TRY_STATUS(load_mapped_binlog_events(r_mapping.ok().as_slice(), debug_callback));
+  } else {
+    if (file_size > 0) {
+      LOG(INFO) << "Failed to map binlog: " << r_mapping.error();
+    }
+    TRY_STATUS(load_binlog_events(debug_callback));
+  }
+  if (info_.wrong_password) {
+    return Status::OK();
+  }
+
+  auto offset = processor_->offset();
+  CHECK(offset >= 0);
+  replay_events(callback);
+
+  TRY_RESULT(fd_size, fd_.get_size());
+  if (offset != fd_size) {
+    LOG(ERROR) << "Truncate " << tag("path", path_) << tag("old_size", fd_size) << tag("new_size", offset);
+    fd_.seek(offset).ensure();
+    fd_.truncate_to_current_position(offset).ensure();
+    db_key_used_ = false;  // force reindex
+  }
+  LOG_CHECK(fd_size_ == offset) << fd_size << " " << fd_size_ << " " << offset;
+  state_ = State::Run;
+
+  buffer_writer_ = ChainBufferWriter();
+  buffer_reader_ = buffer_writer_.extract_reader();
+  update_write_encryption();
+
+  return Status::OK();
+}
+
+size_t Binlog::get_replay_thread_count(int32 thread_count, unsigned hardware_concurrency) {
+  // hardware_concurrency is 0 if the number of CPUs is unknown
+  return min(static_cast<size_t>(max(thread_count, 1)), static_cast<size_t>(max(hardware_concurrency, 1u)));
+}
+
+void Binlog::replay_events(const Callback &callback) {
+  static constexpr size_t MIN_PARALLEL_REPLAY_EVENT_COUNT = 1 << 12;
+
+  auto group_count = replay_group_callbacks_.size();
+  size_t thread_count = 1;
+#if !TD_THREAD_UNSUPPORTED
+  if (group_count != 0) {
+    thread_count = get_replay_thread_count(replay_thread_count_, td::thread::hardware_concurrency());
+  }
+#endif
+
+  vector<vector<const BinlogEvent *>> group_events(thread_count > 1 ? group_count : 0);
+  size_t grouped_event_count = 0;
+  processor_->for_each([&](BinlogEvent &event) {
+    VLOG(binlog) << "Replay binlog event: " << event.public_to_string();
+    auto group = group_count == 0 ? group_count : get_replay_group_(event);
+    if (group >= group_count) {
+      if (callback) {
+        callback(event);
+      }
+    } else if (thread_count == 1) {
+      replay_group_callbacks_[group](event);
+    } else {
+      group_events[group].push_back(&event);
+      grouped_event_count++;
+    }
+  });
+  if (grouped_event_count == 0) {
+    return;
+  }
+
+  // the biggest groups are replayed first to balance load between threads
+  vector<size_t> groups;
+  for (size_t group = 0; group < group_count; group++) {
+    if (!group_events[group].empty()) {
+      groups.push_back(group);
+    }
+  }
+  std::sort(groups.begin(), groups.end(),
+            [&](size_t lhs, size_t rhs) { return group_events[lhs].size() > group_events[rhs].size(); });
+
+  std::atomic<size_t> next_group_pos{0};
+  auto run = [&] {
+    while (true) {
+      auto pos = next_group_pos.fetch_add(1, std::memory_order_relaxed);
+      if (pos >= groups.size()) {
+        return;
+      }
+      auto group = groups[pos];
+      const auto &group_callback = replay_group_callbacks_[group];
+      for (auto *event : group_events[group]) {
+        group_callback(*event);
+      }
+    }
+  };
+
+  vector<td::thread> threads;
+#if !TD_THREAD_UNSUPPORTED
+  if (grouped_event_count >= MIN_PARALLEL_REPLAY_EVENT_COUNT) {
+    thread_count = min(thread_count, groups.size());
+    for (size_t i = 1; i < thread_count; i++) {
+      threads.emplace_back(run);
+    }
+  }
+#endif
+  run();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+Status Binlog::load_binlog_events(const Callback &debug_callback) {
   buffer_writer_ = ChainBufferWriter();
   buffer_reader_ = buffer_writer_.extract_reader();
   fd_.set_input_writer(&buffer_writer_);
   detail::BinlogReader reader{nullptr};
   binlog_reader_ptr_ = &reader;
+  SCOPE_EXIT {
+    binlog_reader_ptr_ = nullptr;
+  };
 
   update_read_encryption();
 
   fd_.get_poll_info().add_flags(PollFlags::Read());
-  info_.wrong_password = false;
   while (true) {
     BinlogEvent event;
     auto r_need_size = reader.read_next(&event);
@@ -559,51 +833,75 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
     }
   }
 
-  auto offset = processor_->offset();
-  CHECK(offset >= 0);
-  processor_->for_each([&](BinlogEvent &event) {
-    VLOG(binlog) << "Replay binlog event: " << event.public_to_string();
-    if (callback) {
-      callback(event);
-    }
-  });
-
-  TRY_RESULT(fd_size, fd_.get_size());
-  if (offset != fd_size) {
-    LOG(ERROR) << "Truncate " << tag("path", path_) << tag("old_size", fd_size) << tag("new_size", offset);
-    fd_.seek(offset).ensure();
-    fd_.truncate_to_current_position(offset).ensure();
-    db_key_used_ = false;  // force reindex
-  }
-  LOG_CHECK(fd_size_ == offset) << fd_size << " " << fd_size_ << " " << offset;
-  binlog_reader_ptr_ = nullptr;
-  state_ = State::Run;
-
-  buffer_writer_ = ChainBufferWriter();
-  buffer_reader_ = buffer_writer_.extract_reader();
-
   // reuse aes_ctr_state_
   if (encryption_type_ == EncryptionType::AesCtr) {
     aes_ctr_state_ = aes_xcode_byte_flow_.move_aes_ctr_state();
   }
-  update_write_encryption();
+  return Status::OK();
+}
+
+// events are parsed directly from the mapped file, so each of them is copied only once
+Status Binlog::load_mapped_binlog_events(Slice data, const Callback &debug_callback) {
+  detail::MappedBinlogReader reader(data);
+  mapped_reader_ptr_ = &reader;
+  SCOPE_EXIT {
+    mapped_reader_ptr_ = nullptr;
+  };
+
+  bool is_aes_ctr_state_moved = false;
+  auto move_aes_ctr_state = [&] {
+    if (encryption_type_ == EncryptionType::AesCtr && !is_aes_ctr_state_moved) {
+      aes_ctr_state_ = reader.move_aes_ctr_state();
+      is_aes_ctr_state_moved = true;
+    }
+  };
 
+  while (true) {
+    BinlogEvent event;
+    auto r_is_read = reader.read_next(&event);
+    if (r_is_read.is_error()) {
+      if (r_is_read.error().code() == -2) {
+        // the mapped data after the new end of the file must not be accessed after truncation
+        move_aes_ctr_state();
+        auto old_size = detail::file_size(path_);
+        auto offset = reader.offset();
+        auto debug_data = debug_get_binlog_data(offset, old_size);
+        fd_.seek(offset).ensure();
+        fd_.truncate_to_current_position(offset).ensure();
+        if (debug_data.empty()) {
+          break;
+        }
+        LOG(FATAL) << "Truncate binlog \"" << path_ << "\" from size " << old_size << " to size " << offset
+                   << " due to error: " << r_is_read.error() << " after reading " << debug_data;
+      }
+      LOG(ERROR) << r_is_read.error();
+      break;
+    }
+    if (!r_is_read.ok()) {
+      break;
+    }
+    if (debug_callback) {
+      debug_callback(event);
+    }
+    do_add_event(std::move(event));
+    if (info_.wrong_password) {
+      return Status::OK();
+    }
+  }
+
+  // the file wasn't read, so new events must be appended after the last loaded event explicitly
+  fd_.seek(reader.offset()).ensure();
+  move_aes_ctr_state();
   return Status::OK();
 }
 
 void Binlog::update_encryption(Slice key, Slice iv) {
   as_mutable_slice(aes_ctr_key_).copy_from(key);
-  UInt128 aes_ctr_iv;
-  as_mutable_slice(aes_ctr_iv).copy_from(iv);
-  aes_ctr_state_.init(as_slice(aes_ctr_key_), as_slice(aes_ctr_iv));
+  as_mutable_slice(aes_ctr_iv_).copy_from(iv);
+  aes_ctr_state_.init(as_slice(aes_ctr_key_), as_slice(aes_ctr_iv_));
 }
 
-void Binlog::reset_encryption() {
-  if (db_key_.is_empty()) {
-    encryption_type_ = EncryptionType::None;
-    return;
-  }
-
+detail::AesCtrEncryptionEvent Binlog::create_encryption_event() const {
   using EncryptionEvent = detail::AesCtrEncryptionEvent;
   EncryptionEvent event;
 
@@ -624,13 +922,25 @@ void Binlog::reset_encryption() {
   }
 
   event.key_hash_ = EncryptionEvent::generate_hash(key);
+  return event;
+}
+
+void Binlog::reset_encryption() {
+  if (db_key_.is_empty()) {
+    encryption_type_ = EncryptionType::None;
+    return;
+  }
 
+  auto event = create_encryption_event();
   do_event(BinlogEvent(
       BinlogEvent::create_raw(0, BinlogEvent::ServiceTypes::AesCtrEncryption, 0, create_default_storer(event)),
       BinlogDebugInfo{__FILE__, __LINE__}));
 }
 
 void Binlog::do_reindex() {
+  if (compaction_ != nullptr) {
+    cancel_compaction();
+  }
   flush_events_buffer(true);
   // start reindex
   CHECK(state_ == State::Run);
@@ -675,6 +985,37 @@ void Binlog::do_reindex() {
   }
 
   // finish_reindex
+  replace_binlog_file(new_path, old_fd);
+
+  auto finish_time = Clocks::monotonic();
+  auto finish_size = fd_size_;
+  auto finish_events = fd_events_;
+  statistics_.reindex_count++;
+  statistics_.reindex_time += finish_time - start_time;
+
+  auto ratio = static_cast<double>(start_size) / static_cast<double>(finish_size + 1);
+
+  [&](Slice msg) {
+    if (start_size > (10 << 20) || finish_time - start_time > 1) {
+      LOG(WARNING) << "Slow " << msg;
+    } else {
+      LOG(INFO) << msg;
+    }
+  }(PSLICE() << "Regenerate index " << tag("name", path_) << tag("time", format::as_time(finish_time - start_time))
+             << tag("before_size", format::as_size(start_size)) << tag("after_size", format::as_size(finish_size))
+             << tag("ratio", ratio) << tag("before_events", start_events) << tag("after_events", finish_events));
+
+  buffer_writer_ = ChainBufferWriter();
+  buffer_reader_ = buffer_writer_.extract_reader();
+
+  // reuse aes_ctr_state_
+  if (encryption_type_ == EncryptionType::AesCtr) {
+    aes_ctr_state_ = aes_xcode_byte_flow_.move_aes_ctr_state();
+  }
+  update_write_encryption();
+}
+
+void Binlog::replace_binlog_file(const string &new_path, BufferedFdBase<FileFd> &old_fd) {
   auto status = unlink(path_);
   LOG_IF(FATAL, status.is_error()) << "Failed to unlink old binlog: " << status;
   old_fd.close();  // now we can close old file and release the system lock
@@ -682,9 +1023,6 @@ void Binlog::do_reindex() {
   FileFd::remove_local_lock(new_path);  // now we can release local lock for temporary file
   LOG_IF(FATAL, status.is_error()) << "Failed to rename binlog: " << status;
 
-  auto finish_time = Clocks::monotonic();
-  auto finish_size = fd_size_;
-  auto finish_events = fd_events_;
   for (int left_tries = 10; left_tries > 0; left_tries--) {
     auto r_stat = stat(path_);
     if (r_stat.is_error()) {
@@ -699,27 +1037,143 @@ void Binlog::do_reindex() {
                                              << detail::file_size(new_path) << ' ' << fd_events_ << ' ' << path_;
     break;
   }
+}
 
-  auto ratio = static_cast<double>(start_size) / static_cast<double>(finish_size + 1);
+// Compaction writes alive events to a new file in chunks, while new events are still appended to the current file.
+// Events changing already copied events are appended to the new file too, so after all alive events are copied,
+// the new file contains the same state and can replace the current file.
+void Binlog::start_compaction() {
+  CHECK(compaction_ == nullptr);
+  CHECK(state_ == State::Run);
+  flush_events_buffer(true);
 
-  [&](Slice msg) {
-    if (start_size > (10 << 20) || finish_time - start_time > 1) {
-      LOG(WARNING) << "Slow " << msg;
+  string new_path = path_ + ".new";
+  auto r_opened_file = open_binlog(new_path, FileFd::Flags::Write | FileFd::Flags::Create | FileFd::Truncate);
+  if (r_opened_file.is_error()) {
+    // don't retry on every added event
+    static constexpr double COMPACTION_RETRY_DELAY = 60.0;
+    LOG(ERROR) << "Can't open new binlog for compaction: " << r_opened_file.error();
+    next_compaction_time_ = Time::now() + COMPACTION_RETRY_DELAY;
+    return;
+  }
+
+  compaction_ = make_unique<detail::BinlogCompaction>();
+  compaction_->path = std::move(new_path);
+  compaction_->fd = r_opened_file.move_as_ok();
+  compaction_->start_time = Clocks::monotonic();
+  compaction_->start_size = fd_size_;
+  compaction_->start_events = fd_events_;
+  statistics_.compaction_copied_size = 0;
+  statistics_.compaction_total_size = processor_->total_raw_events_size();
+
+  if (encryption_type_ == EncryptionType::AesCtr) {
+    // the key is the same, so the current key salt can be reused
+    CHECK(!aes_ctr_key_salt_.empty());
+    auto event = create_encryption_event();
+    auto raw_event =
+        BinlogEvent::create_raw(0, BinlogEvent::ServiceTypes::AesCtrEncryption, 0, create_default_storer(event));
+    compaction_->buffer.append(raw_event.as_slice().data(), raw_event.size());
+    compaction_->events++;
+    if (!flush_compaction_buffer()) {
+      return;
+    }
+    compaction_->aes_ctr_state.init(as_slice(aes_ctr_key_), event.iv_);
+    compaction_->is_encrypted = true;
+  }
+}
+
+bool Binlog::flush_compaction_buffer() {
+  CHECK(compaction_ != nullptr);
+  auto &buffer = compaction_->buffer;
+  if (buffer.empty()) {
+    return true;
+  }
+  if (compaction_->is_encrypted) {
+    compaction_->aes_ctr_state.encrypt(buffer, MutableSlice(buffer));
+  }
+  Slice data = buffer;
+  while (!data.empty()) {
+    auto r_written = compaction_->fd.write(data);
+    if (r_written.is_error()) {
+      LOG(ERROR) << "Failed to write compacted binlog: " << r_written.error();
+      cancel_compaction();
+      return false;
+    }
+    data.remove_prefix(r_written.ok());
+  }
+  compaction_->size += static_cast<int64>(buffer.size());
+  buffer.clear();
+  return true;
+}
+
+void Binlog::compaction_step() {
+  static constexpr int64 MAX_COMPACTION_STEP_SIZE = 1 << 20;
+
+  CHECK(compaction_ != nullptr);
+  CHECK(state_ == State::Run);
+  auto start_time = Clocks::monotonic();
+  auto next_event_id =
+      processor_->for_each_from(compaction_->next_event_id, MAX_COMPACTION_STEP_SIZE, [&](BinlogEvent &event) {
+        compaction_->buffer.append(as_slice(event.raw_event_).data(), event.raw_event_.size());
+        compaction_->events++;
+        statistics_.compaction_copied_size += static_cast<int64>(event.raw_event_.size());
+      });
+  if (flush_compaction_buffer()) {
+    if (next_event_id == 0) {
+      finish_compaction();
     } else {
-      LOG(INFO) << msg;
+      compaction_->next_event_id = next_event_id;
     }
-  }(PSLICE() << "Regenerate index " << tag("name", path_) << tag("time", format::as_time(finish_time - start_time))
-             << tag("before_size", format::as_size(start_size)) << tag("after_size", format::as_size(finish_size))
-             << tag("ratio", ratio) << tag("before_events", start_events) << tag("after_events", finish_events));
+  }
+
+  auto step_time = Clocks::monotonic() - start_time;
+  statistics_.compaction_time += step_time;
+  statistics_.max_compaction_step_time = td::max(statistics_.max_compaction_step_time, step_time);
+}
+
+void Binlog::finish_compaction() {
+  CHECK(compaction_ != nullptr);
+  auto compaction = std::move(compaction_);
+  CHECK(compaction->buffer.empty());
+  if (compaction->start_size != 0) {  // must sync creation of the file if it is non-empty
+    auto status = compaction->fd.sync_barrier();
+    LOG_IF(FATAL, status.is_error()) << "Failed to sync binlog: " << status;
+  }
+
+  // all events from the current file, including not yet flushed ones, are already in the new file
+  auto old_fd = std::move(fd_);  // can't close fd_ now, because it will release file lock
+  fd_ = BufferedFdBase<FileFd>(std::move(compaction->fd));
+  fd_size_ = compaction->size;
+  fd_events_ = compaction->events;
+  need_sync_ = false;
+  need_flush_since_ = 0;
+  replace_binlog_file(compaction->path, old_fd);
 
   buffer_writer_ = ChainBufferWriter();
   buffer_reader_ = buffer_writer_.extract_reader();
-
-  // reuse aes_ctr_state_
-  if (encryption_type_ == EncryptionType::AesCtr) {
-    aes_ctr_state_ = aes_xcode_byte_flow_.move_aes_ctr_state();
+  if (compaction->is_encrypted) {
+    encryption_type_ = EncryptionType::AesCtr;
+    aes_ctr_state_ = std::move(compaction->aes_ctr_state);
+  } else {
+    encryption_type_ = EncryptionType::None;
   }
   update_write_encryption();
+
+  auto finish_time = Clocks::monotonic();
+  statistics_.compaction_count++;
+  LOG(INFO) << "Compact binlog " << tag("name", path_)
+            << tag("time", format::as_time(finish_time - compaction->start_time))
+            << tag("before_size", format::as_size(compaction->start_size))
+            << tag("after_size", format::as_size(fd_size_)) << tag("before_events", compaction->start_events)
+            << tag("after_events", fd_events_);
+}
+
+void Binlog::cancel_compaction() {
+  CHECK(compaction_ != nullptr);
+  auto compaction = std::move(compaction_);
+  compaction->fd.lock(FileFd::LockFlags::Unlock, compaction->path, 1).ignore();
+  compaction->fd.close();
+  unlink(compaction->path).ignore();
 }
 
 string Binlog::debug_get_binlog_data(int64 begin_offset, int64 end_offset) {
@@ -37,10 +37,27 @@ struct BinlogInfo {
   bool is_opened{false};
 };
 
+struct BinlogStatistics {
+  uint64 sync_count{0};
+  double sync_time{0};
+
+  uint64 reindex_count{0};
+  double reindex_time{0};
+
+  uint64 compaction_count{0};
+  double compaction_time{0};           // total time spent in compaction steps
+  double max_compaction_step_time{0};  // the longest time during which the binlog was blocked by compaction
+  int64 compaction_copied_size{0};     // progress of the current or the last compaction
+  int64 compaction_total_size{0};
+};
+
 namespace detail {
 class BinlogReader;
+class MappedBinlogReader;
 class BinlogEventsProcessor;
 class BinlogEventsBuffer;
+struct AesCtrEncryptionEvent;
+struct BinlogCompaction;
 }  // namespace detail
 
 class Binlog {
@@ -130,13 +147,45 @@ class Binlog {
     return info_;
   }
 
+  BinlogStatistics get_statistics() const {
+    return statistics_;
+  }
+
+  // if enabled, then the binlog is compacted in background by subsequent calls to compaction_step
+  // instead of being regenerated synchronously
+  void set_incremental_compaction(bool is_enabled) {
+    use_incremental_compaction_ = is_enabled;
+  }
+
+  bool need_compaction_step() const {
+    return compaction_ != nullptr;
+  }
+
+  void compaction_step();
+
+  // must be called before init; if set, then events for which get_replay_group returns a valid index in
+  // group_callbacks are replayed by the corresponding callback on one of up to thread_count threads;
+  // the order of events is preserved only inside each group and all other events are replayed by the main callback
+  void set_parallel_replay(std::function<size_t(const BinlogEvent &)> get_replay_group,
+                           vector<Callback> group_callbacks, int32 thread_count) {
+    CHECK(state_ == State::Empty);
+    get_replay_group_ = std::move(get_replay_group);
+    replay_group_callbacks_ = std::move(group_callbacks);
+    replay_thread_count_ = thread_count;
+  }
+
+  // returns the number of threads used to replay event groups
+  static size_t get_replay_thread_count(int32 thread_count, unsigned hardware_concurrency);
+
  private:
   BufferedFdBase<FileFd> fd_;
   ChainBufferWriter buffer_writer_;
   ChainBufferReader buffer_reader_;
   detail::BinlogReader *binlog_reader_ptr_ = nullptr;
+  detail::MappedBinlogReader *mapped_reader_ptr_ = nullptr;
 
   BinlogInfo info_;
+  BinlogStatistics statistics_;
   DbKey db_key_;
   bool db_key_used_ = false;
   DbKey old_db_key_;
@@ -145,6 +194,7 @@ class Binlog {
   // AesCtrEncryption
   string aes_ctr_key_salt_;
   UInt256 aes_ctr_key_;
+  UInt128 aes_ctr_iv_;
   AesCtrState aes_ctr_state_;
 
   bool byte_flow_flag_ = false;
@@ -163,6 +213,12 @@ class Binlog {
   double need_flush_since_ = 0;
   double next_buffer_flush_time_ = 0;
   bool need_sync_{false};
+  bool use_incremental_compaction_{false};
+  unique_ptr<detail::BinlogCompaction> compaction_;
+  double next_compaction_time_ = 0;
+  std::function<size_t(const BinlogEvent &)> get_replay_group_;
+  vector<Callback> replay_group_callbacks_;
+  int32 replay_thread_count_{1};
   enum class State { Empty, Load, Reindex, Run } state_{State::Empty};
 
   static Result<FileFd> open_binlog(const string &path, int32 flags);
@@ -170,9 +226,19 @@ class Binlog {
   void do_add_event(BinlogEvent &&event);
   void do_event(BinlogEvent &&event);
   Status load_binlog(const Callback &callback, const Callback &debug_callback = Callback()) TD_WARN_UNUSED_RESULT;
+  Status load_binlog_events(const Callback &debug_callback) TD_WARN_UNUSED_RESULT;
+  Status load_mapped_binlog_events(Slice data, const Callback &debug_callback) TD_WARN_UNUSED_RESULT;
+  void replay_events(const Callback &callback);
   void do_reindex();
+  void replace_binlog_file(const string &new_path, BufferedFdBase<FileFd> &old_fd);
+
+  void start_compaction();
+  bool flush_compaction_buffer();
+  void finish_compaction();
+  void cancel_compaction();
 
   void update_encryption(Slice key, Slice iv);
+  detail::AesCtrEncryptionEvent create_encryption_event() const;
   void reset_encryption();
   void update_read_encryption();
   void update_write_encryption();
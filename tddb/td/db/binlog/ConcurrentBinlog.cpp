@@ -19,6 +19,8 @@ namespace detail {
 class BinlogActor final : public Actor {
  public:
   BinlogActor(unique_ptr<Binlog> binlog, uint64 seq_no) : binlog_(std::move(binlog)), processor_(seq_no) {
+    // the binlog must not be blocked for a long time, so it is compacted in small steps between other requests
+    binlog_->set_incremental_compaction(true);
   }
   void close(Promise<> promise) {
     binlog_->close().ensure();
@@ -58,7 +60,11 @@ class BinlogActor final : public Actor {
       do_lazy_sync(std::move(event.sync_promise));
     });
     flush_immediate_sync();
+    if (group_commit_window_ > 0) {
+      do_group_commit();
+    }
     try_flush();
+    do_compaction_step();
   }
 
   void force_sync(Promise<> &&promise, const char *source) {
@@ -82,6 +88,17 @@ class BinlogActor final : public Actor {
     promise.set_value(Unit());
   }
 
+  void set_group_commit_window(double group_commit_window) {
+    group_commit_window_ = group_commit_window;
+    if (group_commit_window_ > 0) {
+      do_group_commit();
+    }
+  }
+
+  void get_statistics(Promise<BinlogStatistics> promise) {
+    promise.set_value(binlog_->get_statistics());
+  }
+
  private:
   unique_ptr<Binlog> binlog_;
 
@@ -93,8 +110,10 @@ class BinlogActor final : public Actor {
   bool lazy_sync_flag_ = false;
   bool flush_flag_ = false;
   double wakeup_at_ = 0;
+  double group_commit_window_ = 0;
 
   static constexpr double FLUSH_TIMEOUT = 0.001;  // 1ms
+  static constexpr size_t MAX_GROUP_COMMIT_PROMISES = 4096;
 
   void wakeup_after(double after) {
     auto now = Time::now_cached();
@@ -108,6 +127,14 @@ class BinlogActor final : public Actor {
     }
   }
 
+  // the compaction progresses by one bounded step per received batch of events and per timeout,
+  // so new events are never delayed for more than one step
+  void do_compaction_step() {
+    if (binlog_->need_compaction_step()) {
+      binlog_->compaction_step();
+    }
+  }
+
   void do_add_raw_event(BufferSlice &&raw_event, BinlogDebugInfo info) {
     binlog_->add_raw_event(std::move(raw_event), info);
   }
@@ -137,9 +164,23 @@ class BinlogActor final : public Actor {
     if (promise) {
       sync_promises_.emplace_back(std::move(promise));
     }
-    if (!force_sync_flag_) {
+    // the sync can be already scheduled later by group commit
+    force_sync_flag_ = true;
+    wakeup_after(0.003);
+  }
+
+  // all events, which are waited for during the group commit window, are synced together;
+  // events without a promise are only flushed as usual
+  void do_group_commit() {
+    if (sync_promises_.empty()) {
+      return;
+    }
+    if (sync_promises_.size() >= MAX_GROUP_COMMIT_PROMISES) {
       force_sync_flag_ = true;
-      wakeup_after(0.003);
+      wakeup_at(Time::now_cached());
+    } else if (!force_sync_flag_) {
+      force_sync_flag_ = true;
+      wakeup_after(group_commit_window_);
     }
   }
 
@@ -148,6 +189,9 @@ class BinlogActor final : public Actor {
       return;
     }
     sync_promises_.emplace_back(std::move(promise));
+    if (group_commit_window_ > 0) {
+      return;
+    }
     if (!lazy_sync_flag_ && !force_sync_flag_) {
       wakeup_after(30);
       lazy_sync_flag_ = true;
@@ -169,6 +213,7 @@ class BinlogActor final : public Actor {
       try_flush();
       // LOG(ERROR) << "BINLOG FLUSH";
     }
+    do_compaction_step();
   }
 };
 }  // namespace detail
@@ -218,6 +263,14 @@ void ConcurrentBinlog::change_key(DbKey db_key, Promise<> promise) {
   send_closure(binlog_actor_, &detail::BinlogActor::change_key, std::move(db_key), std::move(promise));
 }
 
+void ConcurrentBinlog::set_group_commit_window(double group_commit_window) {
+  send_closure(binlog_actor_, &detail::BinlogActor::set_group_commit_window, group_commit_window);
+}
+
+void ConcurrentBinlog::get_statistics(Promise<BinlogStatistics> promise) {
+  send_closure(binlog_actor_, &detail::BinlogActor::get_statistics, std::move(promise));
+}
+
 uint64 ConcurrentBinlog::erase_batch(vector<uint64> event_ids) {
   auto shift = narrow_cast<int32>(event_ids.size());
   if (shift == 0) {
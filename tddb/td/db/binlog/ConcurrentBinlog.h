@@ -45,6 +45,13 @@ class ConcurrentBinlog final : public BinlogInterface {
   void force_flush() final;
   void change_key(DbKey db_key, Promise<> promise) final;
 
+  // if group_commit_window is positive, then every event added with a promise is synced at most group_commit_window
+  // seconds later together with all other events added in the meantime, and the promises are set after the sync;
+  // events added without a promise don't cause a sync
+  void set_group_commit_window(double group_commit_window);
+
+  void get_statistics(Promise<BinlogStatistics> promise);
+
   uint64 next_event_id() final {
     return last_event_id_.fetch_add(1, std::memory_order_relaxed);
   }
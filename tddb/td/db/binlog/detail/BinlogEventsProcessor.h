@@ -12,6 +12,8 @@
 #include "td/utils/logging.h"
 #include "td/utils/Status.h"
 
+#include <algorithm>
+
 namespace td {
 namespace detail {
 
@@ -33,6 +35,25 @@ class BinlogEventsProcessor {
     }
   }
 
+  // calls callback for alive events with identifiers not less than from_event_id, until total size of the processed
+  // events reaches max_size; returns identifier of the first not processed event or 0 if all events were processed
+  template <class CallbackT>
+  uint64 for_each_from(uint64 from_event_id, int64 max_size, CallbackT &&callback) {
+    auto i = static_cast<size_t>(std::lower_bound(event_ids_.begin(), event_ids_.end(), from_event_id * 2) -
+                                 event_ids_.begin());
+    int64 size = 0;
+    for (; i < event_ids_.size(); i++) {
+      if (size >= max_size) {
+        return event_ids_[i] / 2;
+      }
+      if ((event_ids_[i] & 1) == 0) {
+        size += static_cast<int64>(events_[i].raw_event_.size());
+        callback(events_[i]);
+      }
+    }
+    return 0;
+  }
+
   uint64 last_event_id() const {
     return last_event_id_;
   }
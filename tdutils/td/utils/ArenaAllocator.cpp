@@ -0,0 +1,87 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/ArenaAllocator.h"
+
+#include <atomic>
+#include <new>
+
+namespace td {
+
+// each allocation is preceded by a header with a pointer to the chunk containing it or nullptr for heap allocations
+static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+static constexpr size_t CHUNK_DATA_OFFSET = (2 * sizeof(size_t) + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+
+static constexpr size_t MAX_ARENA_OBJECT_SIZE = CHUNK_SIZE / 16;
+
+struct ArenaAllocator::Chunk {
+  // the number of objects allocated from the chunk plus one while the chunk is used by the arena
+  std::atomic<size_t> ref_cnt{1};
+  size_t used_size = 0;
+};
+
+TD_THREAD_LOCAL ArenaAllocator *ArenaAllocator::current_arena_;
+
+ArenaAllocator::~ArenaAllocator() {
+  if (chunk_ != nullptr) {
+    release_chunk(chunk_);
+  }
+}
+
+void *ArenaAllocator::allocate(size_t size) {
+  auto arena = current_arena_;
+  if (arena != nullptr && size <= MAX_ARENA_OBJECT_SIZE) {
+    return arena->allocate_impl(size);
+  }
+
+  auto header = static_cast<char *>(::operator new(HEADER_SIZE + size));
+  *reinterpret_cast<Chunk **>(header) = nullptr;
+  return header + HEADER_SIZE;
+}
+
+void *ArenaAllocator::allocate_impl(size_t size) {
+  static_assert(sizeof(Chunk) <= CHUNK_DATA_OFFSET, "");
+  auto full_size = HEADER_SIZE + (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+  if (chunk_ == nullptr || CHUNK_DATA_OFFSET + chunk_->used_size + full_size > CHUNK_SIZE) {
+    if (chunk_ != nullptr) {
+      release_chunk(chunk_);
+    }
+    chunk_ = new (::operator new(CHUNK_SIZE)) Chunk();
+    chunk_count_++;
+  }
+
+  auto header = reinterpret_cast<char *>(chunk_) + CHUNK_DATA_OFFSET + chunk_->used_size;
+  chunk_->used_size += full_size;
+  chunk_->ref_cnt.fetch_add(1, std::memory_order_relaxed);
+  *reinterpret_cast<Chunk **>(header) = chunk_;
+  return header + HEADER_SIZE;
+}
+
+void ArenaAllocator::deallocate(void *ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  auto header = static_cast<char *>(ptr) - HEADER_SIZE;
+  auto chunk = *reinterpret_cast<Chunk **>(header);
+  if (chunk == nullptr) {
+    ::operator delete(header);
+  } else {
+    release_chunk(chunk);
+  }
+}
+
+void ArenaAllocator::release_chunk(Chunk *chunk) noexcept {
+  if (chunk->ref_cnt.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    chunk->~Chunk();
+    ::operator delete(chunk);
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,67 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/port/thread_local.h"
+
+#include <cstddef>
+
+namespace td {
+
+// Allocates objects created in the current thread while a Guard exists from big chunks of memory.
+// Objects can be deleted in any order and in any thread and can outlive the arena,
+// because a chunk is freed only after the arena and all objects allocated from it are destroyed.
+class ArenaAllocator {
+ public:
+  class Guard {
+   public:
+    explicit Guard(ArenaAllocator *arena) : old_arena_(current_arena_) {
+      current_arena_ = arena;
+    }
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+    Guard(Guard &&) = delete;
+    Guard &operator=(Guard &&) = delete;
+    ~Guard() {
+      current_arena_ = old_arena_;
+    }
+
+   private:
+    ArenaAllocator *old_arena_;
+  };
+
+  ArenaAllocator() = default;
+  ArenaAllocator(const ArenaAllocator &) = delete;
+  ArenaAllocator &operator=(const ArenaAllocator &) = delete;
+  ArenaAllocator(ArenaAllocator &&) = delete;
+  ArenaAllocator &operator=(ArenaAllocator &&) = delete;
+  ~ArenaAllocator();
+
+  size_t get_chunk_count() const {
+    return chunk_count_;
+  }
+
+  // allocates memory from the current arena if any or from the heap otherwise
+  static void *allocate(size_t size);
+
+  // must be called for all memory returned by allocate
+  static void deallocate(void *ptr) noexcept;
+
+ private:
+  struct Chunk;
+  Chunk *chunk_ = nullptr;
+  size_t chunk_count_ = 0;
+
+  static TD_THREAD_LOCAL ArenaAllocator *current_arena_;
+
+  void *allocate_impl(size_t size);
+
+  static void release_chunk(Chunk *chunk) noexcept;
+};
+
+}  // namespace td
@@ -118,7 +118,9 @@ Result<size_t> BufferedFdBase<FdT>::flush_write() {
   write_->sync_with_writer();
   size_t result = 0;
   while (!write_->empty() && ::td::can_write_local(*this)) {
-    constexpr size_t BUF_SIZE = 20;
+    // messages, which are appended to the output buffer without copying, can consist of many small chunks,
+    // so the number of chunks written by one system call must be big enough
+    constexpr size_t BUF_SIZE = 64;
     IoSlice buf[BUF_SIZE];
 
     auto it = write_->clone();
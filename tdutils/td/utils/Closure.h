@@ -101,6 +101,10 @@ class DelayedClosure {
     tuple_for_each(args, f);
   }
 
+  bool has_same_function(const DelayedClosure &other) const {
+    return std::get<0>(args) == std::get<0>(other.args);
+  }
+
  private:
   std::tuple<FunctionT, typename std::decay<ArgsT>::type...> args;
 
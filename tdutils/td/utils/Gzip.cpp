@@ -32,21 +32,35 @@ class Gzip::Impl {
   ~Impl() = default;
 };
 
-Status Gzip::init_encode() {
+Status Gzip::init_encode(Slice dictionary) {
   CHECK(mode_ == Mode::Empty);
+  CHECK(dictionary.size() <= std::numeric_limits<uInt>::max());
   init_common();
   mode_ = Mode::Encode;
   int ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
   if (ret != Z_OK) {
     return Status::Error(PSLICE() << "zlib deflate init failed: " << ret);
   }
+  dictionary_ = dictionary;
+  return set_encode_dictionary();
+}
+
+Status Gzip::set_encode_dictionary() {
+  if (!dictionary_.empty()) {
+    int ret = deflateSetDictionary(&impl_->stream_, dictionary_.ubegin(), static_cast<uInt>(dictionary_.size()));
+    if (ret != Z_OK) {
+      return Status::Error(PSLICE() << "zlib deflate set dictionary failed: " << ret);
+    }
+  }
   return Status::OK();
 }
 
-Status Gzip::init_decode() {
+Status Gzip::init_decode(Slice dictionary) {
   CHECK(mode_ == Mode::Empty);
+  CHECK(dictionary.size() <= std::numeric_limits<uInt>::max());
   init_common();
   mode_ = Mode::Decode;
+  dictionary_ = dictionary;
   int ret = inflateInit2(&impl_->stream_, MAX_WBITS + 32);
   if (ret != Z_OK) {
     return Status::Error(PSLICE() << "zlib inflate init failed: " << ret);
@@ -54,6 +68,28 @@ Status Gzip::init_decode() {
   return Status::OK();
 }
 
+Status Gzip::reset() {
+  CHECK(is_reusable_);
+  CHECK(mode_ != Mode::Empty);
+  int ret = mode_ == Mode::Decode ? inflateReset(&impl_->stream_) : deflateReset(&impl_->stream_);
+  if (ret != Z_OK) {
+    return Status::Error(PSLICE() << "zlib reset failed: " << ret);
+  }
+  impl_->stream_.avail_in = 0;
+  impl_->stream_.next_in = nullptr;
+  impl_->stream_.avail_out = 0;
+  impl_->stream_.next_out = nullptr;
+
+  input_size_ = 0;
+  output_size_ = 0;
+  close_input_flag_ = false;
+
+  if (mode_ == Mode::Encode) {
+    return set_encode_dictionary();
+  }
+  return Status::OK();
+}
+
 void Gzip::set_input(Slice input) {
   CHECK(input_size_ == 0);
   CHECK(!close_input_flag_);
@@ -85,12 +121,23 @@ Result<Gzip::State> Gzip::run() {
     if (ret == Z_OK) {
       return State::Running;
     }
+    if (ret == Z_NEED_DICT && !dictionary_.empty()) {
+      // the dictionary is requested by inflate before any output is produced
+      ret = inflateSetDictionary(&impl_->stream_, dictionary_.ubegin(), static_cast<uInt>(dictionary_.size()));
+      if (ret == Z_OK) {
+        continue;
+      }
+    }
     if (ret == Z_STREAM_END) {
       // TODO(now): fail if input is not empty;
-      clear();
+      if (!is_reusable_) {
+        clear();
+      }
       return State::Done;
     }
-    clear();
+    if (!is_reusable_) {
+      clear();
+    }
     return Status::Error(PSLICE() << "zlib error " << ret);
   }
 }
@@ -116,6 +163,8 @@ void Gzip::init_common() {
   output_size_ = 0;
 
   close_input_flag_ = false;
+  is_reusable_ = false;
+  dictionary_ = Slice();
 }
 
 void Gzip::clear() {
@@ -125,6 +174,7 @@ void Gzip::clear() {
     deflateEnd(&impl_->stream_);
   }
   mode_ = Mode::Empty;
+  is_reusable_ = false;
 }
 
 Gzip::Gzip() : impl_(make_unique<Impl>()) {
@@ -148,15 +198,17 @@ void Gzip::swap(Gzip &other) {
   swap(output_size_, other.output_size_);
   swap(close_input_flag_, other.close_input_flag_);
   swap(mode_, other.mode_);
+  swap(is_reusable_, other.is_reusable_);
+  swap(dictionary_, other.dictionary_);
 }
 
 Gzip::~Gzip() {
   clear();
 }
 
-BufferSlice gzdecode(Slice s) {
+BufferSlice gzdecode(Slice s, Slice dictionary) {
   Gzip gzip;
-  gzip.init_decode().ensure();
+  gzip.init_decode(dictionary).ensure();
   ChainBufferWriter message;
   gzip.set_input(s);
   gzip.close_input();
@@ -184,9 +236,9 @@ BufferSlice gzdecode(Slice s) {
   return message.extract_reader().move_as_buffer_slice();
 }
 
-BufferSlice gzencode(Slice s, double max_compression_ratio) {
+BufferSlice gzencode(Slice s, double max_compression_ratio, Slice dictionary) {
   Gzip gzip;
-  gzip.init_encode().ensure();
+  gzip.init_encode(dictionary).ensure();
   gzip.set_input(s);
   gzip.close_input();
   auto max_size = static_cast<size_t>(static_cast<double>(s.size()) * max_compression_ratio);
@@ -35,9 +35,19 @@ class Gzip {
     return Status::OK();
   }
 
-  Status init_encode() TD_WARN_UNUSED_RESULT;
+  // the same preset dictionary must be used for encoding and decoding; it must be alive until the end of decoding
+  Status init_encode(Slice dictionary = Slice()) TD_WARN_UNUSED_RESULT;
 
-  Status init_decode() TD_WARN_UNUSED_RESULT;
+  Status init_decode(Slice dictionary = Slice()) TD_WARN_UNUSED_RESULT;
+
+  // keeps the stream after it is finished or failed, so it can be restarted with reset() without reallocation
+  void set_reusable() {
+    CHECK(mode_ != Mode::Empty);
+    is_reusable_ = true;
+  }
+
+  // restarts encoding or decoding of a reusable stream with the same dictionary
+  Status reset() TD_WARN_UNUSED_RESULT;
 
   void set_input(Slice input);
 
@@ -90,16 +100,20 @@ class Gzip {
   size_t output_size_ = 0;
   bool close_input_flag_ = false;
   Mode mode_ = Mode::Empty;
+  bool is_reusable_ = false;
+  Slice dictionary_;
 
   void init_common();
   void clear();
 
+  Status set_encode_dictionary();
+
   void swap(Gzip &other);
 };
 
-BufferSlice gzdecode(Slice s);
+BufferSlice gzdecode(Slice s, Slice dictionary = Slice());
 
-BufferSlice gzencode(Slice s, double max_compression_ratio);
+BufferSlice gzencode(Slice s, double max_compression_ratio, Slice dictionary = Slice());
 
 }  // namespace td
 
@@ -6,11 +6,25 @@
 //
 #include "td/utils/JsonBuilder.h"
 
+#include "td/utils/bits.h"
 #include "td/utils/misc.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/utf8.h"
 
+#include <cstring>
+
+#if defined(__SSE2__) || (TD_MSVC && (defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2)))
+#define TD_SSE2 1
+#endif
+
+#if TD_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace td {
 
 StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
@@ -135,6 +149,41 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonString &val) {
   return sb;
 }
 
+// returns offset of the first '"' or '\\' in [begin, end) or end - begin, if there is none
+static size_t find_json_string_special_char(const unsigned char *begin, const unsigned char *end) {
+  auto *ptr = begin;
+#ifdef __AVX2__
+  auto quotes = _mm256_set1_epi8('"');
+  auto backslashes = _mm256_set1_epi8('\\');
+  while (end - ptr >= 32) {
+    auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+    auto mask = static_cast<uint32>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chars, quotes), _mm256_cmpeq_epi8(chars, backslashes))));
+    if (mask != 0) {
+      return static_cast<size_t>(ptr - begin) + count_trailing_zeroes32(mask);
+    }
+    ptr += 32;
+  }
+#endif
+#if TD_SSE2
+  auto quotes16 = _mm_set1_epi8('"');
+  auto backslashes16 = _mm_set1_epi8('\\');
+  while (end - ptr >= 16) {
+    auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+    auto mask = static_cast<uint32>(
+        _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, quotes16), _mm_cmpeq_epi8(chars, backslashes16))));
+    if (mask != 0) {
+      return static_cast<size_t>(ptr - begin) + count_trailing_zeroes32(mask);
+    }
+    ptr += 16;
+  }
+#endif
+  while (ptr != end && *ptr != '"' && *ptr != '\\') {
+    ptr++;
+  }
+  return static_cast<size_t>(ptr - begin);
+}
+
 Result<MutableSlice> json_string_decode(Parser &parser) {
   if (!parser.try_skip('"')) {
     return Status::Error("Opening '\"' expected");
@@ -144,6 +193,7 @@ Result<MutableSlice> json_string_decode(Parser &parser) {
   auto *cur_src = result_start;
   auto *cur_dest = result_start;
   auto *end = data.uend();
+  size_t ordinary_char_count = 0;
 
   while (true) {
     if (cur_src == end) {
@@ -154,6 +204,7 @@ Result<MutableSlice> json_string_decode(Parser &parser) {
       return data.substr(0, cur_dest - result_start);
     }
     if (*cur_src == '\\') {
+      ordinary_char_count = 0;
       cur_src++;
       if (cur_src == end) {
         return Status::Error("Closing '\"' not found");
@@ -220,6 +271,16 @@ Result<MutableSlice> json_string_decode(Parser &parser) {
       }
     } else {
       *cur_dest++ = *cur_src++;
+      if (++ordinary_char_count == 8) {
+        // there is a long run of ordinary characters; skip the rest of them in bulk
+        auto length = find_json_string_special_char(cur_src, end);
+        if (cur_dest != cur_src) {
+          std::memmove(cur_dest, cur_src, length);
+        }
+        cur_dest += length;
+        cur_src += length;
+        ordinary_char_count = 0;
+      }
     }
   }
   UNREACHABLE();
@@ -235,6 +296,9 @@ Status json_string_skip(Parser &parser) {
   auto *end = data.uend();
 
   while (true) {
+    if (cur_src != end && *cur_src != '"' && *cur_src != '\\') {
+      cur_src += find_json_string_special_char(cur_src, end);
+    }
     if (cur_src == end) {
       return Status::Error("Closing '\"' not found");
     }
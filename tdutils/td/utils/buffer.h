@@ -739,6 +739,15 @@ class ChainBufferWriter {
       return append(slice.as_slice());
     }
 
+    append_without_copy(std::move(slice));
+  }
+
+  // appends the slice as a separate node, so its data isn't copied, but subsequent appends will need a new buffer
+  void append_without_copy(BufferSlice slice) {
+    CHECK(!empty());
+    if (slice.empty()) {
+      return;
+    }
     auto new_tail = ChainBufferNodeAllocator::create(std::move(slice), false);
     tail_->next_ = ChainBufferNodeAllocator::clone(new_tail);
     writer_ = BufferWriter();
@@ -48,6 +48,14 @@
 #include "crc32c/crc32c.h"
 #endif
 
+#if TD_HAVE_OPENSSL && (TD_GCC || TD_CLANG) && (defined(__x86_64__) || defined(__i386__))
+#define TD_AES_NI_SUPPORTED 1
+#define TD_AES_NI_TARGET __attribute__((target("aes,sse2")))
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
@@ -590,6 +598,172 @@ void aes_ige_decrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlic
   state.get_iv(aes_iv);
 }
 
+#if TD_AES_NI_SUPPORTED
+static bool is_aes_ni_supported() {
+  static const bool is_supported = [] {
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0 && (edx & bit_SSE2) != 0;
+  }();
+  return is_supported;
+}
+
+static TD_AES_NI_TARGET __m128i aes_ni_expand_key_step(__m128i key, __m128i assist) {
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+template <int rcon>
+static TD_AES_NI_TARGET void aes_ni_expand_key_pair(__m128i *round_keys, size_t i) {
+  round_keys[i] = aes_ni_expand_key_step(round_keys[i - 2],
+                                         _mm_shuffle_epi32(_mm_aeskeygenassist_si128(round_keys[i - 1], rcon), 0xff));
+  if (i + 1 < 15) {
+    round_keys[i + 1] = aes_ni_expand_key_step(
+        round_keys[i - 1], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(round_keys[i], 0), 0xaa));
+  }
+}
+
+// AES-256 key schedule for encryption
+static TD_AES_NI_TARGET void aes_ni_expand_key(const uint8 *key, __m128i *round_keys) {
+  round_keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key));
+  round_keys[1] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + 16));
+  aes_ni_expand_key_pair<0x01>(round_keys, 2);
+  aes_ni_expand_key_pair<0x02>(round_keys, 4);
+  aes_ni_expand_key_pair<0x04>(round_keys, 6);
+  aes_ni_expand_key_pair<0x08>(round_keys, 8);
+  aes_ni_expand_key_pair<0x10>(round_keys, 10);
+  aes_ni_expand_key_pair<0x20>(round_keys, 12);
+  aes_ni_expand_key_pair<0x40>(round_keys, 14);
+}
+
+// transforms the key schedule for encryption to the key schedule for decryption
+static TD_AES_NI_TARGET void aes_ni_invert_key(__m128i *round_keys) {
+  __m128i encryption_round_keys[15];
+  for (size_t i = 0; i < 15; i++) {
+    encryption_round_keys[i] = round_keys[i];
+  }
+  round_keys[0] = encryption_round_keys[14];
+  for (size_t i = 1; i < 14; i++) {
+    round_keys[i] = _mm_aesimc_si128(encryption_round_keys[14 - i]);
+  }
+  round_keys[14] = encryption_round_keys[0];
+}
+
+static constexpr size_t AES_NI_MAX_BATCH_SIZE = 8;
+
+// AES rounds of different items are independent, so they are executed in parallel by the CPU
+template <bool is_encrypt>
+static TD_AES_NI_TARGET void aes_ige_batch_aes_ni(AesIgeBatchItem *items, size_t count) {
+  CHECK(count <= AES_NI_MAX_BATCH_SIZE);
+
+  // items are processed in order of decreasing size, so unfinished items always form a prefix
+  size_t order[AES_NI_MAX_BATCH_SIZE];
+  for (size_t i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  std::sort(order, order + count,
+            [items](size_t lhs, size_t rhs) { return items[lhs].from.size() > items[rhs].from.size(); });
+
+  __m128i round_keys[AES_NI_MAX_BATCH_SIZE][15];
+  __m128i encrypted_iv[AES_NI_MAX_BATCH_SIZE];
+  __m128i plaintext_iv[AES_NI_MAX_BATCH_SIZE];
+  const uint8 *in[AES_NI_MAX_BATCH_SIZE];
+  uint8 *out[AES_NI_MAX_BATCH_SIZE];
+  size_t block_count[AES_NI_MAX_BATCH_SIZE];
+  for (size_t i = 0; i < count; i++) {
+    auto &item = items[order[i]];
+    CHECK(item.aes_key.size() == 32);
+    CHECK(item.aes_iv.size() == 32);
+    CHECK(item.from.size() % AES_BLOCK_SIZE == 0);
+    CHECK(item.to.size() >= item.from.size());
+    aes_ni_expand_key(item.aes_key.ubegin(), round_keys[i]);
+    if (!is_encrypt) {
+      aes_ni_invert_key(round_keys[i]);
+    }
+    encrypted_iv[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(item.aes_iv.ubegin()));
+    plaintext_iv[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(item.aes_iv.ubegin() + AES_BLOCK_SIZE));
+    in[i] = item.from.ubegin();
+    out[i] = item.to.ubegin();
+    block_count[i] = item.from.size() / AES_BLOCK_SIZE;
+  }
+
+  size_t active_count = count;
+  for (size_t block = 0;; block++) {
+    while (active_count > 0 && block_count[active_count - 1] == block) {
+      active_count--;
+    }
+    if (active_count == 0) {
+      break;
+    }
+
+    auto offset = block * AES_BLOCK_SIZE;
+    __m128i data[AES_NI_MAX_BATCH_SIZE];
+    __m128i state[AES_NI_MAX_BATCH_SIZE];
+    for (size_t i = 0; i < active_count; i++) {
+      data[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[i] + offset));
+      state[i] = _mm_xor_si128(_mm_xor_si128(data[i], is_encrypt ? encrypted_iv[i] : plaintext_iv[i]),
+                               round_keys[i][0]);
+    }
+    for (size_t round = 1; round < 14; round++) {
+      for (size_t i = 0; i < active_count; i++) {
+        state[i] = is_encrypt ? _mm_aesenc_si128(state[i], round_keys[i][round])
+                              : _mm_aesdec_si128(state[i], round_keys[i][round]);
+      }
+    }
+    for (size_t i = 0; i < active_count; i++) {
+      state[i] = is_encrypt ? _mm_aesenclast_si128(state[i], round_keys[i][14])
+                            : _mm_aesdeclast_si128(state[i], round_keys[i][14]);
+      if (is_encrypt) {
+        encrypted_iv[i] = _mm_xor_si128(state[i], plaintext_iv[i]);
+        plaintext_iv[i] = data[i];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out[i] + offset), encrypted_iv[i]);
+      } else {
+        plaintext_iv[i] = _mm_xor_si128(state[i], encrypted_iv[i]);
+        encrypted_iv[i] = data[i];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out[i] + offset), plaintext_iv[i]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    auto &item = items[order[i]];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(item.aes_iv.ubegin()), encrypted_iv[i]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(item.aes_iv.ubegin() + AES_BLOCK_SIZE), plaintext_iv[i]);
+  }
+}
+#endif
+
+template <bool is_encrypt>
+static void aes_ige_batch(MutableSpan<AesIgeBatchItem> items) {
+#if TD_AES_NI_SUPPORTED
+  if (is_aes_ni_supported()) {
+    for (size_t i = 0; i < items.size(); i += AES_NI_MAX_BATCH_SIZE) {
+      aes_ige_batch_aes_ni<is_encrypt>(&items[i], td::min(AES_NI_MAX_BATCH_SIZE, items.size() - i));
+    }
+    return;
+  }
+#endif
+  for (auto &item : items) {
+    if (is_encrypt) {
+      aes_ige_encrypt(item.aes_key, item.aes_iv, item.from, item.to);
+    } else {
+      aes_ige_decrypt(item.aes_key, item.aes_iv, item.from, item.to);
+    }
+  }
+}
+
+void aes_ige_encrypt_batch(MutableSpan<AesIgeBatchItem> items) {
+  aes_ige_batch<true>(items);
+}
+
+void aes_ige_decrypt_batch(MutableSpan<AesIgeBatchItem> items) {
+  aes_ige_batch<false>(items);
+}
+
 void aes_cbc_encrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to) {
   CHECK(from.size() <= to.size());
   CHECK(from.size() % 16 == 0);
@@ -10,6 +10,7 @@
 #include "td/utils/common.h"
 #include "td/utils/SharedSlice.h"
 #include "td/utils/Slice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 
 namespace td {
@@ -44,6 +45,18 @@ class AesState {
 void aes_ige_encrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to);
 void aes_ige_decrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to);
 
+struct AesIgeBatchItem {
+  Slice aes_key;
+  MutableSlice aes_iv;
+  Slice from;
+  MutableSlice to;
+};
+
+// equivalent to calling aes_ige_encrypt/aes_ige_decrypt for each item, but AES rounds of different items
+// are interleaved if the CPU supports AES-NI, which is much faster for several independent messages
+void aes_ige_encrypt_batch(MutableSpan<AesIgeBatchItem> items);
+void aes_ige_decrypt_batch(MutableSpan<AesIgeBatchItem> items);
+
 class AesIgeStateImpl;
 
 class AesIgeState {
@@ -161,6 +161,10 @@ class TlParser {
     return T(reinterpret_cast<const char *>(result_begin), result_len);
   }
 
+  void skip_string() {
+    fetch_string<Slice>();
+  }
+
   template <class T>
   T fetch_string_raw(const size_t size) {
     //CHECK(size % sizeof(int32) == 0);
@@ -182,6 +186,15 @@ class TlParser {
   size_t get_left_len() const {
     return left_len;
   }
+
+  // returns data fetched since the parser had old_left_len bytes left
+  Slice get_fetched_data(size_t old_left_len) const {
+    if (!error.empty()) {
+      return Slice();
+    }
+    auto fetched_len = old_left_len - left_len;
+    return Slice(data - fetched_len, fetched_len);
+  }
 };
 
 class TlBufferParser : public TlParser {
@@ -213,6 +226,10 @@ class TlBufferParser : public TlParser {
     return TlParser::fetch_string_raw<T>(size);
   }
 
+  BufferSlice get_fetched_buffer_slice(size_t old_left_len) {
+    return as_buffer_slice(get_fetched_data(old_left_len));
+  }
+
  private:
   const BufferSlice *parent_;
 
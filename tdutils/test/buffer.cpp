@@ -54,3 +54,27 @@ TEST(Buffer, buffer_builder) {
     ASSERT_EQ(builder.extract().as_slice(), str);
   }
 }
+
+TEST(Buffer, chain_buffer_append_without_copy) {
+  auto str = td::rand_string('a', 'z', 10000);
+  auto split_str = td::rand_split(str);
+
+  td::ChainBufferWriter writer;
+  auto reader = writer.extract_reader();
+  td::vector<td::BufferSlice> buffers;
+  for (auto &part : split_str) {
+    if (td::Random::fast_bool()) {
+      writer.append(part);
+    } else {
+      buffers.emplace_back(part);
+      auto data_begin = buffers.back().as_slice().begin();
+      writer.append_without_copy(buffers.back().clone());
+      reader.sync_with_writer();
+      auto last_node_slice = reader.clone();
+      last_node_slice.advance(reader.size() - part.size());
+      ASSERT_TRUE(last_node_slice.prepare_read().begin() == data_begin);
+    }
+  }
+  reader.sync_with_writer();
+  ASSERT_EQ(reader.move_as_buffer_slice().as_slice(), str);
+}
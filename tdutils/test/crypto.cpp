@@ -160,6 +160,52 @@ TEST(Crypto, AesIgeState) {
   }
 }
 
+TEST(Crypto, AesIgeBatch) {
+  td::Random::Xorshift128plus rnd(123);
+  for (int test = 0; test < 20; test++) {
+    auto count = static_cast<std::size_t>(rnd.fast(0, 20));
+    td::vector<td::UInt256> keys(count);
+    td::vector<td::UInt256> initial_ivs(count);
+    td::vector<td::UInt256> ivs(count);
+    td::vector<td::UInt256> batch_ivs(count);
+    td::vector<td::string> plaintexts(count);
+    td::vector<td::string> encrypted(count);
+    td::vector<td::string> batch_encrypted(count);
+    td::vector<td::AesIgeBatchItem> items;
+    for (std::size_t i = 0; i < count; i++) {
+      rnd.bytes(as_mutable_slice(keys[i]));
+      rnd.bytes(as_mutable_slice(initial_ivs[i]));
+      ivs[i] = initial_ivs[i];
+      batch_ivs[i] = initial_ivs[i];
+      plaintexts[i] = td::string(16 * rnd.fast(0, 300), '\0');
+      rnd.bytes(plaintexts[i]);
+      encrypted[i] = td::string(plaintexts[i].size(), '\0');
+      batch_encrypted[i] = td::string(plaintexts[i].size(), '\0');
+      td::aes_ige_encrypt(as_slice(keys[i]), as_mutable_slice(ivs[i]), plaintexts[i], encrypted[i]);
+      items.push_back({as_slice(keys[i]), as_mutable_slice(batch_ivs[i]), plaintexts[i], batch_encrypted[i]});
+    }
+    td::aes_ige_encrypt_batch(items);
+    for (std::size_t i = 0; i < count; i++) {
+      ASSERT_TRUE(encrypted[i] == batch_encrypted[i]);
+      ASSERT_TRUE(ivs[i] == batch_ivs[i]);
+    }
+
+    items.clear();
+    for (std::size_t i = 0; i < count; i++) {
+      ivs[i] = initial_ivs[i];
+      batch_ivs[i] = initial_ivs[i];
+      td::aes_ige_decrypt(as_slice(keys[i]), as_mutable_slice(ivs[i]), encrypted[i], encrypted[i]);
+      items.push_back({as_slice(keys[i]), as_mutable_slice(batch_ivs[i]), batch_encrypted[i], batch_encrypted[i]});
+    }
+    td::aes_ige_decrypt_batch(items);
+    for (std::size_t i = 0; i < count; i++) {
+      ASSERT_TRUE(plaintexts[i] == encrypted[i]);
+      ASSERT_TRUE(plaintexts[i] == batch_encrypted[i]);
+      ASSERT_TRUE(ivs[i] == batch_ivs[i]);
+    }
+  }
+}
+
 TEST(Crypto, AesCbcState) {
   td::vector<td::uint32> answers1{0u, 3617355989u, 3449188102u, 186999968u, 4244808847u, 2626031206u};
 
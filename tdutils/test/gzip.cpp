@@ -29,6 +29,57 @@ TEST(Gzip, gzencode_gzdecode) {
   encode_decode(td::string(1000000, 'a'));
 }
 
+TEST(Gzip, dictionary) {
+  auto dictionary = td::rand_string('a', 'z', 1000);
+  auto s = dictionary.substr(100, 300) + dictionary.substr(500, 300);
+  auto r = td::gzencode(s, 2, dictionary);
+  ASSERT_TRUE(!r.empty());
+  ASSERT_TRUE(r.size() * 4 < td::gzencode(s, 2).size());
+  ASSERT_EQ(s, td::gzdecode(r.as_slice(), dictionary));
+  ASSERT_TRUE(td::gzdecode(r.as_slice()).empty());
+}
+
+TEST(Gzip, reset) {
+  auto dictionary = td::rand_string('a', 'z', 1000);
+  td::Gzip encoder;
+  encoder.init_encode(dictionary).ensure();
+  encoder.set_reusable();
+  td::Gzip decoder;
+  decoder.init_decode(dictionary).ensure();
+  decoder.set_reusable();
+  for (int i = 0; i < 10; i++) {
+    auto s = dictionary.substr(i * 50, 300) + td::rand_string('0', '9', 10);
+    if (i != 0) {
+      encoder.reset().ensure();
+    }
+    td::string encoded(1000, '\0');
+    encoder.set_input(s);
+    encoder.close_input();
+    encoder.set_output(encoded);
+    ASSERT_TRUE(encoder.run().ok() == td::Gzip::State::Done);
+    encoded.resize(encoder.flush_output());
+    ASSERT_TRUE(encoded.size() < 100u);
+    ASSERT_EQ(s, td::gzdecode(encoded, dictionary).as_slice());
+
+    if (i != 0) {
+      decoder.reset().ensure();
+    }
+    td::string decoded(1000, '\0');
+    decoder.set_input(encoded);
+    decoder.close_input();
+    decoder.set_output(decoded);
+    ASSERT_TRUE(decoder.run().ok() == td::Gzip::State::Done);
+    decoded.resize(decoder.flush_output());
+    ASSERT_EQ(s, decoded);
+
+    decoder.reset().ensure();
+    decoder.set_input(td::Slice(s).substr(0, 10));
+    decoder.close_input();
+    decoder.set_output(decoded);
+    ASSERT_TRUE(decoder.run().is_error());
+  }
+}
+
 static void test_gzencode(const td::string &s) {
   auto begin_time = td::Time::now();
   auto r = td::gzencode(s, td::max(2, static_cast<int>(100 / s.size())));
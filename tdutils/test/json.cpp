@@ -283,6 +283,19 @@ TEST(JSON, string_decode) {
   test_string_decode("\"\\u0373\\ud7FB\\uD840\\uDC04\\uD840a\\uD840\\u0373\"",
                      "\xCD\xB3\xED\x9F\xBB\xF0\xA0\x80\x84\xed\xa1\x80\x61\xed\xa1\x80\xCD\xB3");
 
+  for (size_t prefix_length = 0; prefix_length < 70; prefix_length++) {
+    for (size_t suffix_length = 0; suffix_length < 70; suffix_length += 23) {
+      td::string prefix(prefix_length, 'a');
+      td::string suffix(suffix_length, 'b');
+      test_string_decode('"' + prefix + '"', prefix);
+      test_string_decode('"' + prefix + "\\n" + suffix + '"', prefix + '\n' + suffix);
+      test_string_decode('"' + prefix + "\\\"" + suffix + "\\\\" + prefix + '"',
+                         prefix + '"' + suffix + '\\' + prefix);
+      test_string_decode_error('"' + prefix + suffix);
+      test_string_decode_error('"' + prefix + "\\\"" + suffix);
+    }
+  }
+
   test_string_decode_error(" \"\"");
   test_string_decode_error("\"");
   test_string_decode_error("\"\\");
@@ -5,6 +5,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/utils/algorithm.h"
+#include "td/utils/ArenaAllocator.h"
 #include "td/utils/as.h"
 #include "td/utils/base64.h"
 #include "td/utils/benchmark.h"
@@ -1430,3 +1431,48 @@ TEST(UniqueValuePtr, Basic) {
   ASSERT_TRUE(c == d);
   ASSERT_TRUE(6 == **d);
 }
+
+TEST(ArenaAllocator, Basic) {
+  struct Object {
+    td::uint64 value;
+    td::string text;
+
+    static void *operator new(std::size_t size) {
+      return td::ArenaAllocator::allocate(size);
+    }
+    static void operator delete(void *ptr) {
+      td::ArenaAllocator::deallocate(ptr);
+    }
+  };
+
+  auto heap_object = td::make_unique<Object>();
+  td::vector<td::unique_ptr<Object>> objects;
+  td::unique_ptr<Object> outliving_object;
+  {
+    td::ArenaAllocator arena;
+    td::ArenaAllocator::Guard guard(&arena);
+    for (int i = 0; i < 10000; i++) {
+      auto object = td::make_unique<Object>();
+      object->value = i;
+      object->text = td::to_string(i);
+      objects.push_back(std::move(object));
+    }
+    ASSERT_TRUE(arena.get_chunk_count() > 1);
+    ASSERT_TRUE(arena.get_chunk_count() < 100);
+    outliving_object = std::move(objects[5000]);
+
+    td::Random::Xorshift128plus rnd(123);
+    rand_shuffle(td::as_mutable_span(objects), rnd);
+    td::thread thread([&objects] {
+      for (size_t i = 0; i < objects.size() / 2; i++) {
+        objects[i] = nullptr;
+      }
+    });
+    thread.join();
+  }
+  objects.clear();
+  ASSERT_EQ(5000u, outliving_object->value);
+  ASSERT_EQ("5000", outliving_object->text);
+  outliving_object = nullptr;
+  heap_object->value = 1;
+}
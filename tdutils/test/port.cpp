@@ -12,6 +12,7 @@
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/IoSlice.h"
 #include "td/utils/port/path.h"
+#include "td/utils/port/Poll.h"
 #include "td/utils/port/signals.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/Stat.h"
@@ -295,6 +296,68 @@ TEST(Port, EventFdAndSignals) {
 #endif
 #endif
 
+#if !TD_EVENTFD_UNSUPPORTED
+static void test_poll() {
+  td::Poll poll;
+  poll.init();
+  td::vector<td::EventFd> event_fds(10);
+  for (auto &event_fd : event_fds) {
+    event_fd.init();
+    poll.subscribe(event_fd.get_poll_info().extract_pollable_fd(nullptr), td::PollFlags::Read());
+  }
+
+  for (int t = 0; t < 20; t++) {
+    poll.run(0);
+    for (auto &event_fd : event_fds) {
+      ASSERT_TRUE(!event_fd.get_poll_info().sync_with_poll().can_read());
+    }
+
+    auto &event_fd = event_fds[td::Random::fast(0, static_cast<int>(event_fds.size()) - 1)];
+    event_fd.release();
+    poll.run(1000);
+    ASSERT_TRUE(event_fd.get_poll_info().sync_with_poll().can_read());
+    event_fd.acquire();
+  }
+
+  for (auto &event_fd : event_fds) {
+    poll.unsubscribe_before_close(event_fd.get_poll_info().get_pollable_fd_ref());
+    event_fd.close();
+  }
+  poll.run(0);
+  poll.clear();
+}
+
+// subscribes to many ready file descriptors at once
+static void test_poll_many_ready() {
+  td::Poll poll;
+  poll.init();
+  td::vector<td::EventFd> event_fds(800);
+  for (auto &event_fd : event_fds) {
+    event_fd.init();
+    event_fd.release();
+    poll.subscribe(event_fd.get_poll_info().extract_pollable_fd(nullptr), td::PollFlags::Read());
+  }
+
+  poll.run(0);
+  for (auto &event_fd : event_fds) {
+    ASSERT_TRUE(event_fd.get_poll_info().sync_with_poll().can_read());
+    event_fd.acquire();
+  }
+
+  for (auto &event_fd : event_fds) {
+    poll.unsubscribe_before_close(event_fd.get_poll_info().get_pollable_fd_ref());
+    event_fd.close();
+  }
+  poll.run(0);
+  poll.clear();
+}
+
+TEST(Port, Poll) {
+  test_poll();
+  test_poll_many_ready();
+}
+#endif
+
 #if TD_HAVE_THREAD_AFFINITY
 TEST(Port, ThreadAffinityMask) {
   auto thread_id = td::this_thread::get_id();
@@ -6,9 +6,20 @@
 //
 #include "data.h"
 
+#include "td/telegram/DialogId.h"
+#include "td/telegram/MessageDb.h"
+#include "td/telegram/MessageId.h"
+#include "td/telegram/MessageSearchFilter.h"
+#include "td/telegram/MessageSearchIndex.h"
+#include "td/telegram/NotificationId.h"
+#include "td/telegram/ServerMessageId.h"
+#include "td/telegram/UserId.h"
+#include "td/telegram/Version.h"
+
 #include "td/db/binlog/BinlogHelper.h"
 #include "td/db/binlog/ConcurrentBinlog.h"
 #include "td/db/BinlogKeyValue.h"
+#include "td/db/BlobCodec.h"
 #include "td/db/DbKey.h"
 #include "td/db/SeqKeyValue.h"
 #include "td/db/SqliteConnectionSafe.h"
@@ -16,10 +27,13 @@
 #include "td/db/SqliteKeyValue.h"
 #include "td/db/SqliteKeyValueSafe.h"
 #include "td/db/TsSeqKeyValue.h"
+#include "td/db/WriteBatchPolicy.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
+#include "td/actor/SleepActor.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/base64.h"
 #include "td/utils/common.h"
 #include "td/utils/filesystem.h"
@@ -27,12 +41,16 @@
 #include "td/utils/logging.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/thread.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tests.h"
 
+#include <atomic>
 #include <limits>
 #include <map>
 #include <memory>
@@ -138,6 +156,309 @@ TEST(DB, binlog_encryption) {
   td::Binlog::destroy(binlog_name).ignore();
 }
 
+TEST(DB, binlog_group_commit) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  constexpr int EVENT_COUNT = 100;
+  int synced_event_count = 0;
+  td::BinlogStatistics lazy_statistics;
+  td::BinlogStatistics statistics;
+  {
+    td::ConcurrentScheduler sched(0, 0);
+    {
+      auto guard = sched.get_main_guard();
+      auto binlog = std::make_shared<td::ConcurrentBinlog>();
+      binlog->init(binlog_name.str(), [](const td::BinlogEvent &x) {}).ensure();
+      binlog->set_group_commit_window(0.01);
+
+      // events without a promise must not be synced
+      for (int i = 0; i < EVENT_COUNT; i++) {
+        binlog->add(1, td::create_storer("BBBB"));
+      }
+      auto add_synced_events = [&, binlog] {
+        for (int i = 0; i < EVENT_COUNT; i++) {
+          binlog->add(1, td::create_storer("AAAA"), td::PromiseCreator::lambda([&, binlog](td::Unit) {
+                        if (++synced_event_count != EVENT_COUNT) {
+                          return;
+                        }
+                        binlog->get_statistics(
+                            td::PromiseCreator::lambda([&, binlog](td::BinlogStatistics binlog_statistics) {
+                              statistics = binlog_statistics;
+                              binlog->close(td::PromiseCreator::lambda(
+                                  [](td::Unit) { td::Scheduler::instance()->finish(); }));
+                            }));
+                      }));
+        }
+      };
+      td::create_actor<td::SleepActor>(
+          "SleepActor", 0.05, td::PromiseCreator::lambda([&, binlog, add_synced_events](td::Unit) {
+            binlog->get_statistics(
+                td::PromiseCreator::lambda([&, add_synced_events](td::BinlogStatistics binlog_statistics) {
+                  lazy_statistics = binlog_statistics;
+                  add_synced_events();
+                }));
+          }))
+          .release();
+    }
+    sched.start();
+    while (sched.run_main(10)) {
+      // empty
+    }
+    sched.finish();
+  }
+  ASSERT_EQ(0u, lazy_statistics.sync_count);
+  ASSERT_EQ(EVENT_COUNT, synced_event_count);
+  ASSERT_EQ(1u, statistics.sync_count);
+
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, binlog_incremental_compaction) {
+  td::CSlice binlog_name = "test_binlog";
+  for (auto is_encrypted : {false, true}) {
+    auto db_key = is_encrypted ? td::DbKey::raw_key(td::string(32, 'A')) : td::DbKey::empty();
+    td::Binlog::destroy(binlog_name).ignore();
+
+    std::map<td::uint64, td::string> events;
+    td::BinlogStatistics statistics;
+    {
+      td::Binlog binlog;
+      binlog.init(binlog_name.str(), [](const td::BinlogEvent &x) {}, db_key).ensure();
+      binlog.set_incremental_compaction(true);
+      auto reindex_count = binlog.get_statistics().reindex_count;
+      for (int i = 0; i < 100000; i++) {
+        auto data = td::rand_string('a', 'z', 4 * td::Random::fast(1, 50));
+        auto op = td::Random::fast(0, 9);
+        if (events.empty() || op < 5) {
+          events[binlog.add(1, td::create_storer(data))] = data;
+        } else {
+          auto it = events.lower_bound(td::Random::fast_uint64() % (events.rbegin()->first + 1));
+          if (it == events.end()) {
+            it = events.begin();
+          }
+          if (op < 9) {
+            binlog.rewrite(it->first, 1, td::create_storer(data));
+            it->second = data;
+          } else {
+            binlog.erase(it->first);
+            events.erase(it);
+          }
+        }
+        if (i % 10 == 0 && binlog.need_compaction_step()) {
+          binlog.compaction_step();
+        }
+      }
+      statistics = binlog.get_statistics();
+      ASSERT_EQ(reindex_count, statistics.reindex_count);
+    }
+    ASSERT_TRUE(statistics.compaction_count > 0);
+
+    std::map<td::uint64, td::string> loaded_events;
+    td::Binlog binlog;
+    binlog
+        .init(
+            binlog_name.str(),
+            [&](const td::BinlogEvent &event) { loaded_events[event.id_] = event.get_data().str(); }, db_key)
+        .ensure();
+    ASSERT_TRUE(events == loaded_events);
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, binlog_reopen) {
+  td::CSlice binlog_name = "test_binlog";
+  for (auto is_encrypted : {false, true}) {
+    auto db_key = is_encrypted ? td::DbKey::raw_key(td::string(32, 'A')) : td::DbKey::empty();
+    td::Binlog::destroy(binlog_name).ignore();
+
+    td::vector<td::string> events;
+    for (int session = 0; session < 5; session++) {
+      td::vector<td::string> loaded_events;
+      td::Binlog binlog;
+      binlog
+          .init(
+              binlog_name.str(), [&](const td::BinlogEvent &event) { loaded_events.push_back(event.get_data().str()); },
+              db_key)
+          .ensure();
+      ASSERT_TRUE(events == loaded_events);
+
+      for (int i = 0; i < 100; i++) {
+        // some events are bigger than decryption chunks
+        auto size = i % 10 == 0 ? td::Random::fast(1, 1 << 18) : td::Random::fast(1, 25);
+        auto data = td::rand_string('a', 'z', 4 * size);
+        binlog.add(1, td::create_storer(data));
+        events.push_back(std::move(data));
+      }
+      binlog.close().ensure();
+
+      if (session == 2 && !is_encrypted) {
+        // the incomplete last event must be truncated
+        auto fd = td::FileFd::open(binlog_name, td::FileFd::Flags::Write | td::FileFd::Flags::Append).move_as_ok();
+        fd.write(td::Slice("\x40\0\0\0abacaba", 11)).ensure();
+      }
+    }
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, binlog_corrupted_tail) {
+  td::CSlice binlog_name = "test_binlog";
+  auto db_key = td::DbKey::raw_key(td::string(32, 'A'));
+  // zero bytes are often written to disk instead of the last events
+  for (auto tail_size : {3, 4096}) {
+    td::Binlog::destroy(binlog_name).ignore();
+
+    td::vector<td::string> events;
+    for (int session = 0; session < 3; session++) {
+      td::vector<td::string> loaded_events;
+      td::Binlog binlog;
+      binlog
+          .init(
+              binlog_name.str(), [&](const td::BinlogEvent &event) { loaded_events.push_back(event.get_data().str()); },
+              db_key)
+          .ensure();
+      ASSERT_TRUE(events == loaded_events);
+
+      // the binlog must span several decryption chunks
+      for (int i = 0; i < 400; i++) {
+        auto data = td::rand_string('a', 'z', 4 * td::Random::fast(1, 2000));
+        binlog.add(1, td::create_storer(data));
+        events.push_back(std::move(data));
+      }
+      binlog.close().ensure();
+
+      if (session == 0) {
+        auto fd = td::FileFd::open(binlog_name, td::FileFd::Flags::Write | td::FileFd::Flags::Append).move_as_ok();
+        ASSERT_TRUE(fd.get_size().move_as_ok() > (1 << 20));
+        fd.write(td::string(tail_size, '\0')).ensure();
+      }
+    }
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, binlog_parallel_replay) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+  {
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [](const td::BinlogEvent &event) {}).ensure();
+    td::vector<td::uint64> event_ids;
+    for (int i = 0; i < 20000; i++) {
+      auto data = td::rand_string('a', 'z', 4 * td::Random::fast(1, 12));
+      auto type = td::Random::fast(1, 6);
+      if (!event_ids.empty() && td::Random::fast(0, 5) == 0) {
+        auto pos = td::Random::fast(0, static_cast<int>(event_ids.size()) - 1);
+        if (td::Random::fast(0, 1) == 0) {
+          binlog.rewrite(event_ids[pos], type, td::create_storer(data));
+        } else {
+          binlog.erase(event_ids[pos]);
+          event_ids.erase(event_ids.begin() + pos);
+        }
+      } else {
+        event_ids.push_back(binlog.add(type, td::create_storer(data)));
+      }
+    }
+    binlog.close().ensure();
+  }
+
+  static constexpr size_t GROUP_COUNT = 4;
+  td::vector<td::vector<td::string>> expected_events(GROUP_COUNT + 1);
+  auto get_replay_group = [](const td::BinlogEvent &event) {
+    // events of the last two types are replayed by the main callback
+    return static_cast<size_t>(event.type_ - 1);
+  };
+  {
+    td::Binlog binlog;
+    binlog
+        .init(binlog_name.str(),
+              [&](const td::BinlogEvent &event) {
+                auto group = td::min(get_replay_group(event), GROUP_COUNT);
+                expected_events[group].push_back(event.get_data().str());
+              })
+        .ensure();
+    binlog.close().ensure();
+  }
+
+  for (auto thread_count : {0, 1, 2, 4}) {
+    td::vector<td::vector<td::string>> events(GROUP_COUNT + 1);
+    td::vector<td::Binlog::Callback> group_callbacks;
+    for (size_t i = 0; i < GROUP_COUNT; i++) {
+      group_callbacks.push_back([&events, i](const td::BinlogEvent &event) {
+        events[i].push_back(event.get_data().str());
+      });
+    }
+    td::Binlog binlog;
+    binlog.set_parallel_replay(get_replay_group, std::move(group_callbacks), thread_count);
+    binlog
+        .init(binlog_name.str(),
+              [&](const td::BinlogEvent &event) { events[GROUP_COUNT].push_back(event.get_data().str()); })
+        .ensure();
+    binlog.close().ensure();
+    ASSERT_TRUE(events == expected_events);
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, binlog_replay_thread_count) {
+  // the number of CPUs is unknown
+  ASSERT_EQ(1u, td::Binlog::get_replay_thread_count(4, 0));
+  ASSERT_EQ(1u, td::Binlog::get_replay_thread_count(0, 0));
+  ASSERT_EQ(1u, td::Binlog::get_replay_thread_count(0, 8));
+  ASSERT_EQ(1u, td::Binlog::get_replay_thread_count(-1, 8));
+  ASSERT_EQ(1u, td::Binlog::get_replay_thread_count(4, 1));
+  ASSERT_EQ(2u, td::Binlog::get_replay_thread_count(2, 8));
+  ASSERT_EQ(4u, td::Binlog::get_replay_thread_count(8, 4));
+}
+
+TEST(DB, write_batch_policy) {
+  using FlushReason = td::WriteBatchPolicy::FlushReason;
+  td::WriteBatchPolicy policy;
+  double now = 100;
+  auto min_write_count = policy.get_max_write_count();
+  auto min_delay = policy.on_batch_start(now);
+
+  // sustained load makes transactions bigger up to a limit
+  size_t write_count = 0;
+  for (int i = 0; i < 20; i++) {
+    auto max_write_count = policy.get_max_write_count();
+    policy.on_batch_start(now);
+    policy.on_transaction(FlushReason::Full, max_write_count, now, now + 0.001);
+    write_count += max_write_count;
+    now += 0.01;
+  }
+  auto max_write_count = policy.get_max_write_count();
+  ASSERT_TRUE(max_write_count > min_write_count);
+  ASSERT_TRUE(policy.on_batch_start(now) > min_delay);
+  policy.on_transaction(FlushReason::Full, max_write_count, now, now + 0.001);
+  ASSERT_EQ(max_write_count, policy.get_max_write_count());
+
+  // reads and forced flushes don't change limits
+  policy.on_transaction(FlushReason::Read, 1, now, now);
+  policy.on_transaction(FlushReason::Force, 1, now, now);
+  ASSERT_EQ(max_write_count, policy.get_max_write_count());
+
+  // small transactions shrink limits back
+  for (int i = 0; i < 20; i++) {
+    policy.on_batch_start(now);
+    policy.on_transaction(FlushReason::Timeout, 1, now, now + 0.001);
+  }
+  ASSERT_EQ(min_write_count, policy.get_max_write_count());
+  ASSERT_EQ(min_delay, policy.on_batch_start(now));
+
+  // limits are reset after a long idle period
+  policy.on_transaction(FlushReason::Full, min_write_count, now, now);
+  ASSERT_TRUE(policy.get_max_write_count() > min_write_count);
+  ASSERT_EQ(min_delay, policy.on_batch_start(now + 10));
+  ASSERT_EQ(min_write_count, policy.get_max_write_count());
+
+  const auto &statistics = policy.get_statistics();
+  ASSERT_EQ(44u, statistics.transaction_count);
+  ASSERT_EQ(write_count + max_write_count + 2 + 20 + min_write_count, statistics.write_count);
+  ASSERT_EQ(max_write_count, statistics.max_transaction_write_count);
+}
+
 TEST(DB, sqlite_lfs) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
@@ -147,6 +468,36 @@ TEST(DB, sqlite_lfs) {
   td::SqliteDb::destroy(path).ignore();
 }
 
+TEST(DB, sqlite_statement_cache) {
+  td::string path = "test_sqlite_db";
+  td::SqliteDb::destroy(path).ignore();
+  {
+    auto db = td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok();
+    db.exec("CREATE TABLE t (x INTEGER PRIMARY KEY)").ensure();
+    for (int i = 0; i < 3; i++) {
+      db.begin_write_transaction().ensure();
+      auto stmt = db.get_cached_statement("INSERT INTO t VALUES(?1)").move_as_ok();
+      stmt->bind_int32(1, i).ensure();
+      stmt->step().ensure();
+      stmt->reset();
+      db.commit_transaction().ensure();
+    }
+    auto statistics = db.get_statement_cache_statistics();
+    ASSERT_EQ(3u, statistics.size);
+    ASSERT_EQ(3u, statistics.miss_count);
+    ASSERT_EQ(6u, statistics.hit_count);
+
+    for (size_t i = 0; i < td::SqliteDb::STATEMENT_CACHE_SIZE + 10; i++) {
+      auto stmt = db.get_cached_statement(PSLICE() << "SELECT x FROM t WHERE x = " << i).move_as_ok();
+      stmt->step().ensure();
+      ASSERT_EQ(i < 3, stmt->has_row());
+      stmt->reset();
+    }
+    ASSERT_EQ(td::SqliteDb::STATEMENT_CACHE_SIZE, db.get_statement_cache_statistics().size);
+  }
+  td::SqliteDb::destroy(path).ignore();
+}
+
 TEST(DB, sqlite_encryption) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
@@ -886,3 +1237,337 @@ TEST(DB, persistent_key_value) {
   }
   td::SqliteDb::destroy(path).ignore();
 }
+
+TEST(DB, message_search_index) {
+  auto text = td::get_message_search_index_text("Hello, World! \xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 mir");
+  ASSERT_EQ(" hello world \xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 mir ", text);
+  auto text_trigrams = td::get_message_search_index_trigrams(text);
+
+  auto check = [&](td::Slice query, bool expected) {
+    auto patterns = td::get_message_search_index_patterns(query);
+    ASSERT_EQ(expected, td::match_message_search_index_patterns(text, patterns));
+    for (auto &word_patterns : patterns) {
+      for (auto &pattern : word_patterns) {
+        if (text.find(pattern) != td::string::npos) {
+          // the index must contain all trigrams of matching patterns
+          for (auto trigram : td::get_message_search_index_trigrams(pattern)) {
+            ASSERT_TRUE(td::contains(text_trigrams, trigram));
+          }
+        }
+      }
+    }
+  };
+  check("world", true);
+  check("ORL", true);
+  check("wo", true);
+  check("or", false);
+  check("hello mir", true);
+  check("hello xyz", false);
+  check("privet", true);
+  check("\xD0\xBC\xD0\xB8\xD1\x80", true);
+  check("w", true);
+  check("o", false);
+  check("", true);
+}
+
+TEST(DB, message_db_search_index) {
+  td::string path = "test_message_db";
+  td::ConcurrentScheduler sched(0, 0);
+  auto guard = sched.get_main_guard();
+  td::SqliteDb::destroy(path).ignore();
+  auto connection = std::make_shared<td::SqliteConnectionSafe>(path, td::DbKey::empty());
+  connection->set(td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok());
+  auto &sqlite_db = connection->get();
+  td::init_message_db(sqlite_db, 0).ensure();
+  td::init_message_search_index(sqlite_db, true).ensure();
+  auto message_db_sync_safe = td::create_message_db_sync(connection);
+  auto &message_db = message_db_sync_safe->get();
+
+  auto add_message = [&](td::int64 dialog_id, td::int32 message_id, td::int64 sender_user_id, td::int32 index_mask,
+                         td::int64 search_id, td::string text) {
+    message_db.add_message({td::DialogId(dialog_id), td::MessageId(td::ServerMessageId(message_id))},
+                           td::ServerMessageId(), td::DialogId(td::UserId(sender_user_id)), 0, 0, index_mask,
+                           search_id, std::move(text), td::NotificationId(), td::MessageId(), td::BufferSlice("data"));
+  };
+  auto search = [&](td::string query, td::int64 dialog_id = 0,
+                    td::MessageSearchFilter filter = td::MessageSearchFilter::Empty) {
+    td::MessageDbFtsQuery fts_query;
+    fts_query.query = std::move(query);
+    fts_query.dialog_id = td::DialogId(dialog_id);
+    fts_query.filter = filter;
+    return td::transform(message_db.get_messages_fts(std::move(fts_query)).messages,
+                         [](const td::MessageDbMessage &message) {
+                           return message.message_id.get_server_message_id().get();
+                         });
+  };
+  auto get_index_size = [&](td::int64 search_id) {
+    auto stmt = sqlite_db
+                    .get_statement(PSLICE() << "SELECT COUNT(*) FROM messages_search_index WHERE search_id = "
+                                            << search_id)
+                    .move_as_ok();
+    stmt.step().ensure();
+    return static_cast<size_t>(stmt.view_int64(0));
+  };
+  auto get_key_count = [](td::Slice text) {
+    return td::get_message_search_index_trigrams(td::get_message_search_index_text(text)).size();
+  };
+  using Ids = td::vector<td::int32>;
+
+  auto photo_mask = td::message_search_filter_index_mask(td::MessageSearchFilter::Photo);
+  add_message(1, 1, 10, 0, 1, "hello world");
+  add_message(1, 2, 11, photo_mask, 2, "hello photo");
+  add_message(2, 3, 10, 0, 3, "Hello there");
+  ASSERT_EQ(get_key_count("hello world"), get_index_size(1));
+  ASSERT_EQ(get_key_count("hello photo"), get_index_size(2));
+  ASSERT_EQ(get_key_count("hello there"), get_index_size(3));
+  ASSERT_EQ(Ids({3, 2, 1}), search("hello"));
+  ASSERT_EQ(Ids({2, 1}), search("hello", 1));
+  ASSERT_EQ(Ids({2}), search("hello", 0, td::MessageSearchFilter::Photo));
+  ASSERT_EQ(Ids(), search("hello", 2, td::MessageSearchFilter::Photo));
+  ASSERT_EQ(Ids({1}), search("w"));
+  ASSERT_EQ(Ids({2}), search("p", 1));
+  ASSERT_EQ(Ids(), search("x"));
+  ASSERT_EQ(Ids({3}), search("HEL th"));
+  ASSERT_EQ(Ids({1}), search("HEL w"));
+  ASSERT_EQ(Ids(), search("HEL th w"));
+
+  // replaced messages must be removed from the index
+  add_message(1, 1, 10, 0, 4, "goodbye world");
+  ASSERT_EQ(0u, get_index_size(1));
+  ASSERT_EQ(get_key_count("goodbye world"), get_index_size(4));
+  ASSERT_EQ(Ids({3, 2}), search("hello"));
+  ASSERT_EQ(Ids({1}), search("goodbye"));
+
+  message_db.delete_message({td::DialogId(static_cast<td::int64>(1)), td::MessageId(td::ServerMessageId(2))});
+  ASSERT_EQ(0u, get_index_size(2));
+  ASSERT_EQ(Ids({3}), search("hello"));
+
+  message_db.delete_dialog_messages_by_sender(td::DialogId(static_cast<td::int64>(2)),
+                                              td::DialogId(td::UserId(static_cast<td::int64>(10))));
+  ASSERT_EQ(0u, get_index_size(3));
+  ASSERT_EQ(Ids(), search("hello"));
+
+  message_db.delete_all_dialog_messages(td::DialogId(static_cast<td::int64>(1)),
+                                        td::MessageId(td::ServerMessageId(1)));
+  ASSERT_EQ(0u, get_index_size(4));
+  ASSERT_EQ(Ids(), search("world"));
+
+  auto stmt = sqlite_db.get_statement("SELECT COUNT(*) FROM messages_search_index").move_as_ok();
+  stmt.step().ensure();
+  ASSERT_EQ(0, stmt.view_int64(0));
+  stmt = td::SqliteStatement();
+
+  message_db_sync_safe.reset();
+  connection->close_and_destroy();
+}
+
+TEST(DB, message_db_readers) {
+  td::string path = "test_message_db_readers";
+  constexpr int READER_COUNT = 2;
+  constexpr int MESSAGE_COUNT = 100;
+  td::ConcurrentScheduler sched(READER_COUNT, 0);
+  std::shared_ptr<td::SqliteConnectionSafe> connection;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe;
+  std::shared_ptr<td::MessageDbAsyncInterface> message_db_async;
+  std::atomic<int> received_count{0};
+  std::atomic<bool> is_closed{false};
+  {
+    auto guard = sched.get_main_guard();
+    td::SqliteDb::destroy(path).ignore();
+    connection = std::make_shared<td::SqliteConnectionSafe>(path, td::DbKey::empty());
+    connection->set(td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok());
+    auto &sqlite_db = connection->get();
+    sqlite_db.exec("PRAGMA journal_mode=WAL").ensure();
+    td::init_message_db(sqlite_db, 0).ensure();
+    message_db_sync_safe = td::create_message_db_sync(connection);
+    message_db_async = td::create_message_db_async(message_db_sync_safe, 0, {1, 2});
+
+    // each query must see all messages added before it, even if they weren't committed yet
+    auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(1)));
+    for (int i = 1; i <= MESSAGE_COUNT; i++) {
+      auto message_id = td::MessageId(td::ServerMessageId(i));
+      message_db_async->add_message({dialog_id, message_id}, td::ServerMessageId(), dialog_id, 0, 0, 0, 0, "",
+                                    td::NotificationId(), td::MessageId(), td::BufferSlice(PSLICE() << "data" << i),
+                                    td::Promise<td::Unit>());
+      td::MessageDbMessagesQuery query;
+      query.dialog_id = dialog_id;
+      query.from_message_id = td::MessageId::max();
+      query.limit = MESSAGE_COUNT;
+      message_db_async->get_messages(
+          std::move(query),
+          td::PromiseCreator::lambda([&, i, message_id](td::vector<td::MessageDbDialogMessage> messages) {
+            // messages added after the query can be seen too
+            ASSERT_TRUE(messages.size() >= static_cast<size_t>(i));
+            const auto &message = messages[messages.size() - i];
+            ASSERT_EQ(message_id, message.message_id);
+            ASSERT_EQ(PSTRING() << "data" << i, message.data.as_slice().str());
+            if (++received_count == MESSAGE_COUNT) {
+              message_db_async->close(td::PromiseCreator::lambda([&](td::Unit) { is_closed = true; }));
+            }
+          }));
+    }
+  }
+  sched.start();
+  while (!is_closed.load()) {
+    sched.run_main(0.01);
+  }
+  {
+    auto guard = sched.get_main_guard();
+    message_db_async.reset();
+    message_db_sync_safe.reset();
+    connection->close_and_destroy();
+    connection.reset();
+  }
+  sched.finish();
+  ASSERT_EQ(MESSAGE_COUNT, received_count.load());
+}
+
+TEST(DB, message_db_compression) {
+  if (td::BlobCodec::create(td::BlobCodec::Type::Gzip, td::string()) == nullptr) {
+    return;
+  }
+
+  td::string path = "test_message_db_compression";
+  td::ConcurrentScheduler sched(0, 0);
+  auto guard = sched.get_main_guard();
+  td::SqliteDb::destroy(path).ignore();
+  auto connection = std::make_shared<td::SqliteConnectionSafe>(path, td::DbKey::empty());
+  connection->set(td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok());
+  auto &sqlite_db = connection->get();
+  td::init_message_db(sqlite_db, 0).ensure();
+
+  auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(1)));
+  auto common_parts = td::vector<td::string>{td::rand_string('a', 'z', 600), td::rand_string('a', 'z', 500),
+                                              td::rand_string('a', 'z', 400)};
+  auto get_data = [&](int i) {
+    return common_parts[0] + td::rand_string('0', '9', 20) + common_parts[i % 2 + 1] + td::rand_string('0', '9', 20);
+  };
+  td::FlatHashMap<td::int32, td::string> message_data;
+  auto add_message = [&](td::MessageDbSyncInterface &message_db, td::int32 server_message_id, td::string text) {
+    auto data = get_data(server_message_id);
+    message_db.add_message({dialog_id, td::MessageId(td::ServerMessageId(server_message_id))}, td::ServerMessageId(),
+                           dialog_id, 0, 0, 0, server_message_id, std::move(text), td::NotificationId(),
+                           td::MessageId(), td::BufferSlice(data));
+    message_data[server_message_id] = std::move(data);
+  };
+  auto get_stored_data = [&](td::int32 server_message_id) {
+    auto stmt = sqlite_db
+                    .get_statement(PSLICE() << "SELECT data FROM messages WHERE search_id = " << server_message_id)
+                    .move_as_ok();
+    stmt.step().ensure();
+    CHECK(stmt.has_row());
+    return stmt.view_blob(0).str();
+  };
+
+  // rows written before DbVersion::AddMessageDbCompression are stored uncompressed
+  const td::int32 LEGACY_MESSAGE_COUNT = 600;
+  {
+    auto message_db_sync_safe = td::create_message_db_sync(connection);
+    auto &message_db = message_db_sync_safe->get();
+    for (td::int32 i = 1; i < LEGACY_MESSAGE_COUNT; i++) {
+      add_message(message_db, i, "legacy message");
+    }
+    add_message(message_db, LEGACY_MESSAGE_COUNT, "legacy hello");
+  }
+  ASSERT_EQ(message_data[LEGACY_MESSAGE_COUNT], get_stored_data(LEGACY_MESSAGE_COUNT));
+  sqlite_db.exec("DROP TABLE message_data_dictionaries").ensure();
+  td::init_message_db(sqlite_db, static_cast<td::int32>(td::DbVersion::AddMessageDbCompression) - 1).ensure();
+  td::init_message_data_compression(sqlite_db).ensure();
+
+  auto message_db_sync_safe = td::create_message_db_sync(connection);
+  auto &message_db = message_db_sync_safe->get();
+  const td::int32 NEW_MESSAGE_ID = LEGACY_MESSAGE_COUNT + 1;
+  add_message(message_db, NEW_MESSAGE_ID, "compressed hello");
+  auto stored_data = get_stored_data(NEW_MESSAGE_ID);
+  ASSERT_TRUE(stored_data.size() < message_data[NEW_MESSAGE_ID].size());
+
+  for (auto server_message_id : {LEGACY_MESSAGE_COUNT, NEW_MESSAGE_ID}) {
+    auto message_id = td::MessageId(td::ServerMessageId(server_message_id));
+    auto r_message = message_db.get_message({dialog_id, message_id});
+    ASSERT_TRUE(r_message.is_ok());
+    ASSERT_EQ(message_id, r_message.ok().message_id);
+    ASSERT_EQ(message_data[server_message_id], r_message.ok().data.as_slice().str());
+  }
+
+  td::MessageDbMessagesQuery query;
+  query.dialog_id = dialog_id;
+  query.from_message_id = td::MessageId::max();
+  query.limit = 2;
+  auto messages = message_db.get_messages(std::move(query));
+  ASSERT_EQ(2u, messages.size());
+  ASSERT_EQ(td::MessageId(td::ServerMessageId(NEW_MESSAGE_ID)), messages[0].message_id);
+  ASSERT_EQ(td::MessageId(td::ServerMessageId(LEGACY_MESSAGE_COUNT)), messages[1].message_id);
+  for (auto &message : messages) {
+    ASSERT_EQ(message_data[message.message_id.get_server_message_id().get()], message.data.as_slice().str());
+  }
+
+  td::MessageDbFtsQuery fts_query;
+  fts_query.query = "hello";
+  auto fts_messages = message_db.get_messages_fts(std::move(fts_query)).messages;
+  ASSERT_EQ(2u, fts_messages.size());
+  for (auto &message : fts_messages) {
+    ASSERT_EQ(dialog_id, message.dialog_id);
+    ASSERT_EQ(message_data[message.message_id.get_server_message_id().get()], message.data.as_slice().str());
+  }
+
+  message_db_sync_safe.reset();
+  connection->close_and_destroy();
+}
+
+TEST(DB, blob_codec) {
+  auto codec = td::BlobCodec::create(td::BlobCodec::Type::Gzip, td::string());
+  if (codec == nullptr) {
+    return;
+  }
+
+  auto common_parts = td::vector<td::string>{td::rand_string('a', 'z', 200), td::rand_string('a', 'z', 300),
+                                              td::rand_string('a', 'z', 100)};
+  td::vector<td::string> samples;
+  for (int i = 0; i < 200; i++) {
+    samples.push_back(common_parts[0] + td::rand_string('0', '9', 20) + common_parts[i % 2 + 1] +
+                      td::rand_string('0', '9', 20));
+  }
+  auto dictionary = td::BlobCodec::train_dictionary(td::transform(samples, [](const td::string &sample) {
+    return td::Slice(sample);
+  }), 1000);
+  ASSERT_TRUE(dictionary.size() <= 1000u);
+  ASSERT_TRUE(dictionary.size() >= 400u);
+
+  auto dictionary_codec = td::BlobCodec::create(td::BlobCodec::Type::Gzip, dictionary);
+  ASSERT_TRUE(dictionary_codec != nullptr);
+  ASSERT_TRUE(dictionary_codec->get_type() == td::BlobCodec::Type::Gzip);
+  size_t total_size = 0;
+  size_t compressed_size = 0;
+  size_t dictionary_compressed_size = 0;
+  for (auto &sample : samples) {
+    auto compressed = codec->compress(sample, sample.size());
+    auto dictionary_compressed = dictionary_codec->compress(sample, sample.size());
+    ASSERT_TRUE(!compressed.empty());
+    ASSERT_TRUE(!dictionary_compressed.empty());
+    ASSERT_EQ(sample, codec->decompress(compressed.as_slice()).ok().as_slice());
+    ASSERT_EQ(sample, dictionary_codec->decompress(dictionary_compressed.as_slice()).ok().as_slice());
+    ASSERT_TRUE(codec->decompress(dictionary_compressed.as_slice()).is_error());
+
+    total_size += sample.size();
+    compressed_size += compressed.size();
+    dictionary_compressed_size += dictionary_compressed.size();
+  }
+  LOG(INFO) << "Compressed " << total_size << " bytes to " << compressed_size << " bytes without dictionary and to "
+            << dictionary_compressed_size << " bytes with dictionary";
+  ASSERT_TRUE(dictionary_compressed_size * 3 < compressed_size);
+  ASSERT_TRUE(codec->compress(samples[0], 10).empty());
+
+  // the codec must remain usable after failures
+  auto compressed = dictionary_codec->compress(samples[1], samples[1].size());
+  ASSERT_TRUE(dictionary_codec->compress(samples[0], 10).empty());
+  ASSERT_TRUE(dictionary_codec->decompress(compressed.as_slice().substr(0, compressed.size() / 2)).is_error());
+  ASSERT_TRUE(dictionary_codec->decompress(td::Slice(samples[2])).is_error());
+  ASSERT_EQ(samples[1], dictionary_codec->decompress(compressed.as_slice()).ok().as_slice());
+  ASSERT_EQ(compressed.as_slice(), dictionary_codec->compress(samples[1], samples[1].size()).as_slice());
+
+  auto big_sample = td::string(1000000, 'a');
+  auto big_compressed = dictionary_codec->compress(big_sample, big_sample.size());
+  ASSERT_TRUE(!big_compressed.empty());
+  ASSERT_EQ(big_sample, dictionary_codec->decompress(big_compressed.as_slice()).ok().as_slice());
+  ASSERT_EQ(samples[1], dictionary_codec->decompress(compressed.as_slice()).ok().as_slice());
+}
@@ -10,15 +10,21 @@
 #include "td/telegram/telegram_api.h"
 
 #include "td/mtproto/AuthData.h"
+#include "td/mtproto/AuthKey.h"
 #include "td/mtproto/DhCallback.h"
 #include "td/mtproto/DhHandshake.h"
 #include "td/mtproto/Handshake.h"
 #include "td/mtproto/HandshakeActor.h"
+#include "td/mtproto/MessageId.h"
+#include "td/mtproto/MtprotoQuery.h"
+#include "td/mtproto/MtprotoQueryQueue.h"
 #include "td/mtproto/Ping.h"
 #include "td/mtproto/PingConnection.h"
 #include "td/mtproto/ProxySecret.h"
 #include "td/mtproto/RawConnection.h"
 #include "td/mtproto/RSA.h"
+#include "td/mtproto/SessionConnection.h"
+#include "td/mtproto/TcpTransport.h"
 #include "td/mtproto/TlsInit.h"
 #include "td/mtproto/TransportType.h"
 
@@ -29,14 +35,19 @@
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
 
+#include "td/utils/algorithm.h"
+#include "td/utils/as.h"
 #include "td/utils/base64.h"
+#include "td/utils/buffer.h"
 #include "td/utils/BufferedFd.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
 #include "td/utils/HttpDate.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
+#include "td/utils/port/detail/PollableFd.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/port/SocketFd.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Random.h"
@@ -45,6 +56,8 @@
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
 
 #include <memory>
 
@@ -722,6 +735,102 @@ TEST(Mtproto, TlsTransport) {
   sched.finish();
 }
 
+static constexpr size_t MAX_TLS_RECORD_SIZE = 2878;
+
+// returns sizes of TLS records, in which the previous implementation of ObfuscatedTransport split a message;
+// it prepended the header to the first chunk of MAX_TLS_RECORD_SIZE - header_size bytes and cleared the header,
+// so all the following chunks had full size
+static td::vector<size_t> get_old_tls_record_sizes(size_t message_size, size_t header_size) {
+  if (message_size + header_size <= MAX_TLS_RECORD_SIZE) {
+    return {message_size + header_size};
+  }
+  td::vector<size_t> result;
+  auto first_chunk_size = MAX_TLS_RECORD_SIZE - header_size;
+  result.push_back(first_chunk_size + header_size);
+  message_size -= first_chunk_size;
+  while (message_size > 0) {
+    auto chunk_size = td::min(message_size, MAX_TLS_RECORD_SIZE);
+    result.push_back(chunk_size);
+    message_size -= chunk_size;
+  }
+  return result;
+}
+
+// splits the output into TLS records and returns their sizes; payloads of the records are appended to payload
+static td::vector<size_t> parse_tls_records(td::Slice data, td::string &payload) {
+  td::vector<size_t> result;
+  while (!data.empty()) {
+    CHECK(data.size() >= 5);
+    CHECK(data.substr(0, 3) == td::Slice("\x17\x03\x03"));
+    auto record_size = static_cast<size_t>(data.ubegin()[3]) * 256 + data.ubegin()[4];
+    CHECK(data.size() >= 5 + record_size);
+    payload.append(data.substr(5, record_size).str());
+    result.push_back(record_size);
+    data.remove_prefix(5 + record_size);
+  }
+  return result;
+}
+
+TEST(Mtproto, ObfuscatedTransportTlsRecords) {
+  auto secret = td::mtproto::ProxySecret::from_raw(td::string("\xee") + "0123456789secret" + "www.google.com");
+  td::mtproto::tcp::ObfuscatedTransport transport(2, secret);
+  td::ChainBufferWriter input_writer;
+  auto input_reader = input_writer.extract_reader();
+  td::ChainBufferWriter output_writer;
+  auto output_reader = output_writer.extract_reader();
+  transport.init(&input_reader, &output_writer);
+
+  const size_t header_size = 64;
+  td::string payload;
+  td::vector<td::string> messages;
+  bool is_first = true;
+  for (auto message_size : td::vector<size_t>{20000, 4, 2868, 2872, 2876, 2880, 3 * MAX_TLS_RECORD_SIZE - 2, 100000}) {
+    auto message = td::rand_string('a', 'z', message_size);
+    td::BufferWriter writer(message, transport.max_prepend_size(), transport.max_append_size());
+    transport.write(std::move(writer), false);
+    messages.push_back(message);
+
+    output_reader.sync_with_writer();
+    td::string output(output_reader.size(), '\0');
+    output_reader.advance(output.size(), output);
+    td::Slice data = output;
+    if (is_first) {
+      ASSERT_EQ(td::Slice("\x14\x03\x03\x00\x01\x01"), data.substr(0, 6));
+      data.remove_prefix(6);
+    }
+    auto old_payload_size = payload.size();
+    auto record_sizes = parse_tls_records(data, payload);
+    auto written_size = payload.size() - old_payload_size - (is_first ? header_size : 0);
+    // 4 bytes of length and up to 15 bytes of padding are added to the message
+    ASSERT_TRUE(written_size >= message_size + 4 && written_size < message_size + 4 + 16);
+    ASSERT_EQ(get_old_tls_record_sizes(written_size, is_first ? header_size : 0), record_sizes);
+    is_first = false;
+  }
+
+  // decrypt the reassembled payload and compare it with the sent messages
+  td::string key = payload.substr(8, 32);
+  td::Sha256State sha256_state;
+  sha256_state.init();
+  sha256_state.feed(key);
+  sha256_state.feed(secret.get_proxy_secret());
+  sha256_state.extract(td::MutableSlice(key));
+  td::AesCtrState aes_state;
+  aes_state.init(key, td::Slice(payload).substr(40, 16));
+  td::string decrypted(payload.size(), '\0');
+  aes_state.encrypt(payload, decrypted);
+  ASSERT_EQ(0xddddddddu, static_cast<td::uint32>(td::as<td::uint32>(decrypted.data() + 56)));
+
+  td::Slice stream = td::Slice(decrypted).substr(header_size);
+  for (auto &message : messages) {
+    ASSERT_TRUE(stream.size() >= 4);
+    td::uint32 length = td::as<td::uint32>(stream.data());
+    ASSERT_TRUE(stream.size() >= 4 + length);
+    ASSERT_EQ(td::Slice(message), stream.substr(4, message.size()));
+    stream.remove_prefix(4 + length);
+  }
+  ASSERT_TRUE(stream.empty());
+}
+
 TEST(Mtproto, RSA) {
   auto pem = td::Slice(
       "-----BEGIN RSA PUBLIC KEY-----\n"
@@ -740,3 +849,361 @@ TEST(Mtproto, RSA) {
   rsa.encrypt(pem.substr(0, 256), to);
   ASSERT_EQ("U2nJEtB2AgpHrm3HB0yhpTQgb0wbesi9Pv/W1v/vULU=", td::base64_encode(td::sha256(to)));
 }
+
+static td::mtproto::MtprotoQuery create_query(td::uint64 message_id, size_t size, bool use_quick_ack = false) {
+  return td::mtproto::MtprotoQuery{td::mtproto::MessageId(message_id), 0, td::BufferSlice(size), false, {},
+                                   use_quick_ack};
+}
+
+static td::vector<td::uint64> get_message_ids(const td::vector<td::mtproto::MtprotoQuery> &queries) {
+  return td::transform(queries, [](const auto &query) { return query.message_id.get(); });
+}
+
+TEST(Mtproto, MtprotoQueryQueuePacking) {
+  using td::mtproto::MtprotoQueryQueue;
+  MtprotoQueryQueue queue;
+  queue.set_packing_delay(0.01);
+  ASSERT_EQ(10.0 + 0.01, queue.push(create_query(4, 100), false, 10.0));
+  ASSERT_EQ(10.0 + 0.01, queue.push(create_query(8, 200), false, 10.005));
+  // the window isn't extended by subsequent queries
+  ASSERT_EQ(10.0 + 0.01, queue.push(create_query(12, 300), false, 10.009));
+  ASSERT_EQ(3u, queue.size());
+  ASSERT_EQ((td::vector<td::uint64>{4, 8, 12}), get_message_ids(queue.pop_container()));
+  ASSERT_TRUE(queue.empty());
+
+  // the window starts again after the queries were sent
+  ASSERT_EQ(20.0 + 0.01, queue.push(create_query(16, 100), false, 20.0));
+  ASSERT_EQ(1u, queue.pop_container().size());
+
+  // urgent queries bypass the delay
+  ASSERT_EQ(30.0 + 0.01, queue.push(create_query(20, 100), false, 30.0));
+  ASSERT_EQ(30.001, queue.push(create_query(24, 100, true), false, 30.001));
+  ASSERT_EQ(30.001, queue.push(create_query(28, 100), false, 30.002));
+  ASSERT_EQ(3u, queue.pop_container().size());
+  ASSERT_EQ(40.0, queue.push(create_query(32, 100), true, 40.0));
+  ASSERT_EQ(1u, queue.pop_container().size());
+  ASSERT_EQ(50.0, queue.push(create_query(36, MtprotoQueryQueue::MAX_PACKED_QUERY_SIZE + 1), false, 50.0));
+  ASSERT_EQ(1u, queue.pop_container().size());
+
+  // there is no reason to wait after a container is filled
+  for (size_t i = 1; i < MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT; i++) {
+    ASSERT_EQ(60.0 + 0.01, queue.push(create_query(i * 4, 1), false, 60.0));
+  }
+  ASSERT_EQ(60.0, queue.push(create_query(MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT * 4, 1), false, 60.0));
+  ASSERT_EQ(60.0, queue.push(create_query(MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT * 4 + 4, 1), false, 60.0));
+  ASSERT_EQ(MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT, queue.pop_container().size());
+  ASSERT_EQ((td::vector<td::uint64>{MtprotoQueryQueue::MAX_CONTAINER_QUERY_COUNT * 4 + 4}),
+            get_message_ids(queue.pop_container()));
+  ASSERT_TRUE(queue.empty());
+
+  queue.set_packing_delay(0.0);
+  ASSERT_EQ(70.0, queue.push(create_query(4, 100), false, 70.0));
+  queue.clear();
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(Mtproto, MtprotoQueryQueueOrder) {
+  using td::mtproto::MtprotoQueryQueue;
+  MtprotoQueryQueue queue;
+  const size_t big_size = MtprotoQueryQueue::MAX_CONTAINER_SIZE / 2 + 1;
+  queue.push(create_query(4, big_size), false, 1.0);
+  queue.push(create_query(8, big_size), false, 1.0);
+  queue.push(create_query(12, 100), false, 1.0);
+  queue.push(create_query(16, MtprotoQueryQueue::MAX_CONTAINER_SIZE * 2), false, 1.0);
+  queue.push(create_query(20, 100), false, 1.0);
+
+  // a small query isn't sent before a bigger query that didn't fit in the previous container
+  ASSERT_EQ((td::vector<td::uint64>{4}), get_message_ids(queue.pop_container()));
+  ASSERT_EQ((td::vector<td::uint64>{8, 12}), get_message_ids(queue.pop_container()));
+  // a query bigger than the container size is sent alone
+  ASSERT_EQ((td::vector<td::uint64>{16}), get_message_ids(queue.pop_container()));
+  ASSERT_EQ((td::vector<td::uint64>{20}), get_message_ids(queue.pop_container()));
+  ASSERT_TRUE(queue.empty());
+}
+
+class CountingRawConnection final : public td::mtproto::RawConnection {
+ public:
+  explicit CountingRawConnection(size_t *packet_count) : packet_count_(packet_count) {
+  }
+
+  void set_connection_token(td::mtproto::ConnectionManager::ConnectionToken connection_token) final {
+  }
+
+  bool can_send() const final {
+    return true;
+  }
+
+  td::mtproto::TransportType get_transport_type() const final {
+    return td::mtproto::TransportType{};
+  }
+
+  size_t send_crypto(const td::Storer &storer, td::uint64 session_id, td::int64 salt,
+                     const td::mtproto::AuthKey &auth_key, td::uint64 quick_ack_token) final {
+    ++*packet_count_;
+    return storer.size();
+  }
+
+  void send_no_crypto(const td::Storer &storer) final {
+    UNREACHABLE();
+  }
+
+  td::PollableFdInfo &get_poll_info() final {
+    return poll_info_;
+  }
+
+  StatsCallback *stats_callback() final {
+    return nullptr;
+  }
+
+  td::Status flush(const td::mtproto::AuthKey &auth_key, Callback &callback) final {
+    return callback.before_write();
+  }
+
+  bool has_error() const final {
+    return false;
+  }
+
+  void close() final {
+  }
+
+  PublicFields &extra() final {
+    return extra_;
+  }
+
+  const PublicFields &extra() const final {
+    return extra_;
+  }
+
+ private:
+  size_t *packet_count_;
+  td::PollableFdInfo poll_info_;
+  PublicFields extra_;
+};
+
+class ContainerCountingCallback final : public td::mtproto::SessionConnection::Callback {
+ public:
+  td::vector<size_t> container_sizes;
+
+  void on_connected() final {
+  }
+  void on_closed(td::Status status) final {
+  }
+  void on_server_salt_updated() final {
+  }
+  void on_server_time_difference_updated(bool force) final {
+  }
+  void on_new_session_created(td::uint64 unique_id, td::mtproto::MessageId first_message_id) final {
+  }
+  void on_session_failed(td::Status status) final {
+  }
+  void on_container_sent(td::mtproto::MessageId container_message_id,
+                         td::vector<td::mtproto::MessageId> message_ids) final {
+    container_sizes.push_back(message_ids.size());
+  }
+  td::Status on_pong(double ping_time, double pong_time, double current_time) final {
+    return td::Status::OK();
+  }
+  td::Status on_update(td::BufferSlice packet) final {
+    return td::Status::OK();
+  }
+  void on_message_ack(td::mtproto::MessageId message_id) final {
+  }
+  td::Status on_message_result_ok(td::mtproto::MessageId message_id, td::BufferSlice packet,
+                                  size_t original_size) final {
+    return td::Status::OK();
+  }
+  void on_message_result_error(td::mtproto::MessageId message_id, int code, td::string message) final {
+  }
+  void on_message_failed(td::mtproto::MessageId message_id, td::Status status) final {
+  }
+  void on_message_info(td::mtproto::MessageId message_id, td::int32 state, td::mtproto::MessageId answer_message_id,
+                       td::int32 answer_size, td::int32 source) final {
+  }
+  td::Status on_destroy_auth_key() final {
+    return td::Status::OK();
+  }
+};
+
+TEST(Mtproto, SessionConnectionQueryPacking) {
+  td::mtproto::AuthData auth_data;
+  auth_data.set_use_pfs(false);
+  auth_data.set_session_id(1);
+  auth_data.set_main_auth_key(td::mtproto::AuthKey(1, td::string(256, 'a')));
+  auth_data.set_server_salt(1, td::Time::now());
+
+  size_t packet_count = 0;
+  td::mtproto::SessionConnection connection(td::mtproto::SessionConnection::Mode::Tcp,
+                                            td::make_unique<CountingRawConnection>(&packet_count), &auth_data);
+  connection.set_query_packing_delay(0.2);
+  ContainerCountingCallback callback;
+
+  // the first packet contains only a ping and a request for future salts
+  connection.flush(&callback);
+  ASSERT_EQ(1u, packet_count);
+
+  const size_t query_count = 100;
+  td::Time::now();
+  for (size_t i = 0; i < query_count; i++) {
+    connection.send_query(td::BufferSlice(16), false, td::mtproto::MessageId(), {}, false, false);
+  }
+  // nothing is sent before the packing delay expires
+  connection.flush(&callback);
+  ASSERT_EQ(1u, packet_count);
+
+  td::usleep_for(250000);
+  connection.flush(&callback);
+  ASSERT_EQ(2u, packet_count);
+  // the first container has no queries
+  ASSERT_EQ((td::vector<size_t>{0, query_count}), callback.container_sizes);
+}
+
+template <class F>
+static td::BufferSlice serialize_tl(const F &store) {
+  td::TlStorerCalcLength calc_length;
+  store(calc_length);
+  td::BufferSlice result(calc_length.get_length());
+  td::TlStorerUnsafe storer(result.as_mutable_slice().ubegin());
+  store(storer);
+  return result;
+}
+
+static constexpr td::int32 TL_VECTOR_ID = 0x1cb5c415;
+
+template <class StorerT>
+static void store_test_user(StorerT &storer, td::int64 user_id, td::Slice first_name) {
+  storer.store_binary(td::telegram_api::user::ID);
+  storer.store_binary(static_cast<td::int32>(1 << 0 | 1 << 1));  // access_hash and first_name
+  storer.store_binary(static_cast<td::int32>(0));
+  storer.store_binary(user_id);
+  storer.store_binary(static_cast<td::int64>(1234567));
+  storer.store_string(first_name);
+}
+
+template <class StorerT>
+static void store_test_chat(StorerT &storer, td::int64 chat_id, td::Slice title) {
+  storer.store_binary(td::telegram_api::chat::ID);
+  storer.store_binary(static_cast<td::int32>(0));
+  storer.store_binary(chat_id);
+  storer.store_string(title);
+  storer.store_binary(td::telegram_api::chatPhotoEmpty::ID);
+  storer.store_binary(static_cast<td::int32>(5));
+  storer.store_binary(static_cast<td::int32>(1700000000));
+  storer.store_binary(static_cast<td::int32>(1));
+}
+
+template <class StorerT>
+static void store_test_channel(StorerT &storer, td::int64 channel_id, td::Slice title) {
+  storer.store_binary(td::telegram_api::channel::ID);
+  storer.store_binary(static_cast<td::int32>(1 << 13));  // access_hash
+  storer.store_binary(static_cast<td::int32>(0));
+  storer.store_binary(channel_id);
+  storer.store_binary(static_cast<td::int64>(7654321));
+  storer.store_string(title);
+  storer.store_binary(td::telegram_api::chatPhotoEmpty::ID);
+  storer.store_binary(static_cast<td::int32>(1700000001));
+}
+
+template <class StorerT>
+static void store_test_difference(StorerT &storer) {
+  storer.store_binary(td::telegram_api::updates_difference::ID);
+  for (int i = 0; i < 3; i++) {
+    storer.store_binary(TL_VECTOR_ID);
+    storer.store_binary(static_cast<td::int32>(0));
+  }
+  storer.store_binary(TL_VECTOR_ID);
+  storer.store_binary(static_cast<td::int32>(3));
+  store_test_chat(storer, 123, "Chat");
+  store_test_channel(storer, 1000000000123, "Channel");
+  storer.store_binary(td::telegram_api::chatEmpty::ID);
+  storer.store_binary(static_cast<td::int64>(124));
+  storer.store_binary(TL_VECTOR_ID);
+  storer.store_binary(static_cast<td::int32>(2));
+  store_test_user(storer, 5000000001, "First");
+  storer.store_binary(td::telegram_api::userEmpty::ID);
+  storer.store_binary(static_cast<td::int64>(5000000002));
+  storer.store_binary(td::telegram_api::updates_state::ID);
+  for (int i = 0; i < 5; i++) {
+    storer.store_binary(static_cast<td::int32>(i + 1));
+  }
+}
+
+TEST(Mtproto, TlLazyVector) {
+  auto user_data = serialize_tl([](auto &storer) { store_test_user(storer, 5000000001, "First"); });
+  auto chat_data = serialize_tl([](auto &storer) { store_test_chat(storer, 123, "Chat"); });
+  auto channel_data = serialize_tl([](auto &storer) { store_test_channel(storer, 1000000000123, "Channel"); });
+  auto difference_data = serialize_tl([](auto &storer) { store_test_difference(storer); });
+
+  td::TlBufferParser parser(&difference_data);
+  auto difference_ptr = td::telegram_api::updates_Difference::fetch(parser);
+  parser.fetch_end();
+  ASSERT_TRUE(parser.get_error() == nullptr);
+  ASSERT_EQ(td::telegram_api::updates_difference::ID, difference_ptr->get_id());
+  auto difference = td::telegram_api::move_object_as<td::telegram_api::updates_difference>(difference_ptr);
+  ASSERT_EQ(5, difference->state_->unread_count_);
+
+  const auto &users = difference->users_;
+  ASSERT_EQ(2u, users.size());
+  ASSERT_EQ(user_data.as_slice(), users.get_raw(0));
+  ASSERT_EQ(user_data.as_slice(), users.get_raw_buffer(0).as_slice());
+  auto user_ptr = users.get(0);
+  ASSERT_TRUE(user_ptr != nullptr);
+  ASSERT_EQ(td::telegram_api::user::ID, user_ptr->get_id());
+  auto user = td::telegram_api::move_object_as<td::telegram_api::user>(user_ptr);
+  ASSERT_EQ(5000000001, user->id_);
+  ASSERT_EQ(1234567, user->access_hash_);
+  ASSERT_EQ("First", user->first_name_);
+  ASSERT_EQ(td::telegram_api::userEmpty::ID, users.get(1)->get_id());
+  ASSERT_EQ(2u, users.get_all().size());
+
+  const auto &chats = difference->chats_;
+  ASSERT_EQ(3u, chats.size());
+  ASSERT_EQ(chat_data.as_slice(), chats.get_raw(0));
+  ASSERT_EQ(channel_data.as_slice(), chats.get_raw(1));
+  auto chat = td::telegram_api::move_object_as<td::telegram_api::chat>(chats.get(0));
+  ASSERT_EQ(123, chat->id_);
+  ASSERT_EQ("Chat", chat->title_);
+  ASSERT_EQ(5, chat->participants_count_);
+  auto channel = td::telegram_api::move_object_as<td::telegram_api::channel>(chats.get(1));
+  ASSERT_EQ(1000000000123, channel->id_);
+  ASSERT_EQ(7654321, channel->access_hash_);
+  ASSERT_EQ("Channel", channel->title_);
+  ASSERT_EQ(td::telegram_api::chatEmpty::ID, chats.get(2)->get_id());
+
+  auto check_skip_and_fetch_id = [](const td::BufferSlice &data, void (*skip)(td::TlBufferParser &),
+                                    td::int32 constructor_id, td::int64 (*fetch_id)(td::TlBufferParser &),
+                                    td::int64 expected_id) {
+    {
+      td::TlBufferParser skip_parser(&data);
+      skip(skip_parser);
+      skip_parser.fetch_end();
+      ASSERT_TRUE(skip_parser.get_error() == nullptr);
+    }
+    td::TlBufferParser id_parser(&data);
+    ASSERT_EQ(constructor_id, id_parser.fetch_int());
+    ASSERT_EQ(expected_id, fetch_id(id_parser));
+    ASSERT_TRUE(id_parser.get_error() == nullptr);
+
+    // truncated objects must be rejected
+    for (size_t size = 0; size < data.size(); size += 4) {
+      auto truncated_data = data.from_slice(data.as_slice().substr(0, size));
+      td::TlBufferParser truncated_parser(&truncated_data);
+      skip(truncated_parser);
+      ASSERT_TRUE(truncated_parser.get_error() != nullptr);
+    }
+  };
+  check_skip_and_fetch_id(users.get_raw_buffer(0), &td::telegram_api::User::skip, td::telegram_api::user::ID,
+                          &td::telegram_api::user::fetch_id, 5000000001);
+  check_skip_and_fetch_id(chats.get_raw_buffer(0), &td::telegram_api::Chat::skip, td::telegram_api::chat::ID,
+                          &td::telegram_api::chat::fetch_id, 123);
+  check_skip_and_fetch_id(chats.get_raw_buffer(1), &td::telegram_api::Chat::skip, td::telegram_api::channel::ID,
+                          &td::telegram_api::channel::fetch_id, 1000000000123);
+
+  // an invalid object inside of a lazy vector must fail the whole fetch
+  auto invalid_data = difference_data.copy();
+  auto user_offset = difference_data.as_slice().str().find(user_data.as_slice().str());
+  ASSERT_TRUE(user_offset != td::string::npos);
+  invalid_data.as_mutable_slice()[user_offset] ^= 1;
+  td::TlBufferParser invalid_parser(&invalid_data);
+  td::telegram_api::updates_Difference::fetch(invalid_parser);
+  ASSERT_TRUE(invalid_parser.get_error() != nullptr);
+}
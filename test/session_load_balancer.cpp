@@ -0,0 +1,104 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/SessionLoadBalancer.h"
+
+#include "td/utils/common.h"
+#include "td/utils/tests.h"
+
+TEST(SessionLoadBalancer, least_loaded_session) {
+  td::SessionLoadBalancer balancer(2, 0);
+  // a file part download is much heavier than many small queries
+  balancer.on_query_sent(0, 50 + (1 << 20));
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(1u, balancer.get_least_loaded_session());
+    balancer.on_query_sent(1, 50);
+  }
+  balancer.on_query_finished(0, 50 + (1 << 20));
+  ASSERT_EQ(0u, balancer.get_least_loaded_session());
+  ASSERT_EQ(0, balancer.get_query_count(0));
+  ASSERT_EQ(10, balancer.get_query_count(1));
+}
+
+TEST(SessionLoadBalancer, extra_sessions) {
+  const td::int64 traffic_size = 1 << 19;
+  td::SessionLoadBalancer balancer(2, 2);
+  double now = 100;
+  ASSERT_EQ(2, balancer.get_active_session_count());
+  ASSERT_EQ(2u, balancer.get_session_count());
+
+  for (size_t session_id = 0; session_id < 2; session_id++) {
+    for (int i = 0; i < 2; i++) {
+      balancer.on_query_sent(session_id, traffic_size);
+    }
+  }
+
+  // a new session is added only if all active sessions are congested
+  balancer.on_load_updated(0, 0.1, 1.0, now);
+  ASSERT_EQ(0, balancer.get_extra_session_count());
+  balancer.on_load_updated(1, 0.1, 0.05, now);
+  ASSERT_EQ(0, balancer.get_extra_session_count());
+  balancer.on_load_updated(1, 0.1, 1.0, now);
+  ASSERT_EQ(1, balancer.get_extra_session_count());
+  ASSERT_EQ(3, balancer.get_active_session_count());
+  ASSERT_EQ(3u, balancer.get_session_count());
+  ASSERT_EQ(2u, balancer.get_least_loaded_session());
+  balancer.on_query_sent(2, traffic_size);
+  balancer.on_query_sent(2, traffic_size);
+
+  // the number of sessions isn't changed too often
+  balancer.on_load_updated(2, 0.1, 1.0, now + 1);
+  ASSERT_EQ(1, balancer.get_extra_session_count());
+  balancer.on_load_updated(2, 0.1, 1.0, now + td::SessionLoadBalancer::EXTRA_SESSION_COUNT_UPDATE_DELAY);
+  ASSERT_EQ(2, balancer.get_extra_session_count());
+  ASSERT_EQ(4u, balancer.get_session_count());
+
+  // the number of extra sessions is limited
+  now += 2 * td::SessionLoadBalancer::EXTRA_SESSION_COUNT_UPDATE_DELAY;
+  balancer.on_query_sent(3, traffic_size);
+  balancer.on_query_sent(3, traffic_size);
+  balancer.on_load_updated(3, 0.1, 1.0, now);
+  ASSERT_EQ(2, balancer.get_extra_session_count());
+
+  // sessions aren't removed while there are enough queries
+  now += td::SessionLoadBalancer::EXTRA_SESSION_COUNT_UPDATE_DELAY;
+  for (size_t session_id = 0; session_id < 4; session_id++) {
+    balancer.on_load_updated(session_id, 0.1, 0.0, now);
+  }
+  ASSERT_EQ(2, balancer.get_extra_session_count());
+
+  for (size_t session_id = 0; session_id < 3; session_id++) {
+    for (int i = 0; i < 2; i++) {
+      balancer.on_query_finished(session_id, traffic_size);
+    }
+  }
+  balancer.on_query_finished(3, traffic_size);
+
+  // an inactive session is closed only after all its queries are finished
+  balancer.on_load_updated(0, 0.1, 0.0, now);
+  ASSERT_EQ(1, balancer.get_extra_session_count());
+  ASSERT_EQ(3, balancer.get_active_session_count());
+  ASSERT_EQ(4u, balancer.get_session_count());
+  ASSERT_EQ(1, balancer.get_query_count(3));
+  balancer.on_query_finished(3, traffic_size);
+  ASSERT_EQ(3u, balancer.get_session_count());
+
+  // an idle inactive session is closed immediately
+  now += td::SessionLoadBalancer::EXTRA_SESSION_COUNT_UPDATE_DELAY;
+  balancer.on_load_updated(0, 0.1, 0.0, now);
+  ASSERT_EQ(0, balancer.get_extra_session_count());
+  ASSERT_EQ(2u, balancer.get_session_count());
+}
+
+TEST(SessionLoadBalancer, no_extra_sessions) {
+  td::SessionLoadBalancer balancer(1, 0);
+  for (int i = 0; i < 10; i++) {
+    balancer.on_query_sent(0, 100);
+  }
+  balancer.on_load_updated(0, 0.1, 10.0, 100);
+  ASSERT_EQ(0, balancer.get_extra_session_count());
+  ASSERT_EQ(1u, balancer.get_session_count());
+}
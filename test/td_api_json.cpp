@@ -0,0 +1,96 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2025
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_json.h"
+
+#include "td/utils/common.h"
+#include "td/utils/JsonBuilder.h"
+#include "td/utils/StringBuilder.h"
+#include "td/utils/tests.h"
+
+#include <limits>
+
+static td::string to_json_builder(const td::td_api::Object &object) {
+  return td::json_encode<td::string>(td::ToJson(object));
+}
+
+static td::string to_json_direct(const td::td_api::Object &object) {
+  td::StringBuilder sb;
+  td::td_api::store_json(sb, object);
+  return sb.as_cslice().str();
+}
+
+static void check_store_json(const td::td_api::Object &object) {
+  auto expected = to_json_builder(object);
+  ASSERT_EQ(expected, to_json_direct(object));
+  ASSERT_TRUE(td::json_decode(td::MutableSlice(expected)).is_ok());
+}
+
+static td::td_api::object_ptr<td::td_api::file> get_file_object() {
+  return td::td_api::make_object<td::td_api::file>(
+      12345, 123456, 0,
+      td::td_api::make_object<td::td_api::localFile>("C:\\photos\\\"photo\".jpg", true, true, false, true, 0, 123456,
+                                                     123456),
+      td::td_api::make_object<td::td_api::remoteFile>("AgACAgIAAxkBAAIBZ2Vh", "", false, true, 123456));
+}
+
+static td::td_api::object_ptr<td::td_api::message> get_message_object() {
+  auto message = td::td_api::make_object<td::td_api::message>();
+  message->id_ = 123456000111;
+  message->sender_id_ = td::td_api::make_object<td::td_api::messageSenderUser>(123456000112);
+  message->chat_id_ = -1001234567890;
+  message->is_outgoing_ = true;
+  message->date_ = 1699999999;
+  message->self_destruct_in_ = 0.5;
+  message->auto_delete_in_ = 1e-7;
+  message->media_album_id_ = std::numeric_limits<td::int64>::min();
+  message->effect_id_ = std::numeric_limits<td::int64>::max();
+  message->author_signature_ =
+      "Author \"Signature\"\\\n\t\x01\xD0\x90\xD0\xB2\xD1\x82\xD0\xBE\xD1\x80 \xF0\x9F\x98\x80";
+
+  auto caption = td::td_api::make_object<td::td_api::formattedText>();
+  caption->text_ = "Some text with a link";
+  caption->entities_.push_back(td::td_api::make_object<td::td_api::textEntity>(
+      15, 6, td::td_api::make_object<td::td_api::textEntityTypeTextUrl>("https://telegram.org/")));
+  caption->entities_.push_back(
+      td::td_api::make_object<td::td_api::textEntity>(0, 4, td::td_api::make_object<td::td_api::textEntityTypeBold>()));
+
+  auto photo = td::td_api::make_object<td::td_api::photo>();
+  photo->minithumbnail_ =
+      td::td_api::make_object<td::td_api::minithumbnail>(40, 30, td::string("\x00\xFF\x10 data", 8));
+  photo->sizes_.push_back(td::td_api::make_object<td::td_api::photoSize>(
+      "x", get_file_object(), 800, 600, td::vector<td::int32>{10000, -20000, 0}));
+  photo->sizes_.push_back(
+      td::td_api::make_object<td::td_api::photoSize>("m", get_file_object(), 320, 240, td::vector<td::int32>()));
+  message->content_ =
+      td::td_api::make_object<td::td_api::messagePhoto>(std::move(photo), std::move(caption), false, true, false);
+
+  td::vector<td::vector<td::td_api::object_ptr<td::td_api::inlineKeyboardButton>>> rows(2);
+  rows[0].push_back(td::td_api::make_object<td::td_api::inlineKeyboardButton>(
+      "Button",
+      td::td_api::make_object<td::td_api::inlineKeyboardButtonTypeCallback>(td::string("callback\x00\x01", 10))));
+  rows[0].push_back(td::td_api::make_object<td::td_api::inlineKeyboardButton>("Empty", nullptr));
+  message->reply_markup_ = td::td_api::make_object<td::td_api::replyMarkupInlineKeyboard>(std::move(rows));
+  return message;
+}
+
+TEST(TdApiJson, store_json) {
+  // all fields of the message are empty or default
+  check_store_json(td::td_api::message());
+  check_store_json(td::td_api::ok());
+  check_store_json(*get_message_object());
+  check_store_json(td::td_api::updateNewMessage(get_message_object()));
+  check_store_json(td::td_api::updateInstalledStickerSets(
+      td::td_api::make_object<td::td_api::stickerTypeRegular>(),
+      td::vector<td::int64>{0, -1, std::numeric_limits<td::int64>::max()}));
+  check_store_json(td::td_api::updateInstalledStickerSets(nullptr, td::vector<td::int64>()));
+  check_store_json(td::td_api::chats(3, td::vector<td::int64>{1, -1001234567890, 9007199254740991}));
+  check_store_json(td::td_api::location(-90.0, 179.999999, 0.0));
+  check_store_json(td::td_api::messageLocation(td::td_api::make_object<td::td_api::location>(55.75, 37.6, 12.5),
+                                               0x7FFFFFFF, 0, -1, 100));
+  check_store_json(td::td_api::error(400, "Bad request: \"\x7F\""));
+}
@@ -10,6 +10,8 @@
 #include "td/telegram/ClientActor.h"
 #include "td/telegram/files/PartsManager.h"
 #include "td/telegram/td_api.h"
+#include "td/telegram/td_binary_client.h"
+#include "td/telegram/td_json_client.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
@@ -20,6 +22,7 @@
 #include "td/utils/common.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
+#include "td/utils/JsonBuilder.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/port/FileFd.h"
@@ -32,6 +35,9 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
+#include "td/utils/Time.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
 
 #include <atomic>
 #include <cstdio>
@@ -971,6 +977,94 @@ TEST(Client, Manager) {
 }
 
 #if !TD_EVENTFD_UNSUPPORTED  // Client must be used from a single thread if there is no EventFd
+static void test_manager_receivers(bool keep_client_order, bool use_receive_many) {
+  td::ClientManager client;
+  int receivers_n = 4;
+  int clients_n = 100;
+  int requests_n = 10;
+  client.set_receiver_count(receivers_n, keep_client_order);
+
+  td::vector<td::ClientManager::ClientId> client_ids;
+  for (int i = 0; i < clients_n; i++) {
+    client_ids.push_back(client.create_client_id());
+  }
+  for (auto client_id : client_ids) {
+    for (int i = 1; i <= requests_n; i++) {
+      client.send(client_id, i, td::make_tl_object<td::td_api::testSquareInt>(i));
+    }
+  }
+
+  std::atomic<int> ok_count{0};
+  td::vector<int> last_request_ids(client_ids.back() + 1);
+  td::vector<td::thread> threads;
+  for (int receiver_id = 0; receiver_id < receivers_n; receiver_id++) {
+    threads.emplace_back([&, receiver_id] {
+      while (ok_count.load() != clients_n * requests_n) {
+        td::vector<td::ClientManager::Response> events;
+        if (use_receive_many) {
+          events = client.receive_many(0.1, 7, receiver_id);
+          ASSERT_TRUE(events.size() <= 7u);
+        } else {
+          events.push_back(client.receive(0.1, receiver_id));
+        }
+        for (auto &event : events) {
+          if (event.object == nullptr || event.request_id == 0) {
+            continue;
+          }
+          ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+          auto value = static_cast<td::td_api::testInt &>(*event.object).value_;
+          ASSERT_EQ(static_cast<td::int32>(event.request_id * event.request_id), value);
+          if (keep_client_order) {
+            ASSERT_EQ(receiver_id, event.client_id % receivers_n);
+            auto &last_request_id = last_request_ids[event.client_id];
+            ASSERT_EQ(last_request_id + 1, static_cast<int>(event.request_id));
+            last_request_id++;
+          }
+          ok_count++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(clients_n * requests_n, ok_count.load());
+}
+
+TEST(Client, ManagerReceiverCountChangeIgnored) {
+  td::ClientManager client;
+  client.set_receiver_count(0, true);
+  client.set_receiver_count(100000, true);
+  auto event = client.receive(0);
+  ASSERT_TRUE(event.object == nullptr);
+  // the number of receivers can't be changed after the first receive
+  client.set_receiver_count(4, true);
+
+  int clients_n = 8;
+  for (int i = 0; i < clients_n; i++) {
+    client.send(client.create_client_id(), 1, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+  int ok_count = 0;
+  while (ok_count != clients_n) {
+    event = client.receive(10);
+    ASSERT_TRUE(event.object != nullptr);
+    if (event.request_id == 1) {
+      ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+      ok_count++;
+    }
+  }
+}
+
+TEST(Client, ManagerReceivers) {
+  test_manager_receivers(true, false);
+  test_manager_receivers(false, false);
+}
+
+TEST(Client, ManagerReceiveMany) {
+  test_manager_receivers(true, true);
+  test_manager_receivers(false, true);
+}
+
 TEST(Client, Close) {
   std::atomic<bool> stop_send{false};
   std::atomic<bool> can_stop_receive{false};
@@ -1179,6 +1273,172 @@ TEST(Client, ManagerCloseOneThread) {
   ASSERT_TRUE(sent_requests.empty());
 }
 
+TEST(Client, JsonReceiveMany) {
+  ASSERT_TRUE(td_receive_many(0.0, 0) == nullptr);
+
+  auto client_id = td_create_client_id();
+  const int request_count = 100;
+  for (int i = 1; i <= request_count; i++) {
+    td_send(client_id, (PSTRING() << "{\"@type\":\"testSquareInt\",\"x\":" << i << ",\"@extra\":" << i << '}').c_str());
+  }
+
+  const size_t max_count = 4;
+  size_t max_received_count = 0;
+  int last_extra = 0;
+  bool is_closed = false;
+  auto on_response = [&](td::JsonValue &value) {
+    ASSERT_TRUE(value.type() == td::JsonValue::Type::Object);
+    auto &object = value.get_object();
+    ASSERT_EQ(client_id, object.get_required_int_field("@client_id").move_as_ok());
+    auto type = object.get_required_string_field("@type").move_as_ok();
+    if (object.has_field("@extra")) {
+      ASSERT_EQ(td::string("testInt"), type);
+      auto extra = object.get_required_int_field("@extra").move_as_ok();
+      ASSERT_EQ(extra * extra, object.get_required_int_field("value").move_as_ok());
+      // responses must be returned in the order in which they were received regardless of the receive function
+      ASSERT_EQ(last_extra + 1, extra);
+      last_extra = extra;
+    } else if (type == "updateAuthorizationState") {
+      auto state = object.extract_required_field("authorization_state", td::JsonValue::Type::Object).move_as_ok();
+      is_closed = state.get_object().get_required_string_field("@type").move_as_ok() == "authorizationStateClosed";
+    }
+  };
+  auto receive = [&](bool use_receive_many) {
+    auto result = use_receive_many ? td_receive_many(1.0, static_cast<int>(max_count)) : td_receive(1.0);
+    if (result == nullptr) {
+      return;
+    }
+    td::string json = result;
+    auto value = td::json_decode(json).move_as_ok();
+    if (!use_receive_many) {
+      return on_response(value);
+    }
+    ASSERT_TRUE(value.type() == td::JsonValue::Type::Array);
+    auto &responses = value.get_array();
+    ASSERT_TRUE(!responses.empty());
+    ASSERT_TRUE(responses.size() <= max_count);
+    max_received_count = td::max(max_received_count, responses.size());
+    for (auto &response : responses) {
+      on_response(response);
+    }
+  };
+
+  for (int i = 0; last_extra < request_count; i++) {
+    receive(i % 3 != 0);
+  }
+  ASSERT_EQ(max_count, max_received_count);
+
+  td_send(client_id, "{\"@type\":\"close\"}");
+  for (int i = 0; !is_closed; i++) {
+    receive(i % 2 != 0);
+  }
+
+  // there must be no responses after the client was closed
+  auto start_time = td::Time::now();
+  ASSERT_TRUE(td_receive_many(0.1, static_cast<int>(max_count)) == nullptr);
+  ASSERT_TRUE(td::Time::now() - start_time >= 0.09);
+}
+
+template <class F>
+static td::string get_binary_request(F &&store) {
+  td::TlStorerCalcLength calc_length;
+  store(calc_length);
+  td::string request(calc_length.get_length(), '\0');
+  td::TlStorerUnsafe storer(td::MutableSlice(request).ubegin());
+  store(storer);
+  return request;
+}
+
+TEST(Client, BinaryClient) {
+  auto client_id = TdBinaryClientCreateId();
+  auto send_request = [&](td::int64 request_id, const td::string &request) {
+    TdBinaryClientSend(client_id, request_id, request.data(), static_cast<int>(request.size()));
+  };
+
+  const td::int32 request_count = 20;
+  for (td::int32 i = 1; i <= request_count; i++) {
+    send_request(i, get_binary_request([&](auto &storer) {
+                   storer.store_int(td::td_api::testSquareInt::ID);
+                   storer.store_int(i);
+                 }));
+  }
+  send_request(request_count + 1, "invalid request");
+
+  size_t received_count = 0;
+  while (received_count <= static_cast<size_t>(request_count)) {
+    auto response = TdBinaryClientReceive(1.0);
+    if (response.data == nullptr) {
+      continue;
+    }
+    ASSERT_EQ(client_id, response.client_id);
+    if (response.request_id == 0) {
+      continue;
+    }
+    td::TlParser parser(td::Slice(response.data, static_cast<size_t>(response.data_size)));
+    if (response.request_id <= request_count) {
+      ASSERT_EQ(td::td_api::testInt::ID, parser.fetch_int());
+      ASSERT_EQ(response.request_id * response.request_id, parser.fetch_int());
+    } else {
+      ASSERT_EQ(request_count + 1, response.request_id);
+      ASSERT_EQ(td::td_api::error::ID, parser.fetch_int());
+      ASSERT_EQ(400, parser.fetch_int());
+      ASSERT_TRUE(!parser.fetch_string<td::Slice>().empty());
+    }
+    parser.fetch_end();
+    ASSERT_TRUE(parser.get_error() == nullptr);
+    received_count++;
+  }
+
+  {
+    auto request = get_binary_request([](auto &storer) {
+      storer.store_int(td::td_api::getOption::ID);
+      storer.store_string(td::Slice("version"));
+    });
+    auto response = TdBinaryClientExecute(request.data(), static_cast<int>(request.size()));
+    ASSERT_EQ(0, response.request_id);
+    td::TlParser parser(td::Slice(response.data, static_cast<size_t>(response.data_size)));
+    ASSERT_EQ(td::td_api::optionValueString::ID, parser.fetch_int());
+    ASSERT_TRUE(!parser.fetch_string<td::Slice>().empty());
+    parser.fetch_end();
+    ASSERT_TRUE(parser.get_error() == nullptr);
+  }
+
+  {
+    // too deeply nested objects must be rejected instead of overflowing the stack
+    auto request = get_binary_request([](auto &storer) {
+      storer.store_int(td::td_api::getJsonString::ID);
+      for (int i = 0; i < 100000; i++) {
+        storer.store_int(td::td_api::jsonValueArray::ID);
+        storer.store_int(1);
+      }
+      storer.store_int(td::td_api::jsonValueNull::ID);
+    });
+    auto response = TdBinaryClientExecute(request.data(), static_cast<int>(request.size()));
+    td::TlParser parser(td::Slice(response.data, static_cast<size_t>(response.data_size)));
+    ASSERT_EQ(td::td_api::error::ID, parser.fetch_int());
+    ASSERT_EQ(400, parser.fetch_int());
+    ASSERT_TRUE(td::ends_with(parser.fetch_string<td::Slice>(), "Too big object depth"));
+    parser.fetch_end();
+    ASSERT_TRUE(parser.get_error() == nullptr);
+  }
+
+  send_request(1, get_binary_request([](auto &storer) { storer.store_int(td::td_api::close::ID); }));
+  bool is_closed = false;
+  while (!is_closed) {
+    auto response = TdBinaryClientReceive(1.0);
+    if (response.data == nullptr || response.request_id != 0) {
+      continue;
+    }
+    ASSERT_EQ(client_id, response.client_id);
+    td::TlParser parser(td::Slice(response.data, static_cast<size_t>(response.data_size)));
+    if (parser.fetch_int() == td::td_api::updateAuthorizationState::ID &&
+        parser.fetch_int() == td::td_api::authorizationStateClosed::ID) {
+      is_closed = true;
+    }
+  }
+  ASSERT_TRUE(TdBinaryClientReceive(0.1).data == nullptr);
+}
+
 TEST(PartsManager, hands) {
   {
     td::PartsManager pm;